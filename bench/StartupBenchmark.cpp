@@ -0,0 +1,124 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+/**
+ * @brief Measures the startup time of the CodeGenerator
+ * Starts the generator repeatedly with --version, with --help and with a small spec and
+ * prints the median, 90th percentile and minimum wall time of each. --version and --help
+ * run in an empty directory holding only a copy of logconfig.ini, if there is one in the
+ * working directory, and must leave it as it was, since they must not set up logging.
+ *
+ * Usage: StartupBenchmark <CodeGenerator> <spec.xml> [runs] [budget in ms]
+ * With a budget, the exit status is non-zero if the median of --version exceeds it.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+/**
+ * @brief Runs a command with stdout and stderr discarded
+ * @param arguments the command and its arguments
+ * @param workingDir directory the command runs in
+ * @return wall time in milliseconds, negative if the command failed
+ */
+static double timeCommand(const std::vector<std::string> &arguments, const std::string &workingDir) {
+    std::vector<char *> argv;
+    for (auto &argument: arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        if (chdir(workingDir.c_str()) == 0) {
+            execv(argv[0], argv.data());
+        }
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Times a command several times and prints the result
+ * @param name name of the case
+ * @param arguments the command and its arguments
+ * @param workingDir directory the command runs in
+ * @param runs number of runs
+ * @return median in milliseconds, negative if a run failed
+ */
+static double benchmark(const std::string &name, const std::vector<std::string> &arguments,
+                        const std::string &workingDir, int runs) {
+    std::vector<double> times;
+    for (int i = 0; i < runs; i++) {
+        double time = timeCommand(arguments, workingDir);
+        if (time < 0) {
+            fprintf(stderr, "%s failed\n", name.c_str());
+            return -1;
+        }
+        times.push_back(time);
+    }
+    std::sort(times.begin(), times.end());
+    double median = times[times.size() / 2];
+    printf("%-12s median %7.2f ms, p90 %7.2f ms, min %7.2f ms\n", name.c_str(), median,
+           times[std::min(times.size() - 1, times.size() * 9 / 10)], times.front());
+    return median;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <CodeGenerator> <spec.xml> [runs] [budget in ms]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::string generator = boost::filesystem::absolute(argv[1]).string();
+    std::string spec = boost::filesystem::absolute(argv[2]).string();
+    int runs = argc > 3 ? std::max(1, atoi(argv[3])) : 50;
+    double budget = argc > 4 ? atof(argv[4]) : 0;
+
+    boost::filesystem::path emptyDir = boost::filesystem::temp_directory_path()
+                                       / boost::filesystem::unique_path("startup-%%%%-%%%%");
+    boost::filesystem::path outputDir = emptyDir / "output";
+    boost::filesystem::create_directories(outputDir);
+    if (boost::filesystem::exists("logconfig.ini")) {
+        boost::filesystem::copy_file("logconfig.ini", emptyDir / "logconfig.ini");
+    }
+    std::size_t filesBefore = std::distance(boost::filesystem::directory_iterator(emptyDir),
+                                            boost::filesystem::directory_iterator());
+
+    bool failed = false;
+    double version = benchmark("--version", {generator, "--version"}, emptyDir.string(), runs);
+    double help = benchmark("--help", {generator, "--help"}, emptyDir.string(), runs);
+    std::size_t filesAfter = std::distance(boost::filesystem::directory_iterator(emptyDir),
+                                           boost::filesystem::directory_iterator());
+    if (filesAfter != filesBefore) {
+        fprintf(stderr, "--version or --help wrote into the working directory\n");
+        failed = true;
+    }
+    double generate = benchmark("small spec", {generator, "-p", spec, "-o", outputDir.string() + "/", "-f"}, ".",
+                                runs);
+    failed = failed || version < 0 || help < 0 || generate < 0;
+    if (budget > 0 && version > budget) {
+        fprintf(stderr, "--version took %.2f ms, more than the budget of %.2f ms\n", version, budget);
+        failed = true;
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::remove_all(emptyDir, error);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+# Editors: Tobias Goetz
+#
+# add_getopt_codegen(<target> SPEC <spec> [OUTPUT_DIR <dir>] [TEMPLATES <dir>] [GENERATOR <command>])
+#
+# Generates the getopt code of a spec and adds it to <target>. The custom command
+# depends on the spec and the generator, the depfile written by the generator adds
+# the templates, so the generator runs exactly when one of them changes. The depfile
+# is the OUTPUT of the command, as it is rewritten on every run; the header and the
+# source are BYPRODUCTS and keep their time if their content did not change, so the
+# code using them is only compiled again if it did. The file names are read from the
+# spec when CMake configures, renaming them in the spec needs a new configure run. The
+# generator runs with --quiet, so it only adds warnings and errors to the build log.
+#
+#   SPEC        the spec, relative to the current source directory
+#   OUTPUT_DIR  directory of the generated files, added to the include directories
+#               of <target>, default ${CMAKE_CURRENT_BINARY_DIR}/getopt_codegen/<target>
+#   TEMPLATES   directory with own templates, see --templates
+#   GENERATOR   target or path of the generator, default the CodeGenerator target
+function(add_getopt_codegen target)
+    cmake_parse_arguments(CODEGEN "" "SPEC;OUTPUT_DIR;TEMPLATES;GENERATOR" "" ${ARGN})
+    if(NOT CODEGEN_SPEC)
+        message(FATAL_ERROR "add_getopt_codegen(${target}) needs a SPEC")
+    endif()
+    get_filename_component(spec "${CODEGEN_SPEC}" ABSOLUTE)
+    if(NOT CODEGEN_OUTPUT_DIR)
+        set(CODEGEN_OUTPUT_DIR "${CMAKE_CURRENT_BINARY_DIR}/getopt_codegen/${target}")
+    endif()
+    if(NOT CODEGEN_GENERATOR)
+        set(CODEGEN_GENERATOR CodeGenerator)
+    endif()
+
+    file(STRINGS "${spec}" names REGEX "<(Header|Source)FileName>")
+    string(REGEX MATCH "<HeaderFileName>[ \t]*([^< \t]+)" match "${names}")
+    set(header "${CMAKE_MATCH_1}")
+    string(REGEX MATCH "<SourceFileName>[ \t]*([^< \t]+)" match "${names}")
+    set(source "${CMAKE_MATCH_1}")
+    if(NOT header OR NOT source)
+        message(FATAL_ERROR "${spec} does not name the header and the source file")
+    endif()
+
+    # The output directory has no logconfig.ini, only problems go to the build log
+    set(arguments -p "${spec}" -o "${CODEGEN_OUTPUT_DIR}/" --force --quiet --depfile "${CODEGEN_OUTPUT_DIR}/${target}.d")
+    if(CODEGEN_TEMPLATES)
+        get_filename_component(templates "${CODEGEN_TEMPLATES}" ABSOLUTE)
+        list(APPEND arguments --templates "${templates}")
+    endif()
+
+    file(MAKE_DIRECTORY "${CODEGEN_OUTPUT_DIR}")
+    add_custom_command(
+            OUTPUT "${CODEGEN_OUTPUT_DIR}/${target}.d"
+            BYPRODUCTS "${CODEGEN_OUTPUT_DIR}/${header}" "${CODEGEN_OUTPUT_DIR}/${source}"
+            "${CODEGEN_OUTPUT_DIR}/codegen.manifest"
+            COMMAND ${CODEGEN_GENERATOR} ${arguments}
+            DEPENDS "${spec}" ${CODEGEN_GENERATOR}
+            DEPFILE "${CODEGEN_OUTPUT_DIR}/${target}.d"
+            WORKING_DIRECTORY "${CODEGEN_OUTPUT_DIR}"
+            COMMENT "Generating getopt code of ${CODEGEN_SPEC}"
+            VERBATIM
+    )
+    target_sources(${target} PRIVATE "${CODEGEN_OUTPUT_DIR}/${target}.d"
+            "${CODEGEN_OUTPUT_DIR}/${header}" "${CODEGEN_OUTPUT_DIR}/${source}")
+    target_include_directories(${target} PRIVATE "${CODEGEN_OUTPUT_DIR}")
+endfunction()
@@ -0,0 +1,91 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_BINARYSTREAM_H
+#define CODEGENERATOR_BINARYSTREAM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Appends values in a fixed little-endian layout to a byte buffer
+ */
+class BinaryWriter {
+public:
+    /** @name Writer
+    * @brief  Append a value to the buffer
+    */
+    ///@{
+    void writeU8(uint8_t value);
+    void writeU32(uint32_t value);
+    void writeI32(int32_t value);
+    void writeU64(uint64_t value);
+    void writeString(const std::string &value);
+    void writeStrings(const std::vector<std::string> &values);
+    ///@}
+
+    /**
+     * @brief Get the written bytes
+     * @return the buffer
+     */
+    const std::string &getBuffer() const;
+
+private:
+    /**
+     * @brief The written bytes
+     */
+    std::string buffer;
+};
+
+/**
+ * @brief Reads values written by BinaryWriter from a byte buffer
+ * Every read throws a GeneratorException if the buffer is too short.
+ */
+class BinaryReader {
+public:
+    /**
+     * @brief Constructor
+     * @param data start of the buffer, must outlive the reader
+     * @param size size of the buffer
+     */
+    BinaryReader(const char *data, std::size_t size);
+
+    /** @name Reader
+    * @brief  Read the next value from the buffer
+    */
+    ///@{
+    uint8_t readU8();
+    uint32_t readU32();
+    int32_t readI32();
+    uint64_t readU64();
+    std::string readString();
+    std::vector<std::string> readStrings();
+    ///@}
+
+    /**
+     * @brief Checks whether the whole buffer was read
+     * @return true if nothing is left
+     */
+    bool atEnd() const;
+
+private:
+    /**
+     * @brief Makes sure that size more bytes can be read
+     * @param size number of bytes
+     */
+    void require(std::size_t size) const;
+
+    /**
+     * @brief Current read position
+     */
+    const char *position;
+    /**
+     * @brief End of the buffer
+     */
+    const char *end;
+};
+
+
+#endif //CODEGENERATOR_BINARYSTREAM_H
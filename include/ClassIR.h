@@ -0,0 +1,180 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_CLASSIR_H
+#define CODEGENERATOR_CLASSIR_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "models/Option.h"
+#include "SemanticAnalyzer.h"
+#include "SymbolTable.h"
+
+/**
+ * @brief Intermediate representation of a generated class
+ * Sits between the GetOptSetup and the templates and records what the optimization
+ * passes decided: which strings share an entry of the message table, which conversion
+ * helpers and argument helpers the class needs, and which options need no checks in
+ * parse(). The options are added in their order, possibly while the spec is parsed, so
+ * the result does not depend on how the spec was emitted.
+ */
+class ClassIR {
+public:
+    /**
+     * @brief Helpers defined once per class instead of being repeated for every option
+     */
+    enum Helper {
+        MISSING_ARGUMENT,
+        UNEXPECTED_ARGUMENT,
+        CONFLICTING_OPTIONS,
+        BOOLEAN_VALUE,
+        HELPER_COUNT
+    };
+
+    /**
+     * @brief Entry of a string that is not in the message table
+     */
+    static const std::size_t NO_MESSAGE = SIZE_MAX;
+
+    /**
+     * @brief Representation of a single option
+     */
+    struct OptionIR {
+        /**
+         * @brief Message table entry of the ShortOpt and LongOpt, as used in argument errors
+         */
+        std::size_t flagsMessage = NO_MESSAGE;
+        /**
+         * @brief Message table entry of the args name, as used in conversion and exclusion errors
+         */
+        std::size_t nameMessage = NO_MESSAGE;
+        /**
+         * @brief False if parse() has nothing to convert or call for the option
+         */
+        bool handled = false;
+        /**
+         * @brief False if parse() has no exclusions to check for the option
+         */
+        bool checked = false;
+    };
+
+    /**
+     * @brief Adds the options that have not been added yet and runs the passes on them
+     * @param options all options parsed so far
+     * @param symbols the symbols of the options, names must be resolved
+     */
+    void addOptions(const std::vector<Option> &options, const SymbolTable &symbols);
+
+    /**
+     * @brief Runs the passes that need the exclusions, once the whole spec is analyzed
+     * @param options all options of the spec
+     * @param symbols the symbols of the options
+     * @param analyzer the analyzer that has validated the spec
+     */
+    void resolveExclusions(const std::vector<Option> &options, const SymbolTable &symbols,
+                           const SemanticAnalyzer &analyzer);
+
+    /**
+     * @brief Get the representation of an option
+     * @param index index of the option
+     * @return
+     */
+    const OptionIR &getOption(std::size_t index) const;
+
+    /**
+     * @brief Get the message table
+     * @return distinct strings, in the order they were first used
+     */
+    const std::vector<std::string> &getMessages() const;
+
+    /**
+     * @brief Get the value types that need a conversion helper
+     * @return distinct types, in the order they were first used
+     */
+    const std::vector<std::string> &getConversionTypes() const;
+
+    /**
+     * @brief Get whether the class needs a helper
+     * @param helper the helper
+     * @return
+     */
+    bool uses(Helper helper) const;
+
+    /**
+     * @brief Describes the ShortOpt and LongOpt of an option, e.g. "v/verbose"
+     * @param option the option
+     * @return
+     */
+    static std::string describeFlags(const Option &option);
+
+private:
+    /**
+     * @brief One entry per option added so far
+     */
+    std::vector<OptionIR> options;
+
+    /**
+     * @brief The message table
+     */
+    std::vector<std::string> messages;
+
+    /**
+     * @brief Index of every string in messages
+     */
+    std::unordered_map<std::string, std::size_t> messageIndex;
+
+    /**
+     * @brief Value types with a conversion helper
+     */
+    std::vector<std::string> conversionTypes;
+
+    /**
+     * @brief Helpers the class needs
+     */
+    std::array<bool, HELPER_COUNT> helpers{};
+
+    // Passes
+    /**
+     * @brief Stores the strings an option uses in the message table, each string only once
+     * Strings no generated code refers to are left out.
+     * @param option the option
+     * @param symbol the symbol of the option
+     * @param ir receives the message table entries
+     */
+    void deduplicateMessages(const Option &option, const OptionSymbol &symbol, OptionIR &ir);
+
+    /**
+     * @brief Replaces the per option conversion and argument checks with shared helpers
+     * @param option the option
+     * @param symbol the symbol of the option
+     */
+    void shareHelpers(const Option &option, const OptionSymbol &symbol);
+
+    /**
+     * @brief Drops the isSet check of an option that has nothing to convert or call
+     * @param option the option
+     * @param ir receives whether the check is needed
+     */
+    void eliminateDeadChecks(const Option &option, OptionIR &ir);
+
+    /**
+     * @brief Get the message table entry of a string, adding it if it is new
+     * @param message the string
+     * @return index in the message table
+     */
+    std::size_t internMessage(const std::string &message);
+
+    /**
+     * @brief Stores the args name of an option in the message table if it is not there yet
+     * @param index index of the option
+     * @param symbol the symbol of the option
+     */
+    void internName(std::size_t index, const OptionSymbol &symbol);
+};
+
+
+#endif //CODEGENERATOR_CLASSIR_H
@@ -0,0 +1,79 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_CODEFORMATTER_H
+#define CODEGENERATOR_CODEFORMATTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Indents generated code in a single pass
+ * The emitters write every line without indentation. The formatter tracks the nesting
+ * of braces outside of literals and comments and indents each line by four spaces per
+ * level, like astyle with its default options: namespaces are not indented, case labels
+ * line up with their switch and access labels with their class. Formatting formatted
+ * code gives the same code.
+ */
+class CodeFormatter {
+public:
+    /**
+     * @brief Formats a buffer of generated code
+     * @param data the code
+     * @param size size of the code in bytes
+     * @return the indented code
+     */
+    static std::string format(const char *data, std::size_t size);
+
+private:
+    /**
+     * @brief Kind of an open block, decides how its content is indented
+     */
+    enum class Block {
+        NAMESPACE,
+        SWITCH,
+        CLASS,
+        OTHER
+    };
+
+    /**
+     * @brief Open blocks, innermost last
+     */
+    std::vector<Block> blocks;
+
+    /**
+     * @brief Indentation level of the content of the innermost block
+     */
+    unsigned int depth = 0;
+
+    /**
+     * @brief True while inside a block comment that spans lines
+     */
+    bool inComment = false;
+
+    CodeFormatter() = default;
+
+    /**
+     * @brief Appends a single line, indented, to the output
+     * @param line the line without its line break
+     * @param length length of the line
+     * @param out receives the line
+     */
+    void formatLine(const char *line, std::size_t length, std::string &out);
+
+    /**
+     * @brief Opens a block
+     * @param block kind of the block
+     */
+    void open(Block block);
+
+    /**
+     * @brief Closes the innermost block, unbalanced braces are ignored
+     */
+    void close();
+};
+
+
+#endif //CODEGENERATOR_CODEFORMATTER_H
@@ -6,6 +6,10 @@
 #define PROGRAMMING_C_CODEGENERATOR_H
 
 #include <string>
+#include <vector>
+#include "SpecGenerator.h"
+
+class OutputManifest;
 
 /**
  * @brief Class for the CodeGenerator
@@ -13,15 +17,85 @@
 class CodeGenerator {
 private:
     /**
-     * @brief String containing path to the file
+     * @brief Paths to the specs or to directories containing specs
      */
-    std::string filePath;
+    std::vector<std::string> filePaths;
+
+    /**
+     * @brief Path to a manifest file listing one spec per line
+     */
+    std::string manifestPath;
 
     /**
      * @brief Output directory
      */
     std::string outputDir;
 
+    /**
+     * @brief Number of worker threads, 0 means one per hardware thread
+     */
+    unsigned int jobs = 1;
+
+    /**
+     * @brief Regenerate all specs even if the output manifest says they are up to date
+     */
+    bool force = false;
+
+    /**
+     * @brief Generates the single specs, holds the settings that affect the generated code
+     */
+    SpecGenerator specGenerator;
+
+    /**
+     * @brief File name of the amalgamated source in the output directory, empty if disabled
+     */
+    std::string amalgamation;
+
+    /**
+     * @brief Path of the depfile written after a run, empty if disabled
+     */
+    std::string depfile;
+
+    /**
+     * @brief Results of the last run, in the order of the collected specs
+     */
+    std::vector<SpecResult> results;
+
+    /**
+     * @brief Expands directories and the manifest into the list of spec files
+     * @return paths of all specs to generate
+     */
+    std::vector<std::string> collectSpecs() const;
+
+    /**
+     * @brief Fails the specs of the last run that wrote the same file as another spec
+     * Compares the files the specs actually wrote, the recorded outputs of skipped specs included.
+     * Colliding specs lose their manifest entry, so they are not skipped by the next run.
+     * @param manifest the output manifest of the run
+     * @param otherSpecs specs that may not have been part of the run, their outputs are taken from the manifest
+     */
+    void checkOutputPaths(OutputManifest &manifest, const std::vector<std::string> &otherSpecs);
+
+    /**
+     * @brief Generates the given specs, skipping those the output manifest lists as up to date
+     * @param specs paths of the specs
+     * @param otherSpecs further specs writing into the output directory, checked for colliding outputs
+     * @return number of specs that failed
+     */
+    std::size_t generate(const std::vector<std::string> &specs, const std::vector<std::string> &otherSpecs = {});
+
+    /**
+     * @brief Time without further writes after which watched specs are regenerated
+     */
+    static const int watchDebounceMs = 10;
+
+    /**
+     * @brief Writes a Make rule listing every file the run read as a prerequisite of every generated file
+     *        and of the depfile itself
+     * @throws GeneratorException if the depfile can not be written
+     */
+    void writeDepfile() const;
+
 public:
     /**
      * @brief Constructor
@@ -29,10 +103,16 @@ public:
     CodeGenerator() = default;
 
     /**
-     * @brief Get the path to the file
+     * @brief Get the paths to the specs
      * @return
      */
-    std::string getFilePath();
+    const std::vector<std::string> &getFilePaths() const;
+
+    /**
+     * @brief Get the path to the manifest file
+     * @return
+     */
+    const std::string &getManifestPath() const;
 
     /**
      * Get the output directory
@@ -41,10 +121,100 @@ public:
     std::string getOutputDir();
 
     /**
-     * @brief Set the path to the file
+     * @brief Get the number of worker threads
+     * @return
+     */
+    unsigned int getJobs() const;
+
+    /**
+     * @brief Get the directory of the model cache
+     * @return
+     */
+    const std::string &getCacheDir() const;
+
+    /**
+     * @brief Get whether up-to-date specs are regenerated
+     * @return
+     */
+    bool isForce() const;
+
+    /**
+     * @brief Get the front end used to parse the specs
+     * @return
+     */
+    Frontend getFrontend() const;
+
+    /**
+     * @brief Get whether illegal transitions fail the spec
+     * @return
+     */
+    bool isStrict() const;
+
+    /**
+     * @brief Get the memory budget per spec
+     * @return bytes, 0 if unlimited
+     */
+    std::size_t getMaxMemory() const;
+
+    /**
+     * @brief Get whether parsing and emitting overlap
+     * @return
+     */
+    bool isPipeline() const;
+
+    /**
+     * @brief Get the number of threads generating the fragments of a single spec
+     * @return
+     */
+    unsigned int getEmitJobs() const;
+
+    /**
+     * @brief Get the number of sources the code of a spec is split into
+     * @return
+     */
+    unsigned int getShards() const;
+
+    /**
+     * @brief Get the file name of the amalgamated source
+     * @return empty if disabled
+     */
+    const std::string &getAmalgamation() const;
+
+    /**
+     * @brief Get the directory of the templates
+     * @return empty for the default set
+     */
+    const std::string &getTemplateDir() const;
+
+    /**
+     * @brief Get the path of the depfile
+     * @return empty if disabled
+     */
+    const std::string &getDepfile() const;
+
+    /**
+     * @brief Get the shared cache of generated files
+     * @return nullptr if disabled
+     */
+    OutputCache *getOutputCache() const;
+
+    /**
+     * @brief Get the results of the last run
+     * @return one result per generated spec
+     */
+    const std::vector<SpecResult> &getResults() const;
+
+    /**
+     * @brief Add a spec or a directory containing specs
      * @param filename
      */
-    void setFilePath(const std::string &filename);
+    void addFilePath(const std::string &filename);
+
+    /**
+     * @brief Set the path to a manifest file listing one spec per line
+     * @param filename
+     */
+    void setManifestPath(const std::string &filename);
 
     /**
      * @brief Set the output directory
@@ -53,9 +223,96 @@ public:
     void setOutputDir(const std::string &dir);
 
     /**
-     * @brief Runs the CodeGenerator
+     * @brief Set the number of worker threads
+     * @param jobs
+     */
+    void setJobs(unsigned int jobs);
+
+    /**
+     * @brief Set the directory of the model cache, empty disables the cache
+     * @param dir
+     */
+    void setCacheDir(const std::string &dir);
+
+    /**
+     * @brief Set whether up-to-date specs are regenerated
+     * @param force
+     */
+    void setForce(bool force);
+
+    /**
+     * @brief Set the front end used to parse the specs
+     * @param frontend
+     */
+    void setFrontend(Frontend frontend);
+
+    /**
+     * @brief Set whether illegal transitions fail the spec
+     * @param strict
+     */
+    void setStrict(bool strict);
+
+    /**
+     * @brief Set the memory budget per spec
+     * @param bytes 0 means unlimited
+     */
+    void setMaxMemory(std::size_t bytes);
+
+    /**
+     * @brief Set whether parsing and emitting overlap
+     * @param pipeline
+     */
+    void setPipeline(bool pipeline);
+
+    /**
+     * @brief Set the number of threads generating the fragments of a single spec
+     * @param jobs 0 means one per core
+     */
+    void setEmitJobs(unsigned int jobs);
+
+    /**
+     * @brief Set the number of sources the code of a spec is split into
+     * @param shards 1 means a single source
+     */
+    void setShards(unsigned int shards);
+
+    /**
+     * @brief Set the file name of the amalgamated source written after all specs
+     * @param filename in the output directory, empty disables the amalgamation
+     */
+    void setAmalgamation(const std::string &filename);
+
+    /**
+     * @brief Set the directory with templates replacing the default ones
+     * @param dir empty for the default set
+     */
+    void setTemplateDir(const std::string &dir);
+
+    /**
+     * @brief Set the path of a depfile for Make or Ninja, written after a successful run
+     * @param path empty disables the depfile
+     */
+    void setDepfile(const std::string &path);
+
+    /**
+     * @brief Set the shared cache of generated files
+     * @param dir directory of the cache, empty disables it
+     * @param maxBytes size above which the least recently used entries are evicted after a run
+     */
+    void setOutputCache(const std::string &dir, std::size_t maxBytes);
+
+    /**
+     * @brief Runs the CodeGenerator for all specs
+     * @return number of specs that failed
+     */
+    std::size_t run();
+
+    /**
+     * @brief Runs the CodeGenerator for all specs and then again for every spec that is written,
+     *        until the process is interrupted
+     * @throws GeneratorException if the specs can not be watched
      */
-    void run();
+    void watch();
 };
 
 
@@ -0,0 +1,65 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_CONTENTHASH_H
+#define CODEGENERATOR_CONTENTHASH_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Stable 64 bit FNV-1a hash of file contents
+ * The value does not depend on the platform or the Boost version,
+ * so it can be stored on disk and compared in later runs.
+ */
+class ContentHash {
+public:
+    /**
+     * @brief Hashes a block of bytes
+     * @param data pointer to the bytes
+     * @param size number of bytes
+     * @param seed hash to continue from, used to combine several blocks
+     * @return the hash
+     */
+    static uint64_t ofBytes(const char *data, std::size_t size, uint64_t seed = offsetBasis);
+
+    /**
+     * @brief Hashes a string
+     * @param data the string
+     * @param seed hash to continue from, used to combine several blocks
+     * @return the hash
+     */
+    static uint64_t ofString(const std::string &data, uint64_t seed = offsetBasis);
+
+    /**
+     * @brief Hashes the contents of a file
+     * @param path path to the file
+     * @param hash receives the hash
+     * @return false if the file could not be read
+     */
+    static bool ofFile(const std::string &path, uint64_t &hash);
+
+    /**
+     * @brief Formats a hash as 16 hex digits
+     * @param hash the hash
+     * @return hex representation
+     */
+    static std::string toHex(uint64_t hash);
+
+    /**
+     * @brief Parses a hash formatted by toHex
+     * @param hex hex representation
+     * @param hash receives the hash
+     * @return false if hex is not a valid hash
+     */
+    static bool fromHex(const std::string &hex, uint64_t &hash);
+
+    /**
+     * @brief FNV-1a offset basis, the hash of no bytes
+     */
+    static const uint64_t offsetBasis = 14695981039346656037ULL;
+};
+
+
+#endif //CODEGENERATOR_CONTENTHASH_H
@@ -0,0 +1,99 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_EMISSIONPIPELINE_H
+#define CODEGENERATOR_EMISSIONPIPELINE_H
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SourceCodeWriter.h"
+#include "models/GetOptSetup.h"
+
+/**
+ * @brief Overlaps parsing a spec with emitting the code of its options
+ * The parser thread pushes every completed option. A consumer thread collects the options
+ * apart from the model and lets the SourceCodeWriter emit their fragments, while the parser
+ * continues with the rest of the spec. finish() moves the options into the model, everything
+ * that needs the whole spec is left to SourceCodeWriter::writeFile() after that.
+ * Only the latency of a spec shrinks, the options and their fragments are kept until the
+ * code is written, as in the sequential mode.
+ */
+class EmissionPipeline {
+public:
+    /**
+     * @brief Starts the consumer thread
+     * @param getOptSetup the model the options are added to by finish(), the parser must not add options itself
+     * @param writer the writer of the spec, constructed with getOptSetup
+     */
+    EmissionPipeline(GetOptSetup &getOptSetup, SourceCodeWriter &writer);
+
+    EmissionPipeline(const EmissionPipeline &) = delete;
+    EmissionPipeline &operator=(const EmissionPipeline &) = delete;
+
+    /**
+     * @brief Stops the consumer thread after it emitted the remaining options, errors are only
+     * reported by finish()
+     */
+    ~EmissionPipeline();
+
+    /**
+     * @brief Hands a completed option to the consumer, called on the parser thread
+     * @param option the option, moved from
+     * @throws the error of the consumer if emitting an earlier option failed
+     */
+    void push(Option &&option);
+
+    /**
+     * @brief Waits until all pushed options have been emitted and adds them to the model
+     * Called on the parser thread once the spec is parsed.
+     * @throws the error of the consumer if emitting an option failed
+     */
+    void finish();
+
+private:
+    /**
+     * @brief Consumer thread, emits batches of options until the parser is done
+     */
+    void consume();
+
+    /**
+     * @brief Joins the consumer thread
+     */
+    void stop();
+
+    GetOptSetup &getOptSetup;
+    SourceCodeWriter &writer;
+
+    std::mutex mutex;
+    std::condition_variable available;
+
+    /**
+     * @brief Options pushed but not yet taken by the consumer
+     */
+    std::vector<Option> queue;
+
+    /**
+     * @brief Options taken by the consumer, only used by the consumer until it stopped
+     * The model is written by the parser thread at the same time, so they stay out of it.
+     */
+    std::vector<Option> options;
+
+    /**
+     * @brief ClassName when the first option was pushed
+     * Copied on the parser thread, the consumer must not read the model while it is parsed.
+     */
+    std::string className;
+
+    bool done = false;
+    std::exception_ptr error;
+
+    std::thread consumer;
+};
+
+
+#endif //CODEGENERATOR_EMISSIONPIPELINE_H
@@ -0,0 +1,52 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_GENERATORCLIENT_H
+#define CODEGENERATOR_GENERATORCLIENT_H
+
+#include <string>
+
+/**
+ * @brief Hands a command line to a GeneratorServer and waits for it
+ * The server writes directly to the stdout and stderr of the client, so a run through
+ * the server looks like a local run. The client does not initialize anything itself.
+ */
+class GeneratorClient {
+public:
+    /**
+     * @brief Constructor
+     * @param socketPath path of the socket of the server
+     */
+    explicit GeneratorClient(const std::string &socketPath);
+
+    /**
+     * @brief Runs a command line on the server
+     * @param argc number of arguments, including the program name
+     * @param argv the arguments, the program name is not sent
+     * @param status receives the exit status of the run
+     * @return false if no server is listening, then nothing has been run
+     */
+    bool run(int argc, char **argv, int &status) const;
+
+    /**
+     * @brief Prints the request latencies of the server
+     * @return false if the server could not be asked
+     */
+    bool printStats() const;
+
+private:
+    /**
+     * @brief Path of the socket of the server
+     */
+    std::string socketPath;
+
+    /**
+     * @brief Connects to the server
+     * @return the connected socket, -1 if no server is listening
+     */
+    int connectToServer() const;
+};
+
+
+#endif //CODEGENERATOR_GENERATORCLIENT_H
@@ -0,0 +1,26 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_GENERATOREXCEPTION_H
+#define CODEGENERATOR_GENERATOREXCEPTION_H
+
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Exception for errors while generating code from a single spec
+ * Thrown instead of terminating the process, so that a batch run can
+ * report the failing spec and continue with the remaining ones.
+ */
+class GeneratorException : public std::runtime_error {
+public:
+    /**
+     * @brief Constructor
+     * @param message Description of the error
+     */
+    explicit GeneratorException(const std::string &message) : std::runtime_error(message) {}
+};
+
+
+#endif //CODEGENERATOR_GENERATOREXCEPTION_H
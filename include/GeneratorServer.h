@@ -0,0 +1,133 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_GENERATORSERVER_H
+#define CODEGENERATOR_GENERATORSERVER_H
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/**
+ * @brief Long-running generator that serves command lines over a Unix domain socket
+ * Logging, Xerces and the default templates are initialized once when the server starts.
+ * Every RUN request is handled by a child process forked from this warm state. The child
+ * takes over the stdout and stderr of the client and its working directory and runs the
+ * command line, so the output and the exit status are the same as for a local run.
+ * The server itself never parses a spec, so a failing request can not take it down.
+ */
+class GeneratorServer {
+public:
+    /**
+     * @brief Runs a command line and returns its exit status, called in the child process
+     */
+    typedef std::function<int(int argc, char **argv)> CommandLine;
+
+    /**
+     * @brief Constructor
+     * @param socketPath path of the socket, replaced if it exists
+     */
+    explicit GeneratorServer(const std::string &socketPath);
+
+    /**
+     * @brief Serves requests until SIGINT or SIGTERM arrives
+     * @param commandLine runs the command line of a RUN request
+     * @return exit status of the server
+     * @throws GeneratorException if the socket can not be created
+     */
+    int serve(const CommandLine &commandLine);
+
+    /**
+     * @brief Describes the latencies of the requests served so far
+     * @return number of requests and the 50th, 90th and 99th percentile and maximum in milliseconds
+     */
+    std::string describeLatencies() const;
+
+private:
+    /**
+     * @brief A RUN request whose child is still running
+     */
+    struct PendingRun {
+        /**
+         * @brief Connection to the client, receives the exit status
+         */
+        int connection;
+        /**
+         * @brief Time the request was accepted
+         */
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * @brief Path of the socket
+     */
+    std::string socketPath;
+
+    /**
+     * @brief Listening socket
+     */
+    int listener = -1;
+
+    /**
+     * @brief Running children by process id
+     */
+    std::map<pid_t, PendingRun> pendingRuns;
+
+    /**
+     * @brief Latencies of the last requests in milliseconds, the oldest are overwritten
+     */
+    std::vector<double> latencies;
+
+    /**
+     * @brief Number of requests served so far
+     */
+    std::size_t servedRequests = 0;
+
+    /**
+     * @brief Most latencies kept for the percentiles
+     */
+    static const std::size_t latencyWindow = 100000;
+
+    /**
+     * @brief Reads a request from a new connection and starts or answers it
+     * @param connection the accepted connection, closed when the request is done
+     * @param commandLine runs the command line of a RUN request
+     */
+    void handleConnection(int connection, const CommandLine &commandLine);
+
+    /**
+     * @brief Forks the child of a RUN request
+     * @param connection connection to the client
+     * @param payload working directory and command line
+     * @param fds stdout and stderr of the client
+     * @param commandLine runs the command line
+     * @param start time the request was accepted
+     */
+    void startRun(int connection, const std::string &payload, const std::vector<int> &fds,
+                  const CommandLine &commandLine, std::chrono::steady_clock::time_point start);
+
+    /**
+     * @brief Sends the exit status of finished children to their clients
+     */
+    void reapChildren();
+
+    /**
+     * @brief Sends the exit status of a reaped child to its client and records the latency
+     * @param pid process id of the child, ignored if it does not belong to a request
+     * @param status status of the child as returned by waitpid
+     */
+    void finishRun(pid_t pid, int status);
+
+    /**
+     * @brief Records the latency of a finished request
+     * @param start time the request was accepted
+     */
+    void recordLatency(std::chrono::steady_clock::time_point start);
+};
+
+
+#endif //CODEGENERATOR_GENERATORSERVER_H
@@ -22,7 +22,7 @@ public:
     /**
      * @brief Constructor for the HelpText
      */
-    explicit HelpText(GetOptSetup *getOptSetup);
+    explicit HelpText(const GetOptSetup *getOptSetup);
     /**
      * @brief Destructor for the HelpText
      */
@@ -78,7 +78,7 @@ private:
     * @param i iteration counter to determine which option is parsed
     * @return concatenated opts as string
     */
-    vector<string> concatParams(const vector<Option>& sortedOpts);
+    vector<string> concatParams(const vector<const Option *>& sortedOpts);
     /**
      * @brief printHelp Text
      * stores the string for the printHelp method.
@@ -104,7 +104,7 @@ private:
     /**
      * @brief GetOptSetup object
      */
-    GetOptSetup *getOptSetup;
+    const GetOptSetup *getOptSetup;
 };
 
 #endif //CODEGENERATOR_HELPTEXT_H
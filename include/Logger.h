@@ -29,7 +29,25 @@ public:
 
     /// @param configFileName config ini file that contains boost logging properties.
     ///        If configFileName.empty() then default initialization.
-    static void initFromConfig(const std::string& configFileName);
+    /// @param synchronous write every sink from the logging thread, even if the config makes it asynchronous.
+    ///        A process that forks must not have the feeding threads of asynchronous sinks.
+    static void initFromConfig(const std::string& configFileName, bool synchronous = false);
+
+    /// Defer initFromConfig() until the first record is logged, so runs that log nothing
+    /// neither register the Boost.Log factories nor read the config file.
+    /// @param configFileName config ini file, see initFromConfig()
+    /// @param synchronous see initFromConfig()
+    static void initLazily(const std::string& configFileName, bool synchronous = false);
+
+    /// @return the system logger, initialized first if initLazily() deferred it
+    static sysLogger::logger_type& getSysLogger();
+
+    /// @return the data logger, initialized first if initLazily() deferred it
+    static dataLogger::logger_type& getDataLogger();
+
+    /// Only log warnings and errors, to the console. If initLazily() has not initialized yet,
+    /// the config file is not read, so no log files are created.
+    static void quiet();
 
     /// Disable logging
     static void disable();
@@ -47,20 +65,20 @@ public:
 
 /// System Log macros.
 /// TRACE < DEBUG < INFO < WARN < ERROR < FATAL
-#define LOG_TRACE(ARG) LOG_LOG_LOCATION(sysLogger::get(), trace, ARG);
-#define LOG_DEBUG(ARG) LOG_LOG_LOCATION(sysLogger::get(), debug, ARG);
-#define LOG_INFO(ARG)  LOG_LOG_LOCATION(sysLogger::get(), info, ARG);
-#define LOG_WARN(ARG)  LOG_LOG_LOCATION(sysLogger::get(), warning, ARG);
-#define LOG_ERROR(ARG) LOG_LOG_LOCATION(sysLogger::get(), error, ARG);
-#define LOG_FATAL(ARG) LOG_LOG_LOCATION(sysLogger::get(), fatal, ARG);
+#define LOG_TRACE(ARG) LOG_LOG_LOCATION(Logger::getSysLogger(), trace, ARG);
+#define LOG_DEBUG(ARG) LOG_LOG_LOCATION(Logger::getSysLogger(), debug, ARG);
+#define LOG_INFO(ARG)  LOG_LOG_LOCATION(Logger::getSysLogger(), info, ARG);
+#define LOG_WARN(ARG)  LOG_LOG_LOCATION(Logger::getSysLogger(), warning, ARG);
+#define LOG_ERROR(ARG) LOG_LOG_LOCATION(Logger::getSysLogger(), error, ARG);
+#define LOG_FATAL(ARG) LOG_LOG_LOCATION(Logger::getSysLogger(), fatal, ARG);
 
 /// Data Log macros. Does not include LINE, FILE, FUNCTION.
 /// TRACE < DEBUG < INFO < WARN < ERROR < FATAL
-#define LOG_DATA_TRACE(ARG) BOOST_LOG_SEV(dataLogger::get(), boost::log::trivial::trace) << ARG
-#define LOG_DATA_DEBUG(ARG) BOOST_LOG_SEV(dataLogger::get(), boost::log::trivial::debug) << ARG
-#define LOG_DATA_INFO(ARG)  BOOST_LOG_SEV(dataLogger::get(), boost::log::trivial::info) << ARG
-#define LOG_DATA_WARN(ARG)  BOOST_LOG_SEV(dataLogger::get(), boost::log::trivial::warning) << ARG
-#define LOG_DATA_ERROR(ARG) BOOST_LOG_SEV(dataLogger::get(), boost::log::trivial::error) << ARG
-#define LOG_DATA_FATAL(ARG) BOOST_LOG_SEV(dataLogger::get(), boost::log::trivial::fatal) << ARG
+#define LOG_DATA_TRACE(ARG) BOOST_LOG_SEV(Logger::getDataLogger(), boost::log::trivial::trace) << ARG
+#define LOG_DATA_DEBUG(ARG) BOOST_LOG_SEV(Logger::getDataLogger(), boost::log::trivial::debug) << ARG
+#define LOG_DATA_INFO(ARG)  BOOST_LOG_SEV(Logger::getDataLogger(), boost::log::trivial::info) << ARG
+#define LOG_DATA_WARN(ARG)  BOOST_LOG_SEV(Logger::getDataLogger(), boost::log::trivial::warning) << ARG
+#define LOG_DATA_ERROR(ARG) BOOST_LOG_SEV(Logger::getDataLogger(), boost::log::trivial::error) << ARG
+#define LOG_DATA_FATAL(ARG) BOOST_LOG_SEV(Logger::getDataLogger(), boost::log::trivial::fatal) << ARG
 
 #endif /* LOG_LOGGER_H */
\ No newline at end of file
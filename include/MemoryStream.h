@@ -0,0 +1,70 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_MEMORYSTREAM_H
+#define CODEGENERATOR_MEMORYSTREAM_H
+
+#include <cstddef>
+#include <cstdio>
+
+/**
+ * @brief Growable in-memory FILE for fprintf based emitters
+ * Wraps open_memstream, so code can be written into a fragment with the same
+ * fprintf calls as into a file and spliced into the output later.
+ */
+class MemoryStream {
+public:
+    MemoryStream() = default;
+
+    MemoryStream(const MemoryStream &) = delete;
+    MemoryStream &operator=(const MemoryStream &) = delete;
+
+    ~MemoryStream();
+
+    /**
+     * @brief Get the stream, it is opened on first use
+     * @return
+     * @throws GeneratorException if the stream can not be opened
+     */
+    FILE *getFile();
+
+    /**
+     * @brief Appends everything written so far to another stream
+     * @param out the stream to append to
+     */
+    void writeTo(FILE *out);
+
+    /**
+     * @brief Appends a part of everything written so far to another stream
+     * @param out the stream to append to
+     * @param begin offset of the first byte
+     * @param end offset after the last byte
+     */
+    void writeTo(FILE *out, std::size_t begin, std::size_t end);
+
+    /**
+     * @brief Get everything written so far
+     * @return valid until the next write
+     */
+    const char *getData();
+
+    /**
+     * @brief Get the number of bytes written so far
+     * @return
+     */
+    std::size_t getSize();
+
+    /**
+     * @brief Discards everything written so far
+     */
+    void clear();
+
+private:
+    FILE *file = nullptr;
+    char *buffer = nullptr;
+    size_t bufferSize = 0;
+};
+
+
+#endif //CODEGENERATOR_MEMORYSTREAM_H
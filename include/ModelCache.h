@@ -0,0 +1,62 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_MODELCACHE_H
+#define CODEGENERATOR_MODELCACHE_H
+
+#include <cstdint>
+#include <string>
+#include "models/GetOptSetup.h"
+
+/**
+ * @brief Persistent cache of parsed GetOptSetup models
+ * Every entry is a binary serialization of the model, stored in the cache directory
+ * under the content hash of its spec. Entries written with a different layoutVersion
+ * or by another CODEGENERATOR_VERSION are treated as misses and overwritten.
+ */
+class ModelCache {
+public:
+    /**
+     * @brief Version of the binary layout, must be increased whenever serialize() changes
+     */
+    static const uint32_t layoutVersion = 2;
+
+    /**
+     * @brief Constructor
+     * @param directory directory holding the cache entries, created on the first store
+     */
+    explicit ModelCache(const std::string &directory);
+
+    /**
+     * @brief Loads a cached model
+     * @param specHash ContentHash of the spec
+     * @param getOptSetup receives the model on a hit
+     * @return true on a hit, false if there is no valid entry
+     */
+    bool load(uint64_t specHash, GetOptSetup &getOptSetup) const;
+
+    /**
+     * @brief Stores a model, replacing an existing entry atomically
+     * Failures are logged and otherwise ignored, the cache is only an optimization.
+     * @param specHash ContentHash of the spec
+     * @param getOptSetup the parsed model
+     */
+    void store(uint64_t specHash, const GetOptSetup &getOptSetup) const;
+
+    /**
+     * @brief Get the path of the entry for a spec
+     * @param specHash ContentHash of the spec
+     * @return path to the entry
+     */
+    std::string pathOf(uint64_t specHash) const;
+
+private:
+    /**
+     * @brief Directory holding the cache entries
+     */
+    std::string directory;
+};
+
+
+#endif //CODEGENERATOR_MODELCACHE_H
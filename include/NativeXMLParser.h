@@ -0,0 +1,149 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_NATIVEXMLPARSER_H
+#define CODEGENERATOR_NATIVEXMLPARSER_H
+
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+#include "SpecParser.h"
+
+/**
+ * @brief Memory mapped front end for specs
+ * Small tokenizer for the XML subset used by specs. The file is mapped into memory and
+ * element names, attribute values and text are handed to the model as views on the
+ * UTF-8 bytes. Only values containing entity references are copied, into reused buffers.
+ * Supported are elements, attributes, text, comments, CDATA sections, processing
+ * instructions and a DOCTYPE without internal subset.
+ */
+class NativeXMLParser : public SpecParser {
+public:
+    /**
+     * @brief Constructor
+     * @param filename Name of the file to parse.
+     */
+    explicit NativeXMLParser(const std::string &filename);
+
+    /**
+     * @brief Maps the file and parses it
+     * @throws GeneratorException if the file cannot be read or is not well-formed
+     */
+    void parse() override;
+
+protected:
+    std::string getLocation() const override;
+
+private:
+    /**
+     * @brief Attribute of the current start tag
+     */
+    struct Attribute {
+        boost::string_view name;
+        boost::string_view value;
+    };
+
+    /**
+     * @brief Parses the whole mapped document
+     */
+    void parseDocument();
+
+    /**
+     * @brief Parses a start or empty-element tag, position is behind '<'
+     */
+    void parseStartTag();
+
+    /**
+     * @brief Parses an end tag, position is behind "</"
+     */
+    void parseEndTag();
+
+    /**
+     * @brief Parses text up to the next '<'
+     */
+    void parseText();
+
+    /**
+     * @brief Skips a construct up to and including the terminator
+     * @param terminator end of the construct, e.g. "-->"
+     * @param what name of the construct for error messages
+     * @return view of the skipped content without the terminator
+     */
+    boost::string_view skipPast(boost::string_view terminator, const char *what);
+
+    /**
+     * @brief Parses a name, position is at its first character
+     * @return view of the name
+     */
+    boost::string_view parseName();
+
+    /**
+     * @brief Skips whitespace
+     */
+    void skipWhitespace();
+
+    /**
+     * @brief Replaces entity and character references and normalizes line breaks
+     * @param raw raw text from the document
+     * @param buffer buffer for the decoded text, only used if raw contains references or has to be normalized
+     * @param attributeValue whether raw is an attribute value, its literal tabs and line breaks become spaces
+     * @return raw itself or a view of buffer
+     */
+    boost::string_view decode(boost::string_view raw, std::string &buffer, bool attributeValue = false) const;
+
+    /**
+     * @brief Handles a start tag with its attributes
+     * @param name name of the element
+     * @param attributes decoded attributes
+     */
+    void startElement(boost::string_view name, const std::vector<Attribute> &attributes);
+
+    /**
+     * @brief Handles an end tag
+     * @param name name of the element
+     */
+    void endElement(boost::string_view name);
+
+    /**
+     * @brief Throws a GeneratorException with file, line and column of the current position
+     * @param message description of the error
+     */
+    [[noreturn]] void fail(const std::string &message) const;
+
+    /**
+     * @brief Start of the mapped document
+     */
+    const char *begin = nullptr;
+    /**
+     * @brief Current tokenizer position
+     */
+    const char *position = nullptr;
+    /**
+     * @brief End of the mapped document
+     */
+    const char *end = nullptr;
+
+    /**
+     * @brief Names of the currently open elements
+     */
+    std::vector<boost::string_view> openElements;
+
+    /**
+     * @brief Attributes of the current start tag, reused for every tag
+     */
+    std::vector<Attribute> attributes;
+
+    /**
+     * @brief Buffers for attribute values containing references, one per attribute index
+     */
+    std::vector<std::string> attributeBuffers;
+
+    /**
+     * @brief Buffer for text containing references
+     */
+    std::string textBuffer;
+};
+
+
+#endif //CODEGENERATOR_NATIVEXMLPARSER_H
@@ -0,0 +1,136 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_OUTPUTCACHE_H
+#define CODEGENERATOR_OUTPUTCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shared cache of generated files, addressed by the content of the spec
+ * Every entry is a directory named after the hash of the spec and of the generator
+ * fingerprint and holds the generated files, so several checkouts or build machines can
+ * share it. A hit puts the files into the output directory without parsing the spec, new
+ * files as hard links, or as copies if the cache is on another file system, and files with
+ * other content as copies with the current time. Entries are touched on every hit, evict()
+ * removes the least recently used ones once the cache is too large.
+ */
+class OutputCache {
+public:
+    /**
+     * @brief Constructor
+     * @param directory directory holding the cache entries, created on the first store
+     * @param maxBytes size above which evict() removes entries
+     */
+    OutputCache(const std::string &directory, std::size_t maxBytes);
+
+    /**
+     * @brief Get the directory holding the cache entries
+     * @return
+     */
+    const std::string &getDirectory() const;
+
+    /**
+     * @brief Get the size above which entries are evicted
+     * @return bytes
+     */
+    std::size_t getMaxBytes() const;
+
+    /**
+     * @brief Puts the cached files of a spec into an output directory
+     * Files that already have the cached content are left untouched, missing directories
+     * below the output directory are created.
+     * @param key hash of the spec and the generator fingerprint
+     * @param outputDir output directory, empty or ending with a separator
+     * @param outputs receives the paths of the files on a hit
+     * @return true on a hit, false if there is no complete entry or it could not be used
+     */
+    bool materialize(uint64_t key, const std::string &outputDir, std::vector<std::string> &outputs);
+
+    /**
+     * @brief Stores the generated files of a spec, an existing entry is kept
+     * Failures are logged and otherwise ignored, the cache is only an optimization.
+     * @param key hash of the spec and the generator fingerprint
+     * @param outputDir output directory the files were generated into, empty or ending with a separator
+     * @param outputs paths of the generated files, in the order they are reported
+     */
+    void store(uint64_t key, const std::string &outputDir, const std::vector<std::string> &outputs);
+
+    /**
+     * @brief Removes the least recently used entries until the cache fits into its size
+     * Does nothing if store() added no entry, so runs that only hit or skip specs do not scan
+     * the cache.
+     */
+    void evict();
+
+    /**
+     * @brief Describes the hits, misses and bytes of this run, and the size of the cache if evict() scanned it
+     * @return one line of text
+     */
+    std::string describe() const;
+
+private:
+    /**
+     * @brief Directory holding the cache entries
+     */
+    std::string directory;
+
+    /**
+     * @brief Size above which entries are evicted
+     */
+    std::size_t maxBytes;
+
+    /**
+     * @brief Specs found in the cache
+     */
+    std::atomic<std::size_t> hits{0};
+
+    /**
+     * @brief Specs not found in the cache
+     */
+    std::atomic<std::size_t> misses{0};
+
+    /**
+     * @brief Bytes put into output directories from the cache
+     */
+    std::atomic<std::size_t> hitBytes{0};
+
+    /**
+     * @brief Bytes stored in the cache
+     */
+    std::atomic<std::size_t> storedBytes{0};
+
+    /**
+     * @brief Entries stored in the cache
+     */
+    std::atomic<std::size_t> storedEntries{0};
+
+    /**
+     * @brief Size of the cache after the last eviction
+     */
+    std::size_t cacheBytes = 0;
+
+    /**
+     * @brief Number of entries after the last eviction
+     */
+    std::size_t cacheEntries = 0;
+
+    /**
+     * @brief True once evict() has scanned the cache and cacheBytes and cacheEntries are known
+     */
+    bool scanned = false;
+
+    /**
+     * @brief Get the path of the entry of a spec
+     * @param key hash of the spec and the generator fingerprint
+     * @return path to the entry directory
+     */
+    std::string pathOf(uint64_t key) const;
+};
+
+
+#endif //CODEGENERATOR_OUTPUTCACHE_H
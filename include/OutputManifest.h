@@ -0,0 +1,137 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_OUTPUTMANIFEST_H
+#define CODEGENERATOR_OUTPUTMANIFEST_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Manifest of the specs generated into an output directory
+ * Stores size, mtime and content hash of every spec together with the generator
+ * that produced its outputs. A spec whose entry still matches is skipped without
+ * parsing it. All methods are thread-safe.
+ */
+class OutputManifest {
+public:
+    /**
+     * @brief Entry of a single spec
+     */
+    struct Entry {
+        /**
+         * @brief Size of the spec in bytes
+         */
+        uint64_t size = 0;
+        /**
+         * @brief Modification time of the spec in nanoseconds
+         */
+        int64_t mtime = 0;
+        /**
+         * @brief ContentHash of the spec
+         */
+        uint64_t hash = 0;
+        /**
+         * @brief Version and output-affecting settings of the generator
+         */
+        std::string generator;
+        /**
+         * @brief Paths of the files generated from the spec
+         */
+        std::vector<std::string> outputs;
+    };
+
+    /**
+     * @brief Constructor
+     * @param path path to the manifest file
+     */
+    explicit OutputManifest(const std::string &path);
+
+    /**
+     * @brief Reads the manifest file, a missing or unreadable file gives an empty manifest
+     */
+    void load();
+
+    /**
+     * @brief Writes the manifest file if it was modified
+     * The file is written to a temporary file first and renamed into place.
+     */
+    void save();
+
+    /**
+     * @brief Checks whether the outputs of a spec are up to date
+     * A matching size and mtime is trusted without reading the spec. Otherwise the
+     * content hash is compared and the entry is refreshed if only the stat changed.
+     * @param specPath path to the spec
+     * @param generator version and output-affecting settings of the generator
+     * @return true if the spec can be skipped
+     */
+    bool isUpToDate(const std::string &specPath, const std::string &generator);
+
+    /**
+     * @brief Records the outputs of a freshly generated spec
+     * The spec is not read again, it may have been written while it was generated.
+     * @param specPath path to the spec
+     * @param generator version and output-affecting settings of the generator
+     * @param spec size and hash of the bytes that were parsed and the mtime taken before they were read
+     * @param outputs paths of the generated files
+     */
+    void update(const std::string &specPath, const std::string &generator, const Entry &spec,
+                const std::vector<std::string> &outputs);
+
+    /**
+     * @brief Drops the entry of a spec, so it is not skipped by the next run
+     * @param specPath path to the spec
+     */
+    void forget(const std::string &specPath);
+
+    /**
+     * @brief Get the outputs recorded for a spec
+     * @param specPath path to the spec
+     * @return paths of the generated files, empty if the spec has no entry
+     */
+    std::vector<std::string> getOutputs(const std::string &specPath);
+
+    /**
+     * @brief Reads size and mtime of a file
+     * @param path path to the file
+     * @param entry receives size and mtime
+     * @return false if the file does not exist
+     */
+    static bool statFile(const std::string &path, Entry &entry);
+
+private:
+    /**
+     * @brief Key of a spec in the manifest, its absolute normalized path
+     * @param specPath path to the spec
+     * @return the key
+     */
+    static std::string keyOf(const std::string &specPath);
+
+    /**
+     * @brief Path to the manifest file
+     */
+    std::string path;
+
+    /**
+     * @brief Entries by key
+     */
+    std::map<std::string, Entry> entries;
+
+    /**
+     * @brief True if entries differ from the file
+     */
+    bool modified = false;
+
+    /**
+     * @brief Guards entries and modified
+     */
+    std::mutex mutex;
+};
+
+
+#endif //CODEGENERATOR_OUTPUTMANIFEST_H
@@ -0,0 +1,85 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SEMANTICANALYZER_H
+#define CODEGENERATOR_SEMANTICANALYZER_H
+
+#include <string>
+#include <vector>
+#include "models/GetOptSetup.h"
+#include "SymbolTable.h"
+
+/**
+ * @brief Checks a parsed spec before any code is written
+ * Indexes the Refs, ShortOpts and LongOpts of all options once and validates the
+ * spec in a single pass over the options and their exclusions. Every problem is
+ * collected, so all of them are reported at once. Resolved exclusions are handed
+ * to the SourceCodeWriter by option index, together with the SymbolTable whose
+ * colliding identifiers are reported by the analyzer as well.
+ */
+class SemanticAnalyzer {
+public:
+    /**
+     * @brief Constructor
+     * @param getOptSetup the model, must outlive the analyzer
+     */
+    explicit SemanticAnalyzer(const GetOptSetup &getOptSetup);
+
+    /**
+     * @brief Validates the spec and resolves the exclusions
+     * Reports duplicate ShortOpts, LongOpts and Refs, exclusions of unknown Refs,
+     * options that exclude themselves, options without a name and options that map
+     * to the same identifier or getopt value. Completes the SymbolTable.
+     * @throws GeneratorException listing every error if the spec is invalid
+     */
+    void analyze();
+
+    /**
+     * @brief Get the options an option can not be used together with
+     * @param index index of the option in GetOptSetup::getOptions()
+     * @return indices of the excluded options, in the order of the exclusions
+     */
+    const std::vector<std::size_t> &getExclusionTargets(std::size_t index) const;
+
+    /**
+     * @brief Get all errors found by analyze()
+     * @return
+     */
+    const std::vector<std::string> &getErrors() const;
+
+    /**
+     * @brief Get the identifiers of the options
+     * Names may be resolved while the spec is parsed, analyze() resolves the rest.
+     * @return
+     */
+    SymbolTable &getSymbols();
+
+    /**
+     * @brief Name of an option for messages, e.g. "--help" or "-h"
+     * @param option the option
+     * @return
+     */
+    static std::string describe(const Option &option);
+
+private:
+    /**
+     * @brief Logs and collects an error
+     * @param message the error
+     */
+    void error(const std::string &message);
+
+    const GetOptSetup &getOptSetup;
+
+    /**
+     * @brief Resolved exclusions, one entry per option
+     */
+    std::vector<std::vector<std::size_t>> exclusionTargets;
+
+    SymbolTable symbols;
+
+    std::vector<std::string> errors;
+};
+
+
+#endif //CODEGENERATOR_SEMANTICANALYZER_H
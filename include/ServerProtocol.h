@@ -0,0 +1,80 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SERVERPROTOCOL_H
+#define CODEGENERATOR_SERVERPROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Messages between the GeneratorClient and the GeneratorServer
+ * A request is a header of two 32-bit values, the kind and the size of the payload,
+ * followed by the payload, written with a BinaryWriter. File descriptors travel with
+ * the header. A RUN request is answered with the exit status of the run as a 32-bit
+ * value, a STATS request with a string.
+ */
+class ServerProtocol {
+public:
+    /**
+     * @brief Kinds of requests
+     */
+    enum Kind : uint32_t {
+        /**
+         * @brief Runs the command line given in the payload, stdout and stderr are attached
+         */
+        RUN = 1,
+        /**
+         * @brief Describes the request latencies of the server
+         */
+        STATS = 2
+    };
+
+    /**
+     * @brief Sends a request
+     * @param socket the connected socket
+     * @param kind kind of the request
+     * @param payload the payload
+     * @param fds file descriptors passed to the server
+     * @return false if the request could not be sent
+     */
+    static bool sendRequest(int socket, Kind kind, const std::string &payload, const std::vector<int> &fds);
+
+    /**
+     * @brief Receives a request
+     * @param socket the connected socket
+     * @param kind receives the kind of the request
+     * @param payload receives the payload
+     * @param fds receives the passed file descriptors, which the caller has to close
+     * @return false if the connection broke or the header is malformed
+     */
+    static bool receiveRequest(int socket, uint32_t &kind, std::string &payload, std::vector<int> &fds);
+
+    /**
+     * @brief Sends a whole buffer, retrying interrupted and partial writes
+     * @param fd the socket
+     * @param data the buffer
+     * @param size size of the buffer
+     * @return false on errors
+     */
+    static bool writeFully(int fd, const void *data, std::size_t size);
+
+    /**
+     * @brief Receives a whole buffer, retrying interrupted and partial reads
+     * @param fd the socket
+     * @param data the buffer
+     * @param size number of bytes to read
+     * @return false on errors or if the peer closed the connection before
+     */
+    static bool readFully(int fd, void *data, std::size_t size);
+
+    /**
+     * @brief Largest payload a server accepts
+     */
+    static const uint32_t maxPayload = 1024 * 1024;
+};
+
+
+#endif //CODEGENERATOR_SERVERPROTOCOL_H
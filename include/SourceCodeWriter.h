@@ -5,8 +5,28 @@
 #ifndef CODEGENERATOR_SOURCECODEWRITER_H
 #define CODEGENERATOR_SOURCECODEWRITER_H
 
+#include <array>
 #include <iostream>
+#include "ClassIR.h"
 #include "models/GetOptSetup.h"
+#include "MemoryStream.h"
+#include "SemanticAnalyzer.h"
+#include "SymbolTable.h"
+#include "TemplateSet.h"
+
+/**
+ * @brief A file generated in memory
+ */
+struct GeneratedFile {
+    /**
+     * @brief Path of the file, relative to the output directory
+     */
+    std::string path;
+    /**
+     * @brief Content of the file
+     */
+    std::string content;
+};
 
 /**
  * @brief Class for the SourceCodeWriter
@@ -16,7 +36,19 @@ private:
     /**
      * @brief The GetOptSetup
      */
-    GetOptSetup *getOptSetup = nullptr;
+    const GetOptSetup *getOptSetup = nullptr;
+    /**
+     * @brief Identifiers of the options, resolved as the options are emitted, owned by the analyzer
+     */
+    SymbolTable &symbols;
+    /**
+     * @brief Intermediate representation of the class, built as the options are emitted
+     */
+    ClassIR ir;
+    /**
+     * @brief Result of the semantic analysis, provides the resolved exclusions
+     */
+    const SemanticAnalyzer &analyzer;
     /**
      * @brief The header file
      */
@@ -27,154 +59,211 @@ private:
     FILE *sourceFile = nullptr;
 
     /**
-     * @brief Output directory
+     * @brief Memory buffer behind headerFile
      */
-    std::string outputDir;
+    char *headerBuffer = nullptr;
+    /**
+     * @brief Size of headerBuffer
+     */
+    size_t headerBufferSize = 0;
 
-    // Helpers
     /**
-     * @brief Get the type of the option depending on ConvertTo
-     * @param option The option
-     * @return The type of the option as string
+     * @brief Memory buffer behind sourceFile
+     */
+    char *sourceBuffer = nullptr;
+    /**
+     * @brief Size of sourceBuffer
      */
-    static string getValueTypeByOption(Option &option);
+    size_t sourceBufferSize = 0;
 
-    // Write code functions
     /**
-     * @brief
-     * Writes definitions and includes into Header-File
+     * @brief Number of output files whose content changed in the last writeFile()
+     */
+    int changedFiles = 0;
+
+    /**
+     * @brief Output directory
      */
-    void headerFileIncludes();
+    std::string outputDir;
 
     /**
-     * @brief
-     * Writes includes into Source-File
+     * @brief Keep the generated files in generatedFiles instead of writing them to disk
      */
-    void sourceFileIncludes();
+    bool inMemory = false;
 
     /**
-     * @brief
-     * Generate Header-File declaration of the function that will handle Options-parsing
+     * @brief Files generated by the last writeFile() in memory mode, in the order of getOutputFilePaths()
      */
-    void createHeaderParsingFunction();
+    std::vector<GeneratedFile> generatedFiles;
 
     /**
-     * @brief
-     * Generate implementation of the function that will handle Options-parsing
+     * @brief Independent parts of the output, each generated into its own buffer
+     * The fragments before OPTION_FRAGMENT_COUNT only depend on a single option and are
+     * emitted by emitOptions(), possibly while the spec is still parsed. The others need
+     * the whole spec. writeFile() generates the missing ones, in parallel with emitJobs
+     * threads, and splices all of them into the files in a fixed order.
      */
-    void createSourceParsingFunction();
+    enum Fragment {
+        STRUCT_ARGS,
+        VALUES,
+        HEADER_GETTERS,
+        EXTERNAL_FUNCTIONS,
+        SOURCE_GETTERS,
+        HANDLING,
+        OPTION_FRAGMENT_COUNT,
+        EXCLUSIONS = OPTION_FRAGMENT_COUNT,
+        LONG_OPTIONS,
+        CASES,
+        HELP,
+        FRAGMENT_COUNT
+    };
+    std::array<MemoryStream, FRAGMENT_COUNT> fragments;
 
     /**
-     * @brief
-     * Writes namespace into Source-File
+     * @brief Number of options whose fragments have been emitted
      */
-    void sourceFileNamespace();
+    std::size_t emittedOptions = 0;
 
     /**
-     * @brief
-     * Writes namespace into Header-File
+     * @brief Options the fragments are emitted from, those of the model unless emitOptions() is running
      */
-    void headerFileNamespace();
+    const std::vector<Option> *optionSource = nullptr;
 
     /**
-     * @brief
-     * Writes Class into namespace in Header-File
+     * @brief ClassName used in the SOURCE_GETTERS fragment
      */
-    void headerFileClass();
+    std::string fragmentClassName;
 
     /**
-     * @brief
-     * Writes exclusion check and execution of getOpts into Source-File
+     * @brief Number of threads generating fragments in writeFile()
      */
-    void sourceFileParse();
+    unsigned int emitJobs = 1;
 
     /**
-     * @brief
-     * Determines the name the Args-Struct will have for any given Option
-     * @param option
-     * @return
+     * @brief Number of sources the per option code is split into, 1 means no split
      */
-    static string determineArgsName(const Option& option);
+    unsigned int shards = 1;
 
     /**
-     * @brief
-     * Creates struct args for header
+     * @brief Offset after each option in every fragment, only recorded with shards
      */
-    void createHeaderStructArgs();
+    std::array<std::vector<std::size_t>, FRAGMENT_COUNT> optionEnds;
 
+    // Helpers
     /**
-     * @brief
-     * Generates the declaration of the unknownOption-function
+     * @brief Closes an in-memory output, indents it and stores it with storeFile()
+     * @param file the memory stream, closed and reset to nullptr
+     * @param buffer the buffer behind the memory stream
+     * @param bufferSize size of the buffer
+     * @param path path of the output file
+     * @return true if the file was written
      */
-    void createHeaderUnknownOption();
+    bool commitFile(FILE *&file, char *&buffer, size_t &bufferSize, const std::string &path);
 
     /**
-     * @brief
-     * Generates the implementation of the unknownOption-function
+     * @brief Writes an output file to disk if its content changed, or keeps it in memory mode
+     * Unchanged files are not touched, so their mtime stays and dependent files are not rebuilt.
+     * @param path path of the output file
+     * @param buffer the content
+     * @param bufferSize size of the content
+     * @return true if the file was written or kept
      */
-    void createSourceUnknownOption();
+    bool storeFile(const std::string &path, const char *buffer, size_t bufferSize);
 
     /**
-     * @brief
-     * Generates the declaration of all Getters in the Header-File
+     * @brief Writes content to disk if it differs from the existing file
+     * Changed files are written to a temporary file in the output directory and renamed into place.
+     * @param buffer the content
+     * @param bufferSize size of the content
+     * @param path path of the output file
+     * @return true if the file was written
      */
-    void createHeaderGetter();
+    static bool writeIfChanged(const char *buffer, size_t bufferSize, const std::string &path);
 
     /**
-     * @brief
-     * Generates the implementation of all Getters in the Header-File
+     * @brief The templates the code is rendered with
      */
-    void createSourceGetter();
+    const TemplateSet *templates;
 
     /**
-     * @brief
-     * Generates the declaration of every virtual function in the Header-File
+     * @brief Supplies the values of a spec to the templates
      */
-    void createExternalFunctions();
+    class RenderContext;
 
     /**
-     * @brief
-     * Generates the declaration of the printVersion function in the Header-File
+     * @brief Appends a range of options to a fragment
+     * Renders the option template of the fragment for every option in the range.
+     * @param fragment the fragment
+     * @param begin index of the first option
+     * @param end index after the last option, HELP ignores the range
      */
-    void createHeaderPrintVersion();
+    void emitFragment(Fragment fragment, std::size_t begin, std::size_t end);
 
     /**
-     * @brief
-     * Generates the implementation of the printVersion function in the Source-File
+     * @brief Renders a file template
+     * @param out the stream to write to
+     * @param kind the template
+     * @param shard the shard of a SHARD_FILE template, its blocks only hold the options of the shard
      */
-    void createSourcePrintVersion();
+    void renderFile(FILE *out, TemplateSet::Kind kind, unsigned int shard = 0);
 
+    // Shards
     /**
-     * @brief
-     * Generates the declaration of the printHelp function in the Header-File
+     * @brief Appends the part of a fragment that belongs to a range of options
+     * @param out the stream to append to
+     * @param fragment the fragment
+     * @param begin index of the first option
+     * @param end index after the last option
      */
-    void createHeaderPrintHelp();
+    void writeFragmentRange(FILE *out, Fragment fragment, std::size_t begin, std::size_t end);
 
     /**
-     * @brief
-     * Generates the implementation of the printHelp function in the Source-File
+     * @brief Writes the shard sources, the help source and the list of sources
      */
-    void createSourcePrintHelp();
+    void writeShards();
 public:
     // Constructor
     /**
      * @brief Constructor for the SourceCodeWriter
-     * @param getOptSetup The GetOptSetup
+     * @param getOptSetup The GetOptSetup, only read while writing
+     * @param analyzer The analyzer that validates getOptSetup before writeFile()
      */
-    explicit SourceCodeWriter(GetOptSetup *getOptSetup);
+    SourceCodeWriter(const GetOptSetup *getOptSetup, SemanticAnalyzer &analyzer);
     /**
      * @brief Destructor for the SourceCodeWriter
      */
     ~SourceCodeWriter();
 
+    /**
+     * @brief Emits the fragments of all options that have not been emitted yet
+     * Can be called while the spec is still parsed, with the options parsed so far.
+     * Names of the options are resolved here, the parts that need the whole spec
+     * (getopt values, exclusions, help text) are written by writeFile().
+     * @param className ClassName of the spec as far as it is known
+     * @param options the options parsed so far, kept apart from the model while it is parsed;
+     *        they must be the options of the model, in the same order, once writeFile() is called
+     */
+    void emitOptions(const std::string &className, const std::vector<Option> &options);
+
     /** @name Getter
     * @brief  Getter for the class
     */
     ///@{
-    GetOptSetup *getGetOptSetup() const;
+    const GetOptSetup *getGetOptSetup() const;
     FILE *getHeaderFile();
     FILE *getSourceFile();
     std::string getOutputDir();
+    std::string getHeaderFilePath() const;
+    std::string getSourceFilePath() const;
+    std::string getShardFilePath(unsigned int shard) const;
+    std::string getHelpFilePath() const;
+    std::string getShardListPath() const;
+    std::vector<std::string> getOutputFilePaths() const;
+    unsigned int getShards() const;
+    bool isSharded() const;
+    int getChangedFiles() const;
+    bool isInMemory() const;
+    const std::vector<GeneratedFile> &getGeneratedFiles() const;
     ///@}
 
     /** @name Setter
@@ -184,13 +273,36 @@ public:
     void setHeaderFile(FILE *headerFile);
     void setSourceFile(FILE *sourceFile);
     void setOutputDir(const std::string &dir);
+    void setShards(unsigned int shards);
+    void setEmitJobs(unsigned int jobs);
+    void setTemplates(const TemplateSet &templates);
+    void setInMemory(bool inMemory);
     ///@}
 
     // Methods
     /**
      * @brief Write the .h and .cpp files
+     * The code is generated in memory, files with unchanged content are left untouched.
+     * In memory mode the files are kept in getGeneratedFiles() and nothing is written.
+     * With more than one shard the getters, parse() and the parseOptions() switch are split
+     * over that many additional sources, the help text gets its own source and a list of
+     * all sources is written next to them.
      */
     void writeFile();
+
+    /**
+     * @brief Writes the sources of several specs into a single amalgamated source
+     * The includes common to all generated headers appear once at the top, every source
+     * follows with a #line directive pointing back to its file. The headers are still
+     * included by the sources, their include guards keep them from being parsed twice.
+     * Specs may share a namespace, every class declares its Args struct inside.
+     * Unchanged content is not written.
+     * @param path path of the amalgamated source, in the output directory of the specs
+     * @param outputs the files of every spec as returned by getOutputFilePaths()
+     * @return true if the file was written
+     * @throws GeneratorException if a file can not be read
+     */
+    static bool writeAmalgamation(const std::string &path, const std::vector<std::vector<std::string>> &outputs);
 };
 
 
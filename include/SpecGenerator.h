@@ -0,0 +1,224 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SPECGENERATOR_H
+#define CODEGENERATOR_SPECGENERATOR_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "OutputCache.h"
+#include "SourceCodeWriter.h"
+#include "SpecParser.h"
+#include "XMLParser.h"
+
+/**
+ * @brief Result of the generation of a single spec
+ */
+struct SpecResult {
+    /**
+     * @brief Path to the spec
+     */
+    std::string filePath;
+    /**
+     * @brief True if the code was generated successfully
+     */
+    bool success = false;
+    /**
+     * @brief True if the spec was skipped because its outputs were up to date
+     */
+    bool skipped = false;
+    /**
+     * @brief Error message if the generation failed
+     */
+    std::string message;
+    /**
+     * @brief Paths of the files generated from the spec, recorded ones if it was skipped
+     */
+    std::vector<std::string> outputs;
+    /**
+     * @brief Largest number of bytes the spec had charged to its memory budget at once while parsing
+     */
+    std::size_t memoryBytes = 0;
+    /**
+     * @brief Number of allocations of the spec while parsing
+     */
+    std::size_t memoryAllocations = 0;
+};
+
+/**
+ * @brief Generates the code of a single spec
+ * Entry point of the codegen library. The spec is read from a file or from memory, the
+ * code is written into an output directory or returned in memory. A SpecGenerator holds
+ * no state besides its settings, so one instance can generate several specs at the same
+ * time. Xerces is initialized once per process, by the first spec parsed with it, and is
+ * only terminated by XMLParser::terminate().
+ */
+class SpecGenerator {
+private:
+    /**
+     * @brief Directory of the persistent model cache, empty if disabled
+     */
+    std::string cacheDir;
+
+    /**
+     * @brief Front end used to parse the specs
+     */
+    Frontend frontend = Frontend::XERCES;
+
+    /**
+     * @brief Fail specs with elements in illegal places instead of ignoring them
+     */
+    bool strict = false;
+
+    /**
+     * @brief Memory budget per spec in bytes, 0 means unlimited
+     */
+    std::size_t maxMemory = 0;
+
+    /**
+     * @brief Emit the options of a spec on a second thread while it is parsed
+     */
+    bool pipeline = false;
+
+    /**
+     * @brief Number of threads generating the fragments of a single spec, 0 means one per core
+     */
+    unsigned int emitJobs = 1;
+
+    /**
+     * @brief Number of sources the code of a spec is split into, 1 means a single source
+     */
+    unsigned int shards = 1;
+
+    /**
+     * @brief Directory with templates replacing the default ones, empty for the default set
+     */
+    std::string templateDir;
+
+    /**
+     * @brief Shared cache of generated files, nullptr if disabled
+     */
+    std::shared_ptr<OutputCache> outputCache;
+
+    /**
+     * @brief Parses a spec, or loads its model from the model cache, and writes its code, or
+     *        takes the code from the output cache
+     * @param name path to the spec, only used in messages if the spec is in memory
+     * @param buffer the spec in memory, nullptr to read the file
+     * @param bufferSize size of buffer
+     * @param outputDir output directory, prepended to the paths of the generated files
+     * @param acquireParser returns the SAXParser to use for Xerces, if empty the parser
+     *        initializes Xerces if needed and uses a parser of its own
+     * @param result receives the memory counters and the paths of the generated files
+     * @param files receives the generated files, nullptr to write them to disk
+     */
+    void generate(const std::string &name, const char *buffer, std::size_t bufferSize,
+                  const std::string &outputDir, const std::function<SAXParser &()> &acquireParser,
+                  SpecResult &result, std::vector<GeneratedFile> *files) const;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    SpecGenerator() = default;
+
+    /** @name Getter
+    * @brief  Getter for the class
+    */
+    ///@{
+    const std::string &getCacheDir() const;
+    Frontend getFrontend() const;
+    bool isStrict() const;
+    std::size_t getMaxMemory() const;
+    bool isPipeline() const;
+    unsigned int getEmitJobs() const;
+    unsigned int getShards() const;
+    const std::string &getTemplateDir() const;
+    OutputCache *getOutputCache() const;
+    ///@}
+
+    /** @name Setter
+    * @brief  Setter for the class
+    */
+    ///@{
+    void setCacheDir(const std::string &dir);
+    void setFrontend(Frontend frontend);
+    void setStrict(bool strict);
+    void setMaxMemory(std::size_t bytes);
+    void setPipeline(bool pipeline);
+    void setEmitJobs(unsigned int jobs);
+    void setShards(unsigned int shards);
+    void setTemplateDir(const std::string &dir);
+    void setOutputCache(const std::string &dir, std::size_t maxBytes);
+    ///@}
+
+    /**
+     * @brief Describes everything besides the spec that affects the generated code
+     * A different value means that previously generated code is outdated.
+     * @return the generator version, the validation mode, the number of shards and the templates
+     */
+    std::string getFingerprint() const;
+
+    /**
+     * @brief Generates the code of a spec file into an output directory
+     * Files with unchanged content are left untouched. With an output cache, the files are
+     * taken from it if the spec was generated before with the same fingerprint.
+     * @param filePath path to the spec
+     * @param outputDir output directory, empty or ending with a separator
+     * @param acquireParser returns the SAXParser owned by the calling thread, only called if
+     *        the spec has to be parsed with Xerces, which must then be initialized
+     * @param result receives the memory counters and the paths of the generated files
+     * @throws GeneratorException or std::exception if the generation failed
+     */
+    void generateFile(const std::string &filePath, const std::string &outputDir,
+                      const std::function<SAXParser &()> &acquireParser, SpecResult &result) const;
+
+    /**
+     * @brief Generates the code of a spec file that has already been read into an output directory
+     * Like generateFile(filePath, outputDir, acquireParser, result), but the spec is parsed from
+     * memory, so the caller knows exactly which content the code was generated from.
+     * @param filePath path to the spec, only used in messages
+     * @param spec content of the spec, must stay valid until the call returns
+     * @param size size of the spec in bytes
+     * @param outputDir output directory, empty or ending with a separator
+     * @param acquireParser returns the SAXParser owned by the calling thread
+     * @param result receives the memory counters and the paths of the generated files
+     * @throws GeneratorException or std::exception if the generation failed
+     */
+    void generateFile(const std::string &filePath, const char *spec, std::size_t size, const std::string &outputDir,
+                      const std::function<SAXParser &()> &acquireParser, SpecResult &result) const;
+
+    /**
+     * @brief Generates the code of a spec held in memory, without touching the disk
+     * Only the model cache is read and written, if it is enabled.
+     * @param spec the spec
+     * @param size size of the spec in bytes
+     * @param name name of the spec in messages
+     * @return the generated files, the header first and the source second, named as in the spec
+     * @throws GeneratorException or std::exception if the generation failed
+     */
+    std::vector<GeneratedFile> generate(const char *spec, std::size_t size,
+                                        const std::string &name = "<memory>") const;
+
+    /**
+     * @brief Generates the header and the source of a spec held in memory into buffers
+     * Both sizes are set to the size of the generated text in any case, so a call with too
+     * small buffers tells how large they have to be. The text is not null terminated.
+     * @param spec the spec
+     * @param size size of the spec in bytes
+     * @param header buffer for the header, may be nullptr if headerSize is 0
+     * @param headerSize capacity of header, receives the size of the header
+     * @param source buffer for the source, may be nullptr if sourceSize is 0
+     * @param sourceSize capacity of source, receives the size of the source
+     * @return false if a buffer is too small, then nothing is copied
+     * @throws GeneratorException if the generation failed or more than one shard is configured
+     */
+    bool generate(const char *spec, std::size_t size, char *header, std::size_t &headerSize,
+                  char *source, std::size_t &sourceSize) const;
+};
+
+
+#endif //CODEGENERATOR_SPECGENERATOR_H
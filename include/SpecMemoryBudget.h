@@ -0,0 +1,79 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SPECMEMORYBUDGET_H
+#define CODEGENERATOR_SPECMEMORYBUDGET_H
+
+#include <cstddef>
+
+/**
+ * @brief Memory accounting of a single spec
+ * The parsers charge the bytes they allocate on the heap for the spec, e.g. model strings
+ * or the buffers of Xerces, and release them again when they are freed. Counts the bytes in
+ * use and the charges and enforces an optional budget on the bytes in use, so a runaway spec
+ * fails with a GeneratorException instead of exhausting the process.
+ */
+class SpecMemoryBudget {
+public:
+    /**
+     * @brief Constructor
+     * @param limit budget in bytes, 0 means unlimited
+     */
+    explicit SpecMemoryBudget(std::size_t limit = 0);
+
+    SpecMemoryBudget(const SpecMemoryBudget &) = delete;
+    SpecMemoryBudget &operator=(const SpecMemoryBudget &) = delete;
+
+    /**
+     * @brief Accounts memory allocated for the spec
+     * @param size number of bytes
+     * @throws GeneratorException if the budget is exceeded
+     */
+    void charge(std::size_t size);
+
+    /**
+     * @brief Returns charged memory that was freed again
+     * @param size number of bytes, as passed to charge()
+     */
+    void release(std::size_t size);
+
+    /**
+     * @brief Get the number of charged bytes that are still in use
+     * @return
+     */
+    std::size_t getBytes() const;
+
+    /**
+     * @brief Get the largest number of bytes in use at the same time
+     * @return
+     */
+    std::size_t getPeakBytes() const;
+
+    /**
+     * @brief Get the number of charges
+     * @return
+     */
+    std::size_t getAllocations() const;
+
+    /**
+     * @brief Get the budget in bytes
+     * @return 0 if unlimited
+     */
+    std::size_t getLimit() const;
+
+    /**
+     * @brief Set the budget in bytes
+     * @param limit 0 means unlimited
+     */
+    void setLimit(std::size_t limit);
+
+private:
+    std::size_t bytes = 0;
+    std::size_t peakBytes = 0;
+    std::size_t allocations = 0;
+    std::size_t limit;
+};
+
+
+#endif //CODEGENERATOR_SPECMEMORYBUDGET_H
@@ -0,0 +1,209 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SPECPARSER_H
+#define CODEGENERATOR_SPECPARSER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <boost/utility/string_view.hpp>
+#include "SpecMemoryBudget.h"
+#include "StateMachine.h"
+#include "models/GetOptSetup.h"
+
+/**
+ * @brief Front ends that can read a spec
+ */
+enum class Frontend {
+    /**
+     * @brief Xerces SAX parser, the default
+     */
+    XERCES,
+    /**
+     * @brief Memory mapped tokenizer working directly on the UTF-8 bytes
+     */
+    NATIVE
+};
+
+/**
+ * @brief Base class of all spec front ends
+ * Holds the state machine and builds the GetOptSetup from the events of the concrete parser.
+ */
+class SpecParser {
+public:
+    /**
+     * @brief Constructor
+     * @param filename Name of the file to parse.
+     */
+    explicit SpecParser(const std::string &filename);
+
+    virtual ~SpecParser() = default;
+
+    /**
+     * @brief Parses the whole file
+     * @throws GeneratorException if the file could not be parsed
+     */
+    virtual void parse() = 0;
+
+    /**
+     * @brief getGetOptSetup
+     * The GetOptSetup is owned by the parser.
+     * @return getOptSetup
+     */
+    GetOptSetup *getGetOptSetup() const;
+
+    /**
+     * @brief Get whether illegal transitions abort the parsing
+     * @return
+     */
+    bool isStrict() const;
+
+    /**
+     * @brief Set whether illegal transitions abort the parsing
+     * Otherwise they are logged as warning and ignored.
+     * @param strict
+     */
+    void setStrict(bool strict);
+
+    /**
+     * @brief Get the number of ignored illegal transitions
+     * @return
+     */
+    std::size_t getIllegalTransitions() const;
+
+    /**
+     * @brief Get the memory budget of the spec with its counters
+     * @return
+     */
+    const SpecMemoryBudget &getMemoryBudget() const;
+
+    /**
+     * @brief Set the memory budget of the spec
+     * @param limit budget in bytes, 0 means unlimited
+     */
+    void setMemoryLimit(std::size_t limit);
+
+    /**
+     * @brief Hands every completed option to a sink instead of adding it to the model
+     * The sink is called on the parsing thread and takes over the option, so it can be
+     * processed while the rest of the spec is parsed.
+     * @param sink receives the options in spec order
+     */
+    void setOptionSink(std::function<void(Option &&)> sink);
+
+    /**
+     * @brief Parses the spec from memory instead of reading the file
+     * The file name is then only used in messages. The buffer must stay valid until
+     * parse() returns.
+     * @param data the spec
+     * @param size size of the spec in bytes
+     */
+    void setBuffer(const char *data, std::size_t size);
+
+    /**
+     * @brief Parses a front end name as given on the command line
+     * @param name "xerces" or "native"
+     * @param frontend receives the front end
+     * @return false if the name is unknown
+     */
+    static bool frontendFromString(const std::string &name, Frontend &frontend);
+
+protected:
+    /**
+     * @brief Adds a completed option to the model or hands it to the option sink
+     * @param option the option, moved from
+     */
+    void addOption(Option &option);
+
+    /**
+     * @brief Passes an event to the state machine and reports illegal transitions
+     * @param event Event of a start or end tag
+     * @throws GeneratorException in strict mode if the event is not allowed in the current state
+     */
+    void handleEvent(Event event);
+
+    /**
+     * @brief Current position in the document for messages
+     * @return "file:line:column" or the file name if the position is unknown
+     */
+    virtual std::string getLocation() const;
+
+    /**
+     * @brief Appends text to the element of the current state
+     * A text node may arrive in several chunks. They are collected in one buffer and
+     * stored in the model when the element ends. Text outside of text elements is ignored.
+     * @param chars UTF-8 text
+     */
+    void handleCharacters(boost::string_view chars);
+
+    /**
+     * @brief Whether the current state collects text
+     * @return true inside HeaderFileName, SourceFileName, NameSpace, ClassName, Block and Sample
+     */
+    bool isTextState() const;
+
+    /**
+     * @brief filename
+     * Name of the file to parse.
+     */
+    std::string filename;
+
+    /**
+     * @brief stateMachine
+     * StateMachine to parse the file.
+     */
+    std::unique_ptr<StateMachine> sm{new StateMachine()};
+
+    /**
+     * @brief getOptSetup
+     * GetOptSetup to parse the file.
+     */
+    std::unique_ptr<GetOptSetup> getOptSetup{new GetOptSetup()};
+
+    /**
+     * @brief Memory of the spec, released together with the parser
+     */
+    SpecMemoryBudget memoryBudget;
+
+    /**
+     * @brief Spec held in memory, nullptr if the file is read
+     */
+    const char *buffer = nullptr;
+
+    /**
+     * @brief Size of buffer
+     */
+    std::size_t bufferSize = 0;
+
+    /**
+     * @brief Abort on illegal transitions
+     */
+    bool strict = false;
+
+    /**
+     * @brief Number of ignored illegal transitions
+     */
+    std::size_t illegalTransitions = 0;
+
+private:
+    /**
+     * @brief Receives completed options, empty if they are added to the model
+     */
+    std::function<void(Option &&)> optionSink;
+
+    /**
+     * @brief Stores the collected text in the model and clears the buffer
+     * @param state text state that has been left
+     */
+    void commitText(State state);
+
+    /**
+     * @brief Text collected in the current text state, reused for every element
+     */
+    std::string text;
+};
+
+
+#endif //CODEGENERATOR_SPECPARSER_H
@@ -0,0 +1,119 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SPECVOCABULARY_H
+#define CODEGENERATOR_SPECVOCABULARY_H
+
+#include <boost/utility/string_view.hpp>
+#include <xercesc/util/XercesDefs.hpp>
+#include "StateMachine.h"
+
+/**
+ * @brief Elements of a spec
+ */
+enum class SpecElement {
+    GETOPTSETUP,
+    AUTHOR,
+    HEADERFILENAME,
+    SOURCEFILENAME,
+    NAMESPACE,
+    CLASSNAME,
+    OVERALLDESCRIPTION,
+    BLOCK,
+    SAMPLEUSAGE,
+    SAMPLE,
+    OPTIONS,
+    OPTION,
+    UNKNOWN
+};
+
+/**
+ * @brief Attributes of the elements of a spec
+ */
+enum class SpecAttribute {
+    SIGNPERLINE,
+    NAME,
+    PHONE,
+    MAIL,
+    REF,
+    SHORTOPT,
+    LONGOPT,
+    DESCRIPTION,
+    EXCLUSION,
+    CONNECTTOINTERNALMETHOD,
+    CONNECTTOEXTERNALMETHOD,
+    HASARGUMENTS,
+    CONVERTTO,
+    DEFAULTVALUE,
+    INTERFACE,
+    UNKNOWN
+};
+
+/**
+ * @brief Resolves element and attribute names of a spec
+ * Names are dispatched by a switch over their length and one distinguishing character,
+ * followed by a single comparison with the candidate. The cost does not depend on the
+ * number of known names. Works on UTF-8 views and on the XMLCh strings of Xerces.
+ */
+class SpecVocabulary {
+public:
+    /**
+     * @brief Resolves an element name
+     * @param name UTF-8 name
+     * @return the element or SpecElement::UNKNOWN
+     */
+    static SpecElement element(boost::string_view name);
+
+    /**
+     * @brief Resolves an element name
+     * @param name zero terminated name as passed by Xerces
+     * @return the element or SpecElement::UNKNOWN
+     */
+    static SpecElement element(const XMLCh *name);
+
+    /**
+     * @brief Resolves an attribute name
+     * @param name UTF-8 name
+     * @return the attribute or SpecAttribute::UNKNOWN
+     */
+    static SpecAttribute attribute(boost::string_view name);
+
+    /**
+     * @brief Resolves an attribute name
+     * @param name zero terminated name as passed by Xerces
+     * @return the attribute or SpecAttribute::UNKNOWN
+     */
+    static SpecAttribute attribute(const XMLCh *name);
+
+    /**
+     * @brief Name of an element as written in the spec
+     * @param element known element
+     * @return the name
+     */
+    static const char *nameOf(SpecElement element);
+
+    /**
+     * @brief Name of an attribute as written in the spec
+     * @param attribute known attribute
+     * @return the name
+     */
+    static const char *nameOf(SpecAttribute attribute);
+
+    /**
+     * @brief State machine event for the start tag of an element
+     * @param element known element
+     * @return the event
+     */
+    static Event startEvent(SpecElement element);
+
+    /**
+     * @brief State machine event for the end tag of an element
+     * @param element known element
+     * @return the event
+     */
+    static Event endEvent(SpecElement element);
+};
+
+
+#endif //CODEGENERATOR_SPECVOCABULARY_H
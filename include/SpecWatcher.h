@@ -0,0 +1,74 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SPECWATCHER_H
+#define CODEGENERATOR_SPECWATCHER_H
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+
+/**
+ * @brief Waits for files in a set of directories to be written, using inotify
+ * Directories are watched instead of the files themselves, because editors often save by
+ * writing a new file and renaming it over the old one, which would end a watch on the file.
+ */
+class SpecWatcher {
+public:
+    /**
+     * @brief Constructor
+     * @throws GeneratorException if inotify is not available
+     */
+    SpecWatcher();
+
+    SpecWatcher(const SpecWatcher &) = delete;
+
+    SpecWatcher &operator=(const SpecWatcher &) = delete;
+
+    /**
+     * @brief Destructor, removes all watches
+     */
+    ~SpecWatcher();
+
+    /**
+     * @brief Watches a directory, nothing happens if it is already watched
+     * @param dir the directory
+     * @return false if the directory can not be watched
+     */
+    bool watchDirectory(const std::string &dir);
+
+    /**
+     * @brief Waits until files have been written and no further write followed for the debounce time
+     * @param debounce time without writes that ends a burst
+     * @return absolute, normalized paths of the written files, an empty path if events were lost
+     */
+    std::set<std::string> waitForChanges(std::chrono::milliseconds debounce);
+
+    /**
+     * @brief Longest time a burst of writes is collected before it is reported anyway
+     */
+    static const int maxBurstMs = 500;
+
+private:
+    /**
+     * @brief The inotify instance
+     */
+    int inotify = -1;
+
+    /**
+     * @brief Watched directories by watch descriptor
+     */
+    std::map<int, std::string> directories;
+
+    /**
+     * @brief Reads the pending events
+     * @param changed receives the paths of the written files
+     * @return false if no event was pending
+     */
+    bool readEvents(std::set<std::string> &changed);
+};
+
+
+#endif //CODEGENERATOR_SPECWATCHER_H
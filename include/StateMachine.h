@@ -5,6 +5,8 @@
 #ifndef CODEGENERATOR_STATEMACHINE_H
 #define CODEGENERATOR_STATEMACHINE_H
 
+#include <cstddef>
+
 /**
  * @brief States
  * States of the state machine.
@@ -57,9 +59,21 @@ enum class Event {
     OPTIONEND
 };
 
+/**
+ * @brief Number of states
+ */
+constexpr std::size_t stateCount = (std::size_t) State::END + 1;
+
+/**
+ * @brief Number of events
+ */
+constexpr std::size_t eventCount = (std::size_t) Event::OPTIONEND + 1;
+
 /**
  * @brief The StateMachine class
  * State machine that handles the events and transitions.
+ * The transitions are a constexpr State x Event table, see StateMachine.cpp.
+ * New spec elements only need new rows there.
  * @see Event
  * @see State
  * @see StateMachine::handleEvent
@@ -92,10 +106,26 @@ public:
     // Methods
     /**
      * @brief handleEvent
-     * Handles an event.
+     * Handles an event. Illegal events leave the state unchanged.
      * @param event Event to handle.
+     * @return false if the event is not allowed in the current state.
+     */
+    bool handleEvent(Event event);
+
+    // Names
+    /**
+     * @brief Name of a state for messages
+     * @param state State
+     * @return Name of the state.
+     */
+    static const char *stateName(State state);
+
+    /**
+     * @brief Name of an event for messages
+     * @param event Event
+     * @return Name of the event.
      */
-    void handleEvent(Event event);
+    static const char *eventName(Event event);
 
 private:
     State currentState;
@@ -0,0 +1,123 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_SYMBOLTABLE_H
+#define CODEGENERATOR_SYMBOLTABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "models/GetOptSetup.h"
+
+/**
+ * @brief Identifiers derived from a single option
+ */
+struct OptionSymbol {
+    /**
+     * @brief Name of the member in struct Args, e.g. "fooBar"
+     * Also the prefix of the value member, e.g. "fooBarValue".
+     */
+    std::string argsName;
+    /**
+     * @brief argsName with upper case first letter, e.g. "FooBar" for isSetFooBar()
+     */
+    std::string capitalizedName;
+    /**
+     * @brief C++ type of the converted argument
+     */
+    const char *valueType = "";
+    /**
+     * @brief Value getopt_long returns for the option, e.g. "'h'" or "3"
+     * Used as case label and in the long_options table. Empty if the option has
+     * neither a ShortOpt nor a LongOpt and therefore can never be passed.
+     */
+    std::string optionValue;
+};
+
+/**
+ * @brief Identifiers of all options of a spec
+ * Resolved once before the code is written, the emitters only look them up by the
+ * index of the option. Options that map to the same identifier or getopt value are
+ * collected as errors, because they would result in code that does not compile.
+ * Names can be resolved while options are still being parsed, the getopt values need
+ * all ShortOpts and are assigned once the spec is complete.
+ */
+class SymbolTable {
+public:
+    /**
+     * @brief Resolves the names of all options that have not been resolved yet
+     * Problems are collected in getErrors(), so they do not stop the parsing of the
+     * rest of the spec.
+     * @param options all options parsed so far, in spec order
+     */
+    void resolveNames(const std::vector<Option> &options);
+
+    /**
+     * @brief Assigns the getopt values once all options are known
+     * Called once per spec, options with the same getopt value are collected in getErrors().
+     * @param options all options of the spec
+     */
+    void resolveOptionValues(const std::vector<Option> &options);
+
+    /**
+     * @brief Get the options without a name and the colliding identifiers found so far
+     * @return
+     */
+    const std::vector<std::string> &getErrors() const;
+
+    /**
+     * @brief Get the number of options whose names are resolved
+     * @return
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get the symbols of an option
+     * @param index index of the option in GetOptSetup::getOptions()
+     * @return
+     */
+    const OptionSymbol &getSymbol(std::size_t index) const;
+
+    /**
+     * @brief Get the symbols of all options, in the order of the options
+     * @return
+     */
+    const std::vector<OptionSymbol> &getSymbols() const;
+
+    /**
+     * @brief Turns an option name into an identifier
+     * The first letter is lower case, ' ', '-', '.' and ':' are removed and the
+     * following letter is upper case. Example: "output-dir" becomes "outputDir".
+     * @param name Interface, LongOpt or ShortOpt of an option
+     * @return the identifier
+     */
+    static std::string toIdentifier(const std::string &name);
+
+    /**
+     * @brief C++ type of the converted argument of an option
+     * @param option the option
+     * @return "std::string", "int" or "bool"
+     */
+    static const char *valueTypeOf(const Option &option);
+
+private:
+    std::vector<OptionSymbol> symbols;
+
+    /**
+     * @brief Indices of the options by identifier and by getter suffix
+     */
+    std::unordered_map<std::string, std::size_t> argsNames;
+    std::unordered_map<std::string, std::size_t> capitalizedNames;
+
+    /**
+     * @brief Logs and collects an error
+     * @param message the error
+     */
+    void addError(const std::string &message);
+
+    std::vector<std::string> errors;
+};
+
+
+#endif //CODEGENERATOR_SYMBOLTABLE_H
@@ -0,0 +1,29 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_TASKPOOL_H
+#define CODEGENERATOR_TASKPOOL_H
+
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Runs independent tasks on a few threads
+ * Used to generate the fragments of a single spec in parallel. The tasks write
+ * into their own buffers, so the result does not depend on the order they run in.
+ */
+class TaskPool {
+public:
+    /**
+     * @brief Runs all tasks and waits for them
+     * The calling thread takes part, with threads <= 1 everything runs on it in order.
+     * @param tasks the tasks
+     * @param threads maximum number of threads
+     * @throws the exception of the first failed task, in task order
+     */
+    static void run(const std::vector<std::function<void()>> &tasks, unsigned int threads);
+};
+
+
+#endif //CODEGENERATOR_TASKPOOL_H
@@ -0,0 +1,143 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_TEMPLATE_H
+#define CODEGENERATOR_TEMPLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Supplies the values a Template is rendered with
+ * Names are passed as the index they have in the name table the template was compiled with.
+ */
+class TemplateContext {
+public:
+    virtual ~TemplateContext() = default;
+
+    /**
+     * @brief Writes the value of a {{name}} tag
+     * @param out the stream to write to
+     * @param name index of the name
+     */
+    virtual void writeValue(FILE *out, int name) = 0;
+
+    /**
+     * @brief Counts how often a {{#name}} section is rendered
+     * @param name index of the name
+     * @return 0 or 1 for conditions, the number of items for lists
+     */
+    virtual std::size_t getCount(int name) = 0;
+
+    /**
+     * @brief Selects the item of a {{#name}} section that is rendered next
+     * @param name index of the name
+     * @param item index of the item
+     */
+    virtual void selectItem(int name, std::size_t item) = 0;
+
+    /**
+     * @brief Writes the code behind a {{>name}} tag
+     * @param out the stream to write to
+     * @param name index of the name
+     */
+    virtual void writePartial(FILE *out, int name) = 0;
+};
+
+/**
+ * @brief Text template compiled into a list of instructions
+ * The syntax is a subset of Mustache: {{name}} inserts a value, {{#name}}...{{/name}}
+ * renders its content for every item of a list or once if a condition holds,
+ * {{^name}}...{{/name}} renders its content if the condition does not hold, {{>name}}
+ * inserts a block of generated code and {{!...}} is a comment. A line holding nothing
+ * but a single section, comment or partial tag does not appear in the output.
+ *
+ * Names are looked up once while compiling, rendering only walks the instructions.
+ */
+class Template {
+public:
+    /**
+     * @brief Compiles a template
+     * @param name name of the template, used in error messages
+     * @param text the template text
+     * @param names names the template may use, an empty entry can not be used
+     * @throws GeneratorException if the template is malformed or uses an unknown name
+     */
+    Template(const std::string &name, const std::string &text, const std::vector<std::string> &names);
+
+    /**
+     * @brief Renders the template
+     * @param out the stream to write to
+     * @param context supplies the values
+     */
+    void render(FILE *out, TemplateContext &context) const;
+
+    /**
+     * @brief Get the name of the template
+     * @return
+     */
+    const std::string &getName() const;
+
+private:
+    /**
+     * @brief Operation of an instruction
+     */
+    enum class Operation : uint8_t {
+        TEXT,
+        VALUE,
+        PARTIAL,
+        SECTION,
+        INVERTED,
+        END,
+        INVERTED_END
+    };
+
+    /**
+     * @brief A single instruction
+     */
+    struct Instruction {
+        Operation operation;
+        /**
+         * @brief Index of the name, unused for TEXT
+         */
+        int name;
+        /**
+         * @brief Offset of the text in literals for TEXT, the matching END for sections,
+         *        the matching section for END
+         */
+        std::size_t target;
+        /**
+         * @brief Length of the text for TEXT
+         */
+        std::size_t size;
+    };
+
+    /**
+     * @brief Name of the template
+     */
+    std::string name;
+
+    /**
+     * @brief The literal text of all TEXT instructions
+     */
+    std::string literals;
+
+    /**
+     * @brief The compiled template
+     */
+    std::vector<Instruction> instructions;
+
+    /**
+     * @brief Appends literal text, merged into the previous TEXT instruction if possible
+     * @param text start of the text
+     * @param size length of the text
+     */
+    void appendText(const char *text, std::size_t size);
+};
+
+
+#endif //CODEGENERATOR_TEMPLATE_H
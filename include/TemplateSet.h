@@ -0,0 +1,179 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_TEMPLATESET_H
+#define CODEGENERATOR_TEMPLATESET_H
+
+#include <string>
+#include <vector>
+#include "Template.h"
+
+/**
+ * @brief The compiled templates the SourceCodeWriter renders
+ * The default set reproduces the built-in output. A template directory can replace any
+ * of them with a file of the same name, the others keep their default. Each set is
+ * compiled once per process and shared by all threads.
+ */
+class TemplateSet {
+public:
+    /**
+     * @brief The templates of a set
+     * The file templates are rendered once per output file, the option templates once
+     * per option and make up the blocks the file templates insert with {{>name}}.
+     */
+    enum Kind {
+        HEADER_FILE,
+        SOURCE_FILE,
+        SHARD_FILE,
+        HELP_FILE,
+        FILE_TEMPLATE_COUNT,
+        STRUCT_ARGS_MEMBER = FILE_TEMPLATE_COUNT,
+        VALUE_MEMBER,
+        HEADER_GETTER,
+        EXTERNAL_FUNCTION,
+        SOURCE_GETTER,
+        HANDLING,
+        EXCLUSIONS,
+        LONG_OPTION,
+        CASE,
+        TEMPLATE_COUNT
+    };
+
+    /**
+     * @brief The names templates can use
+     * Names before OPTION_NAMES_BEGIN are available in file templates, names from
+     * SHARED_NAMES_BEGIN on in option templates.
+     */
+    enum Name {
+        // File templates
+        HEADER_GUARD,
+        SHORT_OPTS,
+        SHARDED,
+        SHARDS,
+        SHARD,
+        STRUCT_ARGS_CODE,
+        VALUES_CODE,
+        HEADER_GETTERS_CODE,
+        EXTERNAL_FUNCTIONS_CODE,
+        SOURCE_GETTERS_CODE,
+        HANDLING_CODE,
+        EXCLUSIONS_CODE,
+        LONG_OPTIONS_CODE,
+        CASES_CODE,
+        HELP_CODE,
+        MESSAGES,
+        MESSAGE,
+        CONVERSION_TYPES,
+        CONVERSION_TYPE,
+        USES_MISSING_ARGUMENT,
+        USES_UNEXPECTED_ARGUMENT,
+        USES_CONFLICTING_OPTIONS,
+        USES_BOOLEAN_VALUE,
+        // Both
+        SHARED_NAMES_BEGIN,
+        CLASS_NAME = SHARED_NAMES_BEGIN,
+        NAMESPACE,
+        HEADER_FILE_NAME,
+        FIRST,
+        // Option templates
+        OPTION_NAMES_BEGIN,
+        ARGS_NAME = OPTION_NAMES_BEGIN,
+        CAPITALIZED_NAME,
+        VALUE_TYPE,
+        OPTION_VALUE,
+        LONG_OPT,
+        ARGUMENT_KIND,
+        OPTION_FLAGS,
+        DEFAULT_VALUE,
+        INTERNAL_METHOD,
+        EXTERNAL_METHOD,
+        EXCLUDED,
+        EXCLUDED_NAME,
+        HAS_ARGUMENT,
+        REQUIRED_ARGUMENT,
+        OPTIONAL_ARGUMENT,
+        BOOLEAN,
+        HAS_DEFAULT,
+        HAS_GETTER,
+        HAS_VALUE_GETTER,
+        HAS_INTERNAL_METHOD,
+        HAS_EXTERNAL_METHOD,
+        HAS_LONG_OPT,
+        REACHABLE,
+        FLAGS_MESSAGE,
+        NAME_MESSAGE,
+        EXCLUDED_MESSAGE,
+        HANDLED,
+        CHECKED,
+        NAME_COUNT
+    };
+
+    /**
+     * @brief Get the templates of a directory, compiled on first use
+     * A directory must hold every template, as written by writeDefaults().
+     * @param dir the template directory, empty for the default set
+     * @return valid until the process ends
+     * @throws GeneratorException if the directory does not exist, a template is missing or
+     *         malformed, or a .tpl file is not one of the templates
+     */
+    static const TemplateSet &get(const std::string &dir);
+
+    /**
+     * @brief Makes the next get() of a directory compile its templates again, e.g. after they were edited
+     * Sets returned before stay valid.
+     * @param dir the template directory
+     */
+    static void reload(const std::string &dir);
+
+    /**
+     * @brief Writes the default set into a directory, as a starting point for own templates
+     * @param dir the directory, created if missing
+     * @throws GeneratorException if a file can not be written
+     */
+    static void writeDefaults(const std::string &dir);
+
+    /**
+     * @brief Get a template
+     * @param kind the template
+     * @return
+     */
+    const Template &getTemplate(Kind kind) const;
+
+    /**
+     * @brief Describes the templates that differ from the default set
+     * @return empty for the default set
+     */
+    const std::string &getFingerprint() const;
+
+    /**
+     * @brief Get the files the templates were read from
+     * @return paths of the templates taken from the directory
+     */
+    const std::vector<std::string> &getFiles() const;
+
+private:
+    /**
+     * @brief Loads and compiles the templates
+     * @param dir the template directory, empty for the default set
+     */
+    explicit TemplateSet(const std::string &dir);
+
+    /**
+     * @brief The compiled templates, indexed by Kind
+     */
+    std::vector<Template> templates;
+
+    /**
+     * @brief Hash of the templates taken from the directory
+     */
+    std::string fingerprint;
+
+    /**
+     * @brief Paths of the templates taken from the directory
+     */
+    std::vector<std::string> files;
+};
+
+
+#endif //CODEGENERATOR_TEMPLATESET_H
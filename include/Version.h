@@ -0,0 +1,14 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#ifndef CODEGENERATOR_VERSION_H
+#define CODEGENERATOR_VERSION_H
+
+/**
+ * @brief Version of the CodeGenerator
+ * Stored in the output manifest, generated files are regenerated when it changes.
+ */
+#define CODEGENERATOR_VERSION "1.5.0"
+
+#endif //CODEGENERATOR_VERSION_H
@@ -3,6 +3,8 @@
  */
 
 #include <xercesc/sax/HandlerBase.hpp>
+#include <xercesc/parsers/SAXParser.hpp>
+#include <xercesc/framework/MemoryManager.hpp>
 XERCES_CPP_NAMESPACE_USE
 
 #ifndef PROGRAMMING_C_XMLPARSER_H
@@ -12,57 +14,104 @@ XERCES_CPP_NAMESPACE_USE
 #include <string>
 #include <codecvt>
 #include <locale>
-#include "StateMachine.h"
-#include "models/GetOptSetup.h"
+#include "SpecParser.h"
 
 using namespace std;
 
 /**
  * @brief Class for the XMLParser
+ * Xerces SAX front end.
  */
-class XMLParser : public HandlerBase {
-private:
+class XMLParser : public SpecParser, public HandlerBase {
+public:
     /**
-     * @brief filename
-     * Name of the file to parse.
+     * @brief XMLParser
+     * Constructor.
+     * @param filename
      */
-    std::string filename;
+    explicit XMLParser(const string &filename);
 
     /**
-     * @brief stateMachine
-     * StateMachine to parse the file.
+     * @brief Initializes the Xerces platform.
+     * Only the first call initializes it, once per process, the later ones return at once.
+     * Safe to call from several threads. Must be called before parse(SAXParser &) is used.
      */
-    StateMachine *sm = new StateMachine();
+    static void initialize();
 
     /**
-     * @brief getOptSetup
-     * GetOptSetup to parse the file.
+     * @brief Terminates the Xerces platform.
+     * Only at the end of the process, all SAXParser instances must be deleted before and
+     * initialize() does not initialize it again.
      */
-    GetOptSetup *getOptSetup = new GetOptSetup();
-public:
+    static void terminate();
+
     /**
-     * @brief XMLParser
-     * Constructor.
-     * @param filename
+     * @brief The main parser function.
+     * Initializes Xerces if it is not yet and parses the file with a new SAXParser.
+     * With a memory limit the allocations of the SAXParser are charged to the memory budget of the spec.
      */
-    explicit XMLParser(const string &filename);
+    void parse() override;
 
     /**
-     * @brief The main parser function.
+     * @brief Parses the file with an existing SAXParser.
+     * Xerces must already be initialized, the parser can be reused for several files.
+     * Only the text and the model are charged to the memory budget, not the memory of the parser.
+     * @param parser SAXParser to use
+     * @throws GeneratorException if the file could not be parsed
      */
-    void parse();
+    void parse(SAXParser &parser);
 
+    void setDocumentLocator(const Locator *locator) override;
     void startDocument() override;
     void endDocument() override;
     void startElement(const XMLCh* name, AttributeList& attributes) override;
     void endElement(const XMLCh* name) override;
     void characters(const XMLCh* chars, XMLSize_t length) override;
 
+protected:
+    string getLocation() const override;
+
+private:
+    /**
+     * @brief Xerces MemoryManager charging the memory budget of the spec
+     * Allocates from the default MemoryManager and keeps the size in front of every block,
+     * so freed memory is returned at once and the budget applies to the memory in use.
+     */
+    class BudgetMemoryManager : public MemoryManager {
+    public:
+        explicit BudgetMemoryManager(SpecMemoryBudget &memoryBudget);
+        MemoryManager *getExceptionMemoryManager() override;
+        void *allocate(XMLSize_t size) override;
+        void deallocate(void *p) override;
+
+    private:
+        SpecMemoryBudget &memoryBudget;
+    };
+
+    /**
+     * @brief Transcodes the collected text and passes it to handleCharacters
+     */
+    void flushCharacters();
+
+    /**
+     * @brief UTF-16 chunks of the current text node, reused for every node
+     */
+    basic_string<XMLCh> pendingText;
+
+    /**
+     * @brief Bytes of pendingText charged to the memory budget so far
+     */
+    std::size_t chargedTextBytes = 0;
+
+    /**
+     * @brief Locator of the running parse, only valid during parse(SAXParser &)
+     */
+    const Locator *locator = nullptr;
+
     /**
-     * @brief getGetOptSetup
-     * @return getOptSetup
+     * @brief Memory manager for transcoded strings
      */
-    GetOptSetup *getGetOptSetup() const;
+    BudgetMemoryManager memoryManager{memoryBudget};
 };
 
 
@@ -6,8 +6,12 @@
 #define CODEGENERATOR_AUTHOR_H
 
 #include <string>
+#include <boost/utility/string_view.hpp>
 #include <xercesc/util/XercesDefs.hpp>
 #include <xercesc/sax/AttributeList.hpp>
+#include <xercesc/framework/MemoryManager.hpp>
+#include "BinaryStream.h"
+#include "SpecVocabulary.h"
 
 XERCES_CPP_NAMESPACE_USE
 using namespace std;
@@ -35,16 +39,36 @@ public:
     * @brief  Setter for the class
     */
     ///@{
-    void setName(const string &name);
-    void setPhone(const string &phone);
-    void setMail(const string &email);
+    void setName(boost::string_view name);
+    void setPhone(boost::string_view phone);
+    void setMail(boost::string_view email);
     ///@}
 
+    /**
+     * @brief Sets the attribute given by its resolved name, unknown attributes are ignored
+     * @param attribute attribute resolved by SpecVocabulary
+     * @param value value of the attribute
+     */
+    void setAttribute(SpecAttribute attribute, boost::string_view value);
+
     /**
      * @brief Function to parse the Author-Tag
      * @param attributes AttributeList of the Author-Tag
+     * @param memoryManager receives the transcoded values
+     */
+    void parseAttributes(AttributeList &attributes, MemoryManager *memoryManager);
+
+    /**
+     * @brief Writes the author to a binary stream
+     * @param writer BinaryWriter to append to
+     */
+    void serialize(BinaryWriter &writer) const;
+
+    /**
+     * @brief Reads the author from a binary stream written by serialize()
+     * @param reader BinaryReader to read from
      */
-    void parseAttributes(AttributeList &attributes);
+    void deserialize(BinaryReader &reader);
 
 private:
     /**
@@ -9,8 +9,12 @@
 #include "Author.h"
 #include "Option.h"
 #include <vector>
+#include <boost/utility/string_view.hpp>
 #include <xercesc/util/XercesDefs.hpp>
 #include <xercesc/sax/AttributeList.hpp>
+#include <xercesc/framework/MemoryManager.hpp>
+#include "BinaryStream.h"
+#include "SpecVocabulary.h"
 
 XERCES_CPP_NAMESPACE_USE
 
@@ -43,12 +47,12 @@ public:
     * @brief  Setter for the class
     */
     ///@{
-    void setSignPerLine(const string &signPerLine);
+    void setSignPerLine(boost::string_view signPerLine);
     void setAuthor(const Author &author);
-    void setHeaderFileName(const string &headerFileName);
-    void setSourceFileName(const string &sourceFileName);
-    void setNamespaceName(const string &namespaceName);
-    void setClassName(const string &className);
+    void setHeaderFileName(boost::string_view headerFileName);
+    void setSourceFileName(boost::string_view sourceFileName);
+    void setNamespaceName(boost::string_view namespaceName);
+    void setClassName(boost::string_view className);
     void setOverAllDescriptions(const vector<string> &overAllDescriptions);
     void setSampleUsages(const vector<string> &sampleUsages);
     void setOptions(const vector<Option> &options);
@@ -58,17 +62,38 @@ public:
     * @brief  Adder for the class
     */
     ///@{
-    void addOverAllDescription(const string &overAllDescription);
-    void addSampleUsage(const string &sampleUsage);
+    void addOverAllDescription(boost::string_view overAllDescription);
+    void addSampleUsage(boost::string_view sampleUsage);
     void addOption(const Option &option);
+    void addOption(Option &&option);
     ///@}
 
     // Helpers
     /**
      * @brief Function to check if the class is valid
      * @param attributes AttributeList of the GetOptSetup-Tag
+     * @param memoryManager receives the transcoded values
      */
-    void parseAttributes(AttributeList &attributes);
+    void parseAttributes(AttributeList &attributes, MemoryManager *memoryManager);
+
+    /**
+     * @brief Sets the attribute of the GetOptSetup-Tag given by its resolved name, unknown attributes are ignored
+     * @param attribute attribute resolved by SpecVocabulary
+     * @param value value of the attribute
+     */
+    void setAttribute(SpecAttribute attribute, boost::string_view value);
+
+    /**
+     * @brief Writes the whole setup including author and options to a binary stream
+     * @param writer BinaryWriter to append to
+     */
+    void serialize(BinaryWriter &writer) const;
+
+    /**
+     * @brief Reads the whole setup from a binary stream written by serialize()
+     * @param reader BinaryReader to read from
+     */
+    void deserialize(BinaryReader &reader);
 private:
     /**
      * @brief signPerLine
@@ -7,8 +7,12 @@
 
 #include <string>
 #include <vector>
+#include <boost/utility/string_view.hpp>
 #include <xercesc/util/XercesDefs.hpp>
 #include <xercesc/sax/AttributeList.hpp>
+#include <xercesc/framework/MemoryManager.hpp>
+#include "BinaryStream.h"
+#include "SpecVocabulary.h"
 
 XERCES_CPP_NAMESPACE_USE
 
@@ -46,37 +50,57 @@ public:
     char getShortOpt() const;
     const std::string &getLongOpt() const;
     const std::string &getDescription() const;
-    std::vector<int> getExclusions() const;
+    const std::vector<int> &getExclusions() const;
     const std::string &getConnectToInternalMethod() const;
     const std::string &getConnectToExternalMethod() const;
     HasArguments isHasArguments() const;
     ConvertToOptions getConvertTo() const;
-    std::string getDefaultValue() const;
-    std::string getInterface() const;
+    const std::string &getDefaultValue() const;
+    const std::string &getInterface() const;
     ///@}
 
     /** @name Setter
     * @brief  Setter for the class
     */
     ///@{
-    void setRef(const std::string &ref);
-    void setShortOpt(const std::string &shortOpt);
-    void setLongOpt(const std::string &longOpt);
-    void setDescription(const std::string &description);
-    void setExclusions(const std::string &exclusions);
-    void setConnectToInternalMethod(const std::string &connectToInternalMethod);
-    void setConnectToExternalMethod(const std::string &connectToExternalMethod);
-    void setHasArguments(const std::string &hasArguments);
-    void setConvertTo(const std::string &convertTo);
-    void setDefaultValue(const std::string &defaultValue);
-    void setInterface(const std::string &interface);
+    void setRef(boost::string_view ref);
+    void setShortOpt(boost::string_view shortOpt);
+    void setLongOpt(boost::string_view longOpt);
+    void setDescription(boost::string_view description);
+    void setExclusions(boost::string_view exclusions);
+    void setConnectToInternalMethod(boost::string_view connectToInternalMethod);
+    void setConnectToExternalMethod(boost::string_view connectToExternalMethod);
+    void setHasArguments(boost::string_view hasArguments);
+    void setConvertTo(boost::string_view convertTo);
+    void setDefaultValue(boost::string_view defaultValue);
+    void setInterface(boost::string_view interface);
     ///@}
 
     /**
      * @brief Function to parse the Option-Tag
      * @param attributes AttributeList of the Option-Tag
+     * @param memoryManager receives the transcoded values
      */
-    void parseAttributes(AttributeList &attributes);
+    void parseAttributes(AttributeList &attributes, MemoryManager *memoryManager);
+
+    /**
+     * @brief Sets the attribute of the Option-Tag given by its resolved name, unknown attributes are ignored
+     * @param attribute attribute resolved by SpecVocabulary
+     * @param value value of the attribute
+     */
+    void setAttribute(SpecAttribute attribute, boost::string_view value);
+
+    /**
+     * @brief Writes the option to a binary stream
+     * @param writer BinaryWriter to append to
+     */
+    void serialize(BinaryWriter &writer) const;
+
+    /**
+     * @brief Reads the option from a binary stream written by serialize()
+     * @param reader BinaryReader to read from
+     */
+    void deserialize(BinaryReader &reader);
 private:
     /**
      * @brief ref: Value between 0 and 63
@@ -0,0 +1,101 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "BinaryStream.h"
+#include "GeneratorException.h"
+
+// Writer
+void BinaryWriter::writeU8(uint8_t value) {
+    buffer.push_back((char) value);
+}
+
+void BinaryWriter::writeU32(uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        buffer.push_back((char) ((value >> (8 * i)) & 0xff));
+    }
+}
+
+void BinaryWriter::writeI32(int32_t value) {
+    writeU32((uint32_t) value);
+}
+
+void BinaryWriter::writeU64(uint64_t value) {
+    writeU32((uint32_t) (value & 0xffffffff));
+    writeU32((uint32_t) (value >> 32));
+}
+
+void BinaryWriter::writeString(const std::string &value) {
+    writeU32((uint32_t) value.size());
+    buffer.append(value);
+}
+
+void BinaryWriter::writeStrings(const std::vector<std::string> &values) {
+    writeU32((uint32_t) values.size());
+    for (auto &value: values) {
+        writeString(value);
+    }
+}
+
+const std::string &BinaryWriter::getBuffer() const {
+    return buffer;
+}
+
+// Reader
+BinaryReader::BinaryReader(const char *data, std::size_t size) : position(data), end(data + size) {
+}
+
+void BinaryReader::require(std::size_t size) const {
+    if ((std::size_t) (end - position) < size) {
+        throw GeneratorException("Unexpected end of binary data");
+    }
+}
+
+uint8_t BinaryReader::readU8() {
+    require(1);
+    return (uint8_t) *position++;
+}
+
+uint32_t BinaryReader::readU32() {
+    require(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t) (unsigned char) position[i] << (8 * i);
+    }
+    position += 4;
+    return value;
+}
+
+int32_t BinaryReader::readI32() {
+    return (int32_t) readU32();
+}
+
+uint64_t BinaryReader::readU64() {
+    uint64_t low = readU32();
+    uint64_t high = readU32();
+    return low | (high << 32);
+}
+
+std::string BinaryReader::readString() {
+    uint32_t size = readU32();
+    require(size);
+    std::string value(position, size);
+    position += size;
+    return value;
+}
+
+std::vector<std::string> BinaryReader::readStrings() {
+    uint32_t count = readU32();
+    std::vector<std::string> values;
+    // Every string needs at least its length, so a corrupt count cannot allocate unbounded memory
+    require((std::size_t) count * 4);
+    values.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        values.push_back(readString());
+    }
+    return values;
+}
+
+bool BinaryReader::atEnd() const {
+    return position == end;
+}
@@ -0,0 +1,113 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "ClassIR.h"
+#include <algorithm>
+
+/**
+ * @brief Checks whether an option can be passed on the command line
+ * @param option the option
+ * @return true if it has a ShortOpt or a LongOpt
+ */
+static bool isReachable(const Option &option) {
+    return option.getShortOpt() != '\0' || !option.getLongOpt().empty();
+}
+
+void ClassIR::addOptions(const std::vector<Option> &_options, const SymbolTable &symbols) {
+    // Options are added in their order, so every pass sees them in the same order
+    for (std::size_t i = options.size(); i < _options.size(); i++) {
+        OptionIR ir;
+        deduplicateMessages(_options[i], symbols.getSymbol(i), ir);
+        shareHelpers(_options[i], symbols.getSymbol(i));
+        eliminateDeadChecks(_options[i], ir);
+        options.push_back(ir);
+    }
+}
+
+void ClassIR::resolveExclusions(const std::vector<Option> &_options, const SymbolTable &symbols,
+                                const SemanticAnalyzer &analyzer) {
+    // Runs after every option is added, so the targets get their entries in a fixed order
+    for (std::size_t i = 0; i < options.size(); i++) {
+        options[i].checked = !_options[i].getExclusions().empty() && !analyzer.getExclusionTargets(i).empty();
+        if (!options[i].checked) {
+            continue;
+        }
+        helpers[CONFLICTING_OPTIONS] = true;
+        internName(i, symbols.getSymbol(i));
+        for (std::size_t target: analyzer.getExclusionTargets(i)) {
+            internName(target, symbols.getSymbol(target));
+        }
+    }
+}
+
+const ClassIR::OptionIR &ClassIR::getOption(std::size_t index) const {
+    return options[index];
+}
+
+const std::vector<std::string> &ClassIR::getMessages() const {
+    return messages;
+}
+
+const std::vector<std::string> &ClassIR::getConversionTypes() const {
+    return conversionTypes;
+}
+
+bool ClassIR::uses(Helper helper) const {
+    return helpers[helper];
+}
+
+std::string ClassIR::describeFlags(const Option &option) {
+    std::string flags;
+    if (option.getShortOpt() != '\0') {
+        flags.append(1, option.getShortOpt());
+        if (!option.getLongOpt().empty()) {
+            flags.append("/");
+        }
+    }
+    return flags.append(option.getLongOpt());
+}
+
+void ClassIR::deduplicateMessages(const Option &option, const OptionSymbol &symbol, OptionIR &ir) {
+    // The flags are only shown if a reachable option gets a missing or an unexpected argument
+    if (isReachable(option) && option.isHasArguments() != HasArguments::OPTIONAL) {
+        ir.flagsMessage = internMessage(describeFlags(option));
+    }
+    // The name is shown if the argument can not be converted, exclusions add theirs later
+    if (option.isHasArguments() != HasArguments::NONE) {
+        ir.nameMessage = internMessage(symbol.argsName);
+    }
+}
+
+void ClassIR::shareHelpers(const Option &option, const OptionSymbol &symbol) {
+    // Only reachable options have a case in parseOptions() that checks the argument
+    if (isReachable(option)) {
+        helpers[MISSING_ARGUMENT] = helpers[MISSING_ARGUMENT] || option.isHasArguments() == HasArguments::REQUIRED;
+        helpers[UNEXPECTED_ARGUMENT] = helpers[UNEXPECTED_ARGUMENT] || option.isHasArguments() == HasArguments::NONE;
+        helpers[BOOLEAN_VALUE] = helpers[BOOLEAN_VALUE] || (option.isHasArguments() != HasArguments::NONE
+                                                            && option.getConvertTo() == ConvertToOptions::BOOLEAN);
+    }
+    if (option.isHasArguments() != HasArguments::NONE
+        && std::find(conversionTypes.begin(), conversionTypes.end(), symbol.valueType) == conversionTypes.end()) {
+        conversionTypes.emplace_back(symbol.valueType);
+    }
+}
+
+void ClassIR::eliminateDeadChecks(const Option &option, OptionIR &ir) {
+    ir.handled = option.isHasArguments() != HasArguments::NONE || !option.getConnectToInternalMethod().empty()
+                 || !option.getConnectToExternalMethod().empty();
+}
+
+std::size_t ClassIR::internMessage(const std::string &message) {
+    auto inserted = messageIndex.emplace(message, messages.size());
+    if (inserted.second) {
+        messages.push_back(message);
+    }
+    return inserted.first->second;
+}
+
+void ClassIR::internName(std::size_t index, const OptionSymbol &symbol) {
+    if (options[index].nameMessage == NO_MESSAGE) {
+        options[index].nameMessage = internMessage(symbol.argsName);
+    }
+}
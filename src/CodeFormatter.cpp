@@ -0,0 +1,154 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "CodeFormatter.h"
+#include <cstring>
+
+/**
+ * @brief Checks whether a line starts with a keyword followed by a space or another character
+ * @param line the line without leading whitespace
+ * @param length length of the line
+ * @param keyword the keyword
+ * @param follow characters that may follow the keyword
+ * @return
+ */
+static bool startsWith(const char *line, std::size_t length, const char *keyword, const char *follow) {
+    std::size_t keywordLength = strlen(keyword);
+    return length > keywordLength && strncmp(line, keyword, keywordLength) == 0
+           && strchr(follow, line[keywordLength]) != nullptr;
+}
+
+/**
+ * @brief Finds the end of a block comment
+ * @param begin first character after the comment start
+ * @param end end of the line
+ * @return the character after the comment end or nullptr if the comment continues
+ */
+static const char *findCommentEnd(const char *begin, const char *end) {
+    for (const char *c = begin; c + 1 < end; c++) {
+        if (c[0] == '*' && c[1] == '/') {
+            return c + 2;
+        }
+    }
+    return nullptr;
+}
+
+std::string CodeFormatter::format(const char *data, std::size_t size) {
+    CodeFormatter formatter;
+    std::string out;
+    // Generated code is mostly short lines, a quarter more covers the indentation
+    out.reserve(size + size / 4);
+    const char *end = data + size;
+    for (const char *line = data; line < end;) {
+        auto *newline = (const char *) memchr(line, '\n', end - line);
+        const char *lineEnd = newline != nullptr ? newline : end;
+        formatter.formatLine(line, lineEnd - line, out);
+        if (newline == nullptr) {
+            break;
+        }
+        out.push_back('\n');
+        line = newline + 1;
+    }
+    return out;
+}
+
+void CodeFormatter::formatLine(const char *line, std::size_t length, std::string &out) {
+    while (length > 0 && strchr(" \t\r", line[length - 1]) != nullptr) {
+        length--;
+    }
+    if (inComment) {
+        // Comment lines are kept as they are
+        out.append(line, length);
+        inComment = findCommentEnd(line, line + length) == nullptr;
+        return;
+    }
+    std::size_t start = 0;
+    while (start < length && (line[start] == ' ' || line[start] == '\t')) {
+        start++;
+    }
+    line += start;
+    length -= start;
+    if (length == 0) {
+        return;
+    }
+    if (line[0] == '#') {
+        out.append(line, length);
+        return;
+    }
+
+    // Closing braces at the start of the line belong to the outer block
+    std::size_t position = 0;
+    while (position < length && (line[position] == '}' || line[position] == ' ')) {
+        if (line[position] == '}') {
+            close();
+        }
+        position++;
+    }
+    unsigned int level = depth;
+    if (level > 0 && !blocks.empty()) {
+        if (blocks.back() == Block::SWITCH
+            && (startsWith(line, length, "case", " '(") || startsWith(line, length, "default", ": "))) {
+            level--;
+        } else if (blocks.back() == Block::CLASS
+                   && (startsWith(line, length, "public", ": ") || startsWith(line, length, "protected", ": ")
+                       || startsWith(line, length, "private", ": "))) {
+            level--;
+        }
+    }
+    out.append(level * 4, ' ');
+    out.append(line, length);
+
+    Block block = Block::OTHER;
+    if (startsWith(line, length, "namespace", " {")) {
+        block = Block::NAMESPACE;
+    } else if (startsWith(line, length, "switch", " (")) {
+        block = Block::SWITCH;
+    } else if (startsWith(line, length, "class", " ") || startsWith(line, length, "struct", " {")) {
+        block = Block::CLASS;
+    }
+    // Braces in literals and comments do not count
+    char quote = 0;
+    for (; position < length; position++) {
+        char c = line[position];
+        if (quote != 0) {
+            if (c == '\\') {
+                position++;
+            } else if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '/' && position + 1 < length && line[position + 1] == '/') {
+            break;
+        } else if (c == '/' && position + 1 < length && line[position + 1] == '*') {
+            const char *commentEnd = findCommentEnd(line + position + 2, line + length);
+            if (commentEnd == nullptr) {
+                inComment = true;
+                break;
+            }
+            position = commentEnd - line - 1;
+        } else if (c == '{') {
+            open(block);
+        } else if (c == '}') {
+            close();
+        }
+    }
+}
+
+void CodeFormatter::open(Block block) {
+    blocks.push_back(block);
+    if (block != Block::NAMESPACE) {
+        depth++;
+    }
+}
+
+void CodeFormatter::close() {
+    if (blocks.empty()) {
+        return;
+    }
+    if (blocks.back() != Block::NAMESPACE) {
+        depth--;
+    }
+    blocks.pop_back();
+}
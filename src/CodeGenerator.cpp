@@ -2,94 +2,581 @@
  * Editors: Tobias Goetz, Noel Kempter
  */
 #include "CodeGenerator.h"
+#include "ContentHash.h"
+#include "GeneratorException.h"
+#include "OutputManifest.h"
 #include "XMLParser.h"
 #include "SourceCodeWriter.h"
+#include "SpecWatcher.h"
+#include "TemplateSet.h"
 #include "Logger.h"
-#include <getopt.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
 
-std::string CodeGenerator::getFilePath() {
-    return CodeGenerator::filePath;
+const int CodeGenerator::watchDebounceMs;
+
+const std::vector<std::string> &CodeGenerator::getFilePaths() const {
+    return filePaths;
+}
+
+const std::string &CodeGenerator::getManifestPath() const {
+    return manifestPath;
 }
 
 std::string CodeGenerator::getOutputDir() {
     return outputDir;
 }
 
-void CodeGenerator::setFilePath(const std::string &filename) {
-    CodeGenerator::filePath = filename;
+unsigned int CodeGenerator::getJobs() const {
+    return jobs;
+}
+
+const std::string &CodeGenerator::getCacheDir() const {
+    return specGenerator.getCacheDir();
+}
+
+bool CodeGenerator::isForce() const {
+    return force;
+}
+
+Frontend CodeGenerator::getFrontend() const {
+    return specGenerator.getFrontend();
+}
+
+bool CodeGenerator::isStrict() const {
+    return specGenerator.isStrict();
+}
+
+std::size_t CodeGenerator::getMaxMemory() const {
+    return specGenerator.getMaxMemory();
+}
+
+bool CodeGenerator::isPipeline() const {
+    return specGenerator.isPipeline();
+}
+
+unsigned int CodeGenerator::getEmitJobs() const {
+    return specGenerator.getEmitJobs();
+}
+
+unsigned int CodeGenerator::getShards() const {
+    return specGenerator.getShards();
+}
+
+const std::string &CodeGenerator::getAmalgamation() const {
+    return amalgamation;
+}
+
+const std::string &CodeGenerator::getTemplateDir() const {
+    return specGenerator.getTemplateDir();
+}
+
+const std::string &CodeGenerator::getDepfile() const {
+    return depfile;
+}
+
+OutputCache *CodeGenerator::getOutputCache() const {
+    return specGenerator.getOutputCache();
+}
+
+const std::vector<SpecResult> &CodeGenerator::getResults() const {
+    return results;
+}
+
+void CodeGenerator::addFilePath(const std::string &filename) {
+    filePaths.push_back(filename);
+}
+
+void CodeGenerator::setManifestPath(const std::string &filename) {
+    manifestPath = filename;
 }
 
 void CodeGenerator::setOutputDir(const std::string &dir) {
     outputDir = dir;
 }
 
-void CodeGenerator::run() {
+void CodeGenerator::setJobs(unsigned int _jobs) {
+    jobs = _jobs;
+}
+
+void CodeGenerator::setCacheDir(const std::string &dir) {
+    specGenerator.setCacheDir(dir);
+}
+
+void CodeGenerator::setForce(bool _force) {
+    force = _force;
+}
+
+void CodeGenerator::setFrontend(Frontend frontend) {
+    specGenerator.setFrontend(frontend);
+}
+
+void CodeGenerator::setStrict(bool strict) {
+    specGenerator.setStrict(strict);
+}
+
+void CodeGenerator::setMaxMemory(std::size_t bytes) {
+    specGenerator.setMaxMemory(bytes);
+}
+
+void CodeGenerator::setPipeline(bool pipeline) {
+    specGenerator.setPipeline(pipeline);
+}
+
+void CodeGenerator::setEmitJobs(unsigned int jobs) {
+    specGenerator.setEmitJobs(jobs);
+}
+
+void CodeGenerator::setShards(unsigned int shards) {
+    specGenerator.setShards(shards);
+}
+
+void CodeGenerator::setAmalgamation(const std::string &filename) {
+    amalgamation = filename;
+}
+
+void CodeGenerator::setTemplateDir(const std::string &dir) {
+    specGenerator.setTemplateDir(dir);
+}
+
+void CodeGenerator::setDepfile(const std::string &path) {
+    depfile = path;
+}
+
+void CodeGenerator::setOutputCache(const std::string &dir, std::size_t maxBytes) {
+    specGenerator.setOutputCache(dir, maxBytes);
+}
+
+std::vector<std::string> CodeGenerator::collectSpecs() const {
+    std::vector<std::string> inputs = getFilePaths();
+
+    if (!getManifestPath().empty()) {
+        std::ifstream manifest(getManifestPath());
+        if (!manifest.is_open()) {
+            LOG_ERROR("Unable to open manifest file: " + getManifestPath());
+            throw GeneratorException("Unable to open manifest file " + getManifestPath());
+        }
+        // Relative entries are resolved against the directory of the manifest
+        boost::filesystem::path manifestDir = boost::filesystem::path(getManifestPath()).parent_path();
+        std::string line;
+        while (std::getline(manifest, line)) {
+            boost::algorithm::trim(line);
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            boost::filesystem::path entry(line);
+            inputs.push_back(entry.is_absolute() ? line : (manifestDir / entry).string());
+        }
+    }
+
+    std::vector<std::string> specs;
+    for (auto &input: inputs) {
+        if (!boost::filesystem::is_directory(input)) {
+            specs.push_back(input);
+            continue;
+        }
+        // Every *.xml directly inside the directory is a spec, sorted for a stable order
+        std::vector<std::string> directorySpecs;
+        for (auto &entry: boost::filesystem::directory_iterator(input)) {
+            if (boost::filesystem::is_regular_file(entry.path()) && entry.path().extension() == ".xml") {
+                directorySpecs.push_back(entry.path().string());
+            }
+        }
+        std::sort(directorySpecs.begin(), directorySpecs.end());
+        specs.insert(specs.end(), directorySpecs.begin(), directorySpecs.end());
+    }
+
+    // A spec listed twice must not be written by two workers at the same time
+    std::vector<std::string> uniqueSpecs;
+    std::set<std::string> seen;
+    for (auto &spec: specs) {
+        if (seen.insert(boost::filesystem::absolute(spec).lexically_normal().string()).second) {
+            uniqueSpecs.push_back(spec);
+        }
+    }
+    return uniqueSpecs;
+}
+
+void CodeGenerator::checkOutputPaths(OutputManifest &manifest, const std::vector<std::string> &otherSpecs) {
+    // Specs writing the same file overwrite each other, the one generated last wins
+    std::map<std::string, std::string> writers;
+    std::map<std::string, std::string> collisions;
+    auto claim = [&](const std::string &spec, const std::string &output) {
+        std::string path = boost::filesystem::absolute(output).lexically_normal().string();
+        auto writer = writers.emplace(path, spec);
+        if (!writer.second && writer.first->second != spec) {
+            std::string message = "Specs " + writer.first->second + " and " + spec + " both write " + path;
+            LOG_ERROR(message);
+            collisions.emplace(writer.first->second, message);
+            collisions.emplace(spec, message);
+        }
+    };
+
+    std::set<std::string> batch;
+    for (auto &result: results) {
+        batch.insert(result.filePath);
+        if (result.success) {
+            for (auto &output: result.outputs) {
+                claim(result.filePath, output);
+            }
+        }
+    }
+    // Specs that were not regenerated still own the outputs the manifest recorded for them
+    for (auto &spec: otherSpecs) {
+        if (batch.count(spec) == 0) {
+            for (auto &output: manifest.getOutputs(spec)) {
+                claim(spec, output);
+            }
+        }
+    }
+
+    for (auto &result: results) {
+        auto collision = collisions.find(result.filePath);
+        if (result.success && collision != collisions.end()) {
+            result.success = false;
+            result.skipped = false;
+            result.message = collision->second;
+            // Without an entry the next run generates the spec again and reports the collision again
+            manifest.forget(result.filePath);
+        }
+    }
+}
+
+/**
+ * @brief Escapes a path for a Make rule
+ * @param path the path
+ * @return absolute path with spaces, '#' and '$' escaped
+ */
+static std::string escapeMakePath(const std::string &path) {
+    boost::filesystem::path normalPath = boost::filesystem::absolute(path).lexically_normal();
+    // A directory given with a trailing slash ends in "."
+    if (normalPath.filename() == ".") {
+        normalPath = normalPath.parent_path();
+    }
+    std::string absolutePath = normalPath.string();
+    std::string escaped;
+    for (char c: absolutePath) {
+        if (c == ' ' || c == '#') {
+            escaped += '\\';
+        } else if (c == '$') {
+            escaped += '$';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void CodeGenerator::writeDepfile() const {
+    // Specs may write the same file, a target must not be listed twice
+    std::vector<std::string> targets;
+    std::set<std::string> seen;
+    for (auto &result: results) {
+        for (auto &output: result.outputs) {
+            if (seen.insert(output).second) {
+                targets.push_back(output);
+            }
+        }
+    }
+    if (!getAmalgamation().empty()) {
+        targets.push_back(outputDir + getAmalgamation());
+    }
+    // Written on every run, so a build system can use it to tell when the generator last ran,
+    // while outputs that did not change keep their time
+    targets.push_back(getDepfile());
+
+    // A directory is a prerequisite as well, adding a spec or template to it changes its time
+    std::vector<std::string> prerequisites;
+    for (auto &result: results) {
+        prerequisites.push_back(result.filePath);
+    }
+    for (auto &input: getFilePaths()) {
+        if (boost::filesystem::is_directory(input)) {
+            prerequisites.push_back(input);
+        }
+    }
+    if (!getManifestPath().empty()) {
+        prerequisites.push_back(getManifestPath());
+    }
+    if (!getTemplateDir().empty()) {
+        const std::vector<std::string> &templateFiles = TemplateSet::get(getTemplateDir()).getFiles();
+        prerequisites.push_back(getTemplateDir());
+        prerequisites.insert(prerequisites.end(), templateFiles.begin(), templateFiles.end());
+    }
+
+    std::string tempPath = getDepfile() + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_ERROR("Unable to write depfile " + tempPath);
+            throw GeneratorException("Unable to write depfile " + tempPath);
+        }
+        for (std::size_t i = 0; i < targets.size(); i++) {
+            file << (i > 0 ? " " : "") << escapeMakePath(targets[i]);
+        }
+        file << ":";
+        for (auto &prerequisite: prerequisites) {
+            file << " \\\n  " << escapeMakePath(prerequisite);
+        }
+        file << "\n";
+    }
+    if (rename(tempPath.c_str(), getDepfile().c_str()) != 0) {
+        remove(tempPath.c_str());
+        LOG_ERROR("Unable to replace depfile " + getDepfile());
+        throw GeneratorException("Unable to replace depfile " + getDepfile());
+    }
+    LOG_INFO("Wrote depfile " + getDepfile());
+}
+
+std::size_t CodeGenerator::run() {
     LOG_INFO("Starting CodeGenerator");
-    if(getFilePath().empty()){
+    if (getFilePaths().empty() && getManifestPath().empty()) {
         perror("The path to the XML-File must be set.");
         LOG_ERROR("The path to the XML-File must be set.");
         exit(EXIT_FAILURE);
     }
 
-    LOG_INFO("Starting XMLParser");
-    XMLParser parser(getFilePath());
-    parser.parse();
-    LOG_INFO("Finished XMLParser");
+    std::vector<std::string> specs;
+    try {
+        specs = collectSpecs();
+        // Compiles the templates once, before any worker needs them
+        TemplateSet::get(getTemplateDir());
+    } catch (const std::exception &e) {
+        perror(e.what());
+        exit(EXIT_FAILURE);
+    }
+    std::size_t failed = generate(specs);
 
-    LOG_INFO("Starting SourceCodeWriter");
-    SourceCodeWriter writer = SourceCodeWriter(parser.getGetOptSetup());
-    writer.setOutputDir(getOutputDir());
-    writer.writeFile();
-    LOG_INFO("Finished SourceCodeWriter");
+    // After a failed run the build fails anyway, and the outputs are incomplete
+    if (!getDepfile().empty() && failed == 0) {
+        try {
+            writeDepfile();
+        } catch (const std::exception &e) {
+            fprintf(stderr, "FAILED %s: %s\n", getDepfile().c_str(), e.what());
+            failed++;
+        }
+    }
+    return failed;
+}
 
-    LOG_INFO("Codegenerator finished!");
+/**
+ * @brief Reads a spec into memory
+ * @param path path to the spec
+ * @param content receives the content
+ * @param entry receives the size and hash of the content and the mtime of the spec before it was read
+ * @throws GeneratorException if the spec can not be read
+ */
+static void readSpec(const std::string &path, std::string &content, OutputManifest::Entry &entry) {
+    std::ifstream in(path, std::ios::binary);
+    if (!OutputManifest::statFile(path, entry) || !in) {
+        LOG_ERROR("Could not read file " + path);
+        throw GeneratorException("Could not read " + path);
+    }
+    std::ostringstream stream;
+    stream << in.rdbuf();
+    content = stream.str();
+    entry.size = content.size();
+    entry.hash = ContentHash::ofBytes(content.data(), content.size());
 }
 
+std::size_t CodeGenerator::generate(const std::vector<std::string> &specs, const std::vector<std::string> &otherSpecs) {
+    results.assign(specs.size(), SpecResult());
+    unsigned int workerCount = getJobs() == 0 ? std::thread::hardware_concurrency() : getJobs();
+    workerCount = std::max(1u, std::min<unsigned int>(workerCount, (unsigned int) specs.size()));
+    LOG_INFO("Generating " + to_string(specs.size()) + " specs with " + to_string(workerCount) + " workers");
 
-int main(int argc, char **argv) {
-    Logger::initFromConfig("logconfig.ini");
+    OutputManifest manifest(getOutputDir() + "codegen.manifest");
+    manifest.load();
+    std::string fingerprint = specGenerator.getFingerprint();
 
-    CodeGenerator generator;
-    int c;
-    int option_index;
-    static struct option long_options[] = {
-            {"path", required_argument, 0, 'p'},
-            {"output", required_argument, 0, 'o'},
-            {0, 0, 0, 0}
+    // Xerces is initialized by the first worker that has to parse a spec and stays initialized
+    // for later runs. Every worker keeps its own SAXParser.
+    std::atomic<std::size_t> nextSpec{0};
+    auto worker = [&]() {
+        std::unique_ptr<SAXParser> saxParser;
+        for (std::size_t i = nextSpec++; i < specs.size(); i = nextSpec++) {
+            SpecResult &result = results[i];
+            result.filePath = specs[i];
+            try {
+                if (!isForce() && manifest.isUpToDate(specs[i], fingerprint)) {
+                    LOG_INFO("Skipping up-to-date spec " + specs[i]);
+                    result.success = true;
+                    result.skipped = true;
+                    result.outputs = manifest.getOutputs(specs[i]);
+                    continue;
+                }
+                auto acquireParser = [&]() -> SAXParser & {
+                    if (!saxParser) {
+                        XMLParser::initialize();
+                        saxParser.reset(new SAXParser);
+                    }
+                    return *saxParser;
+                };
+                // The manifest records the content that was parsed, not the one found afterwards
+                std::string content;
+                OutputManifest::Entry parsed;
+                readSpec(specs[i], content, parsed);
+                specGenerator.generateFile(specs[i], content.data(), content.size(), getOutputDir(), acquireParser,
+                                           result);
+                manifest.update(specs[i], fingerprint, parsed, result.outputs);
+                result.success = true;
+            } catch (const std::exception &e) {
+                LOG_ERROR("Generating " + specs[i] + " failed: " + e.what());
+                result.message = e.what();
+            }
+        }
     };
 
-    while((c = getopt_long(argc, argv, "p:o:", long_options, &option_index)) != -1 ){
-        switch(c){
-            case 'p':
-                if (optarg == nullptr){
-                    perror("The path to the XML-File to be parsed was not set.");
-                    LOG_ERROR("The path to the XML-File to be parsed was not set.");
-                    exit(EXIT_FAILURE);
-                }
-                generator.setFilePath(optarg);
-                break;
-            case 'o':
-                if(optarg == nullptr){
-                    perror("When using \"-o/--output\" the path to the target directory must be set.");
-                    LOG_ERROR("When using \"-o/--output\" the path to the target directory must be set.");
-                    exit(EXIT_FAILURE);
-                }
-                    generator.setOutputDir(optarg);
-                break;
-            case '?':
-            default:
-                perror("GetOpt encountered an unknown option.");
-                LOG_ERROR("GetOpt encountered an unknown option.");
-                exit(EXIT_FAILURE);
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < workerCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread: workers) {
+        thread.join();
+    }
+
+    checkOutputPaths(manifest, otherSpecs);
+    manifest.save();
+
+    std::size_t failed = 0;
+    std::size_t skipped = 0;
+    for (auto &result: results) {
+        if (result.skipped) {
+            skipped++;
         }
+        if (!result.success) {
+            failed++;
+            fprintf(stderr, "FAILED %s: %s\n", result.filePath.c_str(), result.message.c_str());
+        } else if (results.size() > 1) {
+            printf("%s %s\n", result.skipped ? "UP-TO-DATE" : "OK        ", result.filePath.c_str());
+        }
+    }
+    if (results.size() > 1) {
+        printf("%zu of %zu specs generated (%zu up to date), %zu failed\n", results.size() - failed,
+               results.size(), skipped, failed);
+    }
+
+    // Needs the outputs of every spec, a failed spec would leave a hole in it
+    if (!getAmalgamation().empty() && failed > 0) {
+        LOG_ERROR("Not writing " + getAmalgamation() + ", " + to_string(failed) + " specs failed");
+        fprintf(stderr, "FAILED %s: not written, %zu specs failed\n", getAmalgamation().c_str(), failed);
+    } else if (!getAmalgamation().empty()) {
+        try {
+            std::vector<std::vector<std::string>> outputs;
+            for (auto &result: results) {
+                outputs.push_back(result.outputs);
+            }
+            SourceCodeWriter::writeAmalgamation(getOutputDir() + getAmalgamation(), outputs);
+        } catch (const std::exception &e) {
+            LOG_ERROR(std::string("Amalgamation failed: ") + e.what());
+            fprintf(stderr, "FAILED %s: %s\n", getAmalgamation().c_str(), e.what());
+            failed++;
+        }
+    }
+
+    if (getOutputCache() != nullptr) {
+        getOutputCache()->evict();
+        LOG_INFO(getOutputCache()->describe());
+        printf("%s\n", getOutputCache()->describe().c_str());
     }
-    if (optind < argc) {
-        printf("non-option ARGV-elements: ");
-        while (optind < argc)
-            printf("%s ", argv[optind++]);
-        printf("\n");
+
+    LOG_INFO("Codegenerator finished!");
+    return failed;
+}
+
+void CodeGenerator::watch() {
+    // Xerces stays initialized between the runs
+    run();
+
+    SpecWatcher watcher;
+    std::string manifestKey;
+    if (!getManifestPath().empty()) {
+        manifestKey = boost::filesystem::absolute(getManifestPath()).lexically_normal().string();
+    }
+    std::string templateDir;
+    if (!getTemplateDir().empty()) {
+        templateDir = boost::filesystem::absolute(getTemplateDir()).lexically_normal().string();
     }
+    std::vector<std::string> specs = collectSpecs();
+    printf("Watching %zu specs\n", specs.size());
+    fflush(stdout);
+    while (true) {
+        // New specs in a watched directory or manifest are picked up, so the watches follow the list
+        for (auto &input: getFilePaths()) {
+            if (boost::filesystem::is_directory(input)) {
+                watcher.watchDirectory(input);
+            }
+        }
+        if (!manifestKey.empty()) {
+            watcher.watchDirectory(boost::filesystem::path(manifestKey).parent_path().string());
+        }
+        if (!templateDir.empty()) {
+            watcher.watchDirectory(templateDir);
+        }
+        for (auto &spec: specs) {
+            watcher.watchDirectory(boost::filesystem::absolute(spec).parent_path().string());
+        }
+
+        std::set<std::string> changed = watcher.waitForChanges(std::chrono::milliseconds(watchDebounceMs));
+        auto start = std::chrono::steady_clock::now();
+        // Edited templates change the fingerprint, so the manifest regenerates every spec
+        bool templatesChanged = !templateDir.empty() && std::any_of(
+                changed.begin(), changed.end(), [&templateDir](const std::string &path) {
+                    return path.empty() || boost::filesystem::path(path).parent_path().string() == templateDir;
+                });
+        if (templatesChanged) {
+            TemplateSet::reload(getTemplateDir());
+        }
+        try {
+            specs = collectSpecs();
+            TemplateSet::get(getTemplateDir());
+        } catch (const std::exception &e) {
+            fprintf(stderr, "FAILED %s\n", e.what());
+            fflush(stderr);
+            continue;
+        }
 
-    generator.run();
-    return 0;
+        // The amalgamation and the depfile need the outputs of all specs, the manifest skips the unchanged ones
+        bool checkAll = !getAmalgamation().empty() || !getDepfile().empty() || templatesChanged
+                        || changed.count("") > 0 || changed.count(manifestKey) > 0;
+        std::vector<std::string> batch;
+        for (auto &spec: specs) {
+            if (checkAll || changed.count(boost::filesystem::absolute(spec).lexically_normal().string()) > 0) {
+                batch.push_back(spec);
+            }
+        }
+        if (batch.empty()) {
+            continue;
+        }
+        LOG_INFO("Regenerating " + to_string(batch.size()) + " changed specs");
+        std::size_t failed = generate(batch, specs);
+        if (!getDepfile().empty() && failed == 0) {
+            try {
+                writeDepfile();
+            } catch (const std::exception &e) {
+                fprintf(stderr, "FAILED %s: %s\n", getDepfile().c_str(), e.what());
+                failed++;
+            }
+        }
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+        // Saving a spec without changing it leaves it up to date, failed also counts the amalgamation and depfile
+        std::size_t skipped = std::count_if(results.begin(), results.end(),
+                                            [](const SpecResult &result) { return result.skipped; });
+        std::size_t regenerated = std::count_if(results.begin(), results.end(), [](const SpecResult &result) {
+            return result.success && !result.skipped;
+        });
+        printf("%zu written specs checked in %.2f ms: %zu regenerated, %zu up to date, %zu failed\n", batch.size(),
+               milliseconds, regenerated, skipped, failed);
+        fflush(stdout);
+    }
 }
@@ -0,0 +1,59 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "ContentHash.h"
+#include <cstdio>
+#include <fstream>
+
+uint64_t ContentHash::ofBytes(const char *data, std::size_t size, uint64_t seed) {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= prime;
+    }
+    return hash;
+}
+
+uint64_t ContentHash::ofString(const std::string &data, uint64_t seed) {
+    return ofBytes(data.data(), data.size(), seed);
+}
+
+bool ContentHash::ofFile(const std::string &path, uint64_t &hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    char buffer[65536];
+    hash = offsetBasis;
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        hash = ofBytes(buffer, (std::size_t) file.gcount(), hash);
+    }
+    return !file.bad();
+}
+
+std::string ContentHash::toHex(uint64_t hash) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) hash);
+    return hex;
+}
+
+bool ContentHash::fromHex(const std::string &hex, uint64_t &hash) {
+    if (hex.size() != 16) {
+        return false;
+    }
+    hash = 0;
+    for (char c: hex) {
+        hash <<= 4;
+        if (c >= '0' && c <= '9') {
+            hash |= (uint64_t) (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            hash |= (uint64_t) (c - 'a' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
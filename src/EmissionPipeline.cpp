@@ -0,0 +1,83 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "EmissionPipeline.h"
+#include "Logger.h"
+
+EmissionPipeline::EmissionPipeline(GetOptSetup &getOptSetup, SourceCodeWriter &writer)
+        : getOptSetup(getOptSetup), writer(writer) {
+    consumer = std::thread(&EmissionPipeline::consume, this);
+}
+
+EmissionPipeline::~EmissionPipeline() {
+    stop();
+}
+
+void EmissionPipeline::push(Option &&option) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error) {
+        // Stops the parser, the spec fails anyway
+        std::rethrow_exception(error);
+    }
+    if (queue.empty()) {
+        if (className.empty()) {
+            className = getOptSetup.getClassName();
+        }
+        available.notify_one();
+    }
+    queue.push_back(std::move(option));
+}
+
+void EmissionPipeline::finish() {
+    stop();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    for (Option &option: options) {
+        getOptSetup.addOption(std::move(option));
+    }
+    LOG_DEBUG("Pipeline emitted " + std::to_string(options.size()) + " options");
+    options.clear();
+}
+
+void EmissionPipeline::consume() {
+    std::vector<Option> batch;
+    std::string batchClassName;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return done || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            // Taking the whole queue keeps the lock out of the per option work
+            batch.swap(queue);
+            batchClassName = className;
+        }
+        try {
+            for (Option &option: batch) {
+                options.push_back(std::move(option));
+            }
+            batch.clear();
+            writer.emitOptions(batchClassName, options);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            LOG_ERROR("Emitting options failed, stopping the pipeline");
+            error = std::current_exception();
+            queue.clear();
+            return;
+        }
+    }
+}
+
+void EmissionPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    available.notify_one();
+    if (consumer.joinable()) {
+        consumer.join();
+    }
+}
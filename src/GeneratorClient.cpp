@@ -0,0 +1,82 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "GeneratorClient.h"
+#include "BinaryStream.h"
+#include "ServerProtocol.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+GeneratorClient::GeneratorClient(const std::string &socketPath) : socketPath(socketPath) {
+}
+
+int GeneratorClient::connectToServer() const {
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connection >= 0 && connect(connection, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+bool GeneratorClient::run(int argc, char **argv, int &status) const {
+    int connection = connectToServer();
+    if (connection < 0) {
+        return false;
+    }
+
+    // Relative paths on the command line are resolved by the server in the same directory
+    char workingDir[PATH_MAX];
+    if (getcwd(workingDir, sizeof(workingDir)) == nullptr) {
+        close(connection);
+        return false;
+    }
+    BinaryWriter payload;
+    payload.writeString(workingDir);
+    payload.writeStrings(std::vector<std::string>(argv + 1, argv + argc));
+
+    char answer[4];
+    if (!ServerProtocol::sendRequest(connection, ServerProtocol::RUN, payload.getBuffer(),
+                                     {STDOUT_FILENO, STDERR_FILENO})
+        || !ServerProtocol::readFully(connection, answer, sizeof(answer))) {
+        fprintf(stderr, "Lost the connection to the generator server at %s.\n", socketPath.c_str());
+        status = EXIT_FAILURE;
+    } else {
+        status = BinaryReader(answer, sizeof(answer)).readI32();
+    }
+    close(connection);
+    return true;
+}
+
+bool GeneratorClient::printStats() const {
+    int connection = connectToServer();
+    if (connection < 0) {
+        return false;
+    }
+    char header[4];
+    std::string text;
+    bool answered = ServerProtocol::sendRequest(connection, ServerProtocol::STATS, "", {})
+                    && ServerProtocol::readFully(connection, header, sizeof(header));
+    if (answered) {
+        text.resize(BinaryReader(header, sizeof(header)).readU32());
+        answered = ServerProtocol::readFully(connection, &text[0], text.size());
+    }
+    close(connection);
+    if (answered) {
+        printf("%s\n", text.c_str());
+    }
+    return answered;
+}
@@ -0,0 +1,273 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "GeneratorServer.h"
+#include "BinaryStream.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include "ServerProtocol.h"
+#include "TemplateSet.h"
+#include "XMLParser.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Pipe the signal handler writes to, so the poll loop wakes up for signals
+ */
+static int signalPipe[2] = {-1, -1};
+
+/**
+ * @brief Forwards a signal to the poll loop
+ * @param signal the signal
+ */
+static void forwardSignal(int signal) {
+    int savedErrno = errno;
+    char byte = (char) signal;
+    ssize_t ignored = write(signalPipe[1], &byte, 1);
+    (void) ignored;
+    errno = savedErrno;
+}
+
+GeneratorServer::GeneratorServer(const std::string &socketPath) : socketPath(socketPath) {
+}
+
+int GeneratorServer::serve(const CommandLine &commandLine) {
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Socket path " + socketPath + " is too long");
+        throw GeneratorException("Socket path " + socketPath + " is too long");
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // Everything a request would otherwise initialize first is done once here
+    XMLParser::initialize();
+    TemplateSet::get("");
+
+    // Only the socket of a server that is gone is replaced, never another file or a live socket
+    struct stat existing = {};
+    if (lstat(socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            LOG_ERROR("Not serving on " + socketPath + ", it exists and is not a socket");
+            throw GeneratorException("Not serving on " + socketPath + ", it exists and is not a socket");
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool listening = probe >= 0 && connect(probe, (struct sockaddr *) &address, sizeof(address)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (listening) {
+            LOG_ERROR("Not serving on " + socketPath + ", a server is already listening");
+            throw GeneratorException("Not serving on " + socketPath + ", a server is already listening");
+        }
+        unlink(socketPath.c_str());
+    }
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0
+        || listen(listener, SOMAXCONN) != 0 || pipe2(signalPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        std::string message = "Could not listen on " + socketPath + ": " + strerror(errno);
+        LOG_ERROR(message);
+        throw GeneratorException(message);
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = forwardSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    for (int signal: {SIGCHLD, SIGINT, SIGTERM}) {
+        sigaction(signal, &action, nullptr);
+    }
+    LOG_INFO("Serving on " + socketPath);
+    printf("Serving on %s\n", socketPath.c_str());
+    fflush(stdout);
+
+    bool stopping = false;
+    while (!stopping) {
+        struct pollfd fds[2] = {{listener, POLLIN, 0}, {signalPipe[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            char signals[64];
+            ssize_t count = read(signalPipe[0], signals, sizeof(signals));
+            for (ssize_t i = 0; i < count; i++) {
+                stopping = stopping || signals[i] == SIGINT || signals[i] == SIGTERM;
+            }
+            reapChildren();
+        }
+        if (!stopping && (fds[0].revents & POLLIN)) {
+            int connection = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (connection >= 0) {
+                handleConnection(connection, commandLine);
+            }
+        }
+    }
+
+    // Requests that are already running still get their answer
+    close(listener);
+    unlink(socketPath.c_str());
+    while (!pendingRuns.empty()) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == ECHILD) {
+                break;
+            }
+            continue;
+        }
+        // The child is reaped here, reapChildren() would not see it any more
+        finishRun(pid, status);
+    }
+    LOG_INFO("Server stopped after " + describeLatencies());
+    printf("%s\n", describeLatencies().c_str());
+    XMLParser::terminate();
+    return EXIT_SUCCESS;
+}
+
+void GeneratorServer::handleConnection(int connection, const CommandLine &commandLine) {
+    auto start = std::chrono::steady_clock::now();
+    // A client that stops sending in the middle of a request must not block the server
+    struct timeval timeout = {5, 0};
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    uint32_t kind = 0;
+    std::string payload;
+    std::vector<int> fds;
+    bool received = ServerProtocol::receiveRequest(connection, kind, payload, fds);
+    if (received && kind == ServerProtocol::RUN && fds.size() == 2) {
+        startRun(connection, payload, fds, commandLine, start);
+    } else if (received && kind == ServerProtocol::STATS) {
+        BinaryWriter answer;
+        answer.writeString(describeLatencies());
+        ServerProtocol::writeFully(connection, answer.getBuffer().data(), answer.getBuffer().size());
+        close(connection);
+    } else {
+        LOG_WARN("Ignoring malformed request");
+        close(connection);
+    }
+    for (int fd: fds) {
+        close(fd);
+    }
+}
+
+void GeneratorServer::startRun(int connection, const std::string &payload, const std::vector<int> &fds,
+                               const CommandLine &commandLine, std::chrono::steady_clock::time_point start) {
+    std::string workingDir;
+    std::vector<std::string> arguments;
+    try {
+        BinaryReader reader(payload.data(), payload.size());
+        workingDir = reader.readString();
+        arguments = reader.readStrings();
+    } catch (const GeneratorException &) {
+        LOG_WARN("Ignoring malformed request");
+        close(connection);
+        return;
+    }
+
+    // Output buffered so far would otherwise be written by the child as well
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (int signal: {SIGCHLD, SIGINT, SIGTERM}) {
+            ::signal(signal, SIG_DFL);
+        }
+        close(listener);
+        close(signalPipe[0]);
+        close(signalPipe[1]);
+        close(connection);
+        for (auto &run: pendingRuns) {
+            close(run.second.connection);
+        }
+        dup2(fds[0], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        if (chdir(workingDir.c_str()) != 0) {
+            perror("Could not change to the working directory of the client.");
+            _exit(EXIT_FAILURE);
+        }
+
+        std::vector<char *> argv;
+        std::string program = "CodeGenerator";
+        argv.push_back(&program[0]);
+        for (auto &argument: arguments) {
+            argv.push_back(&argument[0]);
+        }
+        argv.push_back(nullptr);
+        // getopt_long has already been used in this process, 0 makes it start over
+        optind = 0;
+        errno = 0;
+        exit(commandLine((int) argv.size() - 1, argv.data()));
+    }
+
+    if (pid < 0) {
+        LOG_ERROR(std::string("Could not fork: ") + strerror(errno));
+        BinaryWriter answer;
+        answer.writeI32(EXIT_FAILURE);
+        ServerProtocol::writeFully(connection, answer.getBuffer().data(), answer.getBuffer().size());
+        close(connection);
+        return;
+    }
+    LOG_DEBUG("Started run " + std::to_string(pid) + " in " + workingDir);
+    pendingRuns[pid] = {connection, start};
+}
+
+void GeneratorServer::reapChildren() {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        finishRun(pid, status);
+    }
+}
+
+void GeneratorServer::finishRun(pid_t pid, int status) {
+    auto run = pendingRuns.find(pid);
+    if (run == pendingRuns.end()) {
+        return;
+    }
+    // Like a shell, a child killed by a signal reports 128 plus the signal
+    BinaryWriter answer;
+    answer.writeI32(WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+    ServerProtocol::writeFully(run->second.connection, answer.getBuffer().data(), answer.getBuffer().size());
+    close(run->second.connection);
+    recordLatency(run->second.start);
+    pendingRuns.erase(run);
+}
+
+void GeneratorServer::recordLatency(std::chrono::steady_clock::time_point start) {
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (latencies.size() < latencyWindow) {
+        latencies.push_back(milliseconds);
+    } else {
+        latencies[servedRequests % latencyWindow] = milliseconds;
+    }
+    servedRequests++;
+}
+
+std::string GeneratorServer::describeLatencies() const {
+    std::vector<double> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    // Nearest rank, the smallest latency that at least the given share of requests stayed below
+    auto percentile = [&sorted](double share) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        auto rank = (std::size_t) std::ceil(share * (double) sorted.size());
+        return sorted[std::max<std::size_t>(rank, 1) - 1];
+    };
+    char text[160];
+    snprintf(text, sizeof(text), "%zu requests, latency p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms",
+             servedRequests, percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.0));
+    return text;
+}
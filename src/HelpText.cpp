@@ -5,7 +5,7 @@
 #include "HelpText.h"
 #include "Logger.h"
 
-HelpText::HelpText(GetOptSetup *getOptSetup)
+HelpText::HelpText(const GetOptSetup *getOptSetup)
 {
     this->getOptSetup = getOptSetup;
 }
@@ -28,26 +28,28 @@ void HelpText::parseDescription()
     printHelpText.append("Description:\\n" + justify.justifyTheText(new_description, getOptSetup->getSignPerLine(), false, 0) + "\\n");
 }
 
-bool compareOptions(const Option &a, const Option &b) {
-    if (a.getShortOpt() != '\0' && b.getShortOpt() != '\0') {
-        return a.getShortOpt() < b.getShortOpt();
+bool compareOptions(const Option *a, const Option *b) {
+    if (a->getShortOpt() != '\0' && b->getShortOpt() != '\0') {
+        return a->getShortOpt() < b->getShortOpt();
     }
-    else if (a.getShortOpt() != '\0') {
+    else if (a->getShortOpt() != '\0') {
         return true;
     }
-    else if (b.getShortOpt() != '\0') {
+    else if (b->getShortOpt() != '\0') {
         return false;
     }
     else {
-        return a.getLongOpt() < b.getLongOpt();
+        return a->getLongOpt() < b->getLongOpt();
     }
 }
 
-vector<string> HelpText::concatParams(const vector<Option>& options)
+vector<string> HelpText::concatParams(const vector<const Option *>& options)
 {
     vector<string> opts;
+    opts.reserve(options.size());
 
-    for (const auto & option : options) {
+    for (const Option *optionPointer : options) {
+        const Option &option = *optionPointer;
         string opt;
         // check if shortOpt isn't empty
         if (option.getShortOpt() != '\0')
@@ -81,8 +83,12 @@ vector<string> HelpText::concatParams(const vector<Option>& options)
 
 void HelpText::parseOption()
 {
-    // sorting options
-    vector<Option> sortedOpts = getOptSetup->getOptions();
+    // sorting pointers to the options, the options themselves are not copied
+    vector<const Option *> sortedOpts;
+    sortedOpts.reserve(getOptSetup->getOptions().size());
+    for (const auto &option : getOptSetup->getOptions()) {
+        sortedOpts.push_back(&option);
+    }
     std::sort(sortedOpts.begin(), sortedOpts.end(), compareOptions);
 
     // concatenate params
@@ -93,7 +99,7 @@ void HelpText::parseOption()
     buffer << std::left << std::setw(maxOptionParamLength + shift) << "Parameters";
     buffer << "Description" << "\\n";
 
-    for (int i = 0; i < sortedOpts.size(); i++)
+    for (size_t i = 0; i < sortedOpts.size(); i++)
     {
         // get the concatenated params
         buffer << std::left << std::setw(maxOptionParamLength + shift) << opts[i];
@@ -109,7 +115,7 @@ void HelpText::parseOption()
             int optionShift = maxOptionParamLength + shift;
 
             // justify the description text
-            string new_description = justify.justifyTheText(sortedOpts[i].getDescription(), new_signPerLine, true, optionShift);
+            string new_description = justify.justifyTheText(sortedOpts[i]->getDescription(), new_signPerLine, true, optionShift);
             buffer << new_description;
         }
     }
@@ -17,7 +17,8 @@
 #include <boost/log/utility/setup/common_attributes.hpp>
 #include <boost/log/utility/setup/filter_parser.hpp>
 #include <boost/log/utility/setup/formatter_parser.hpp>
-#include <boost/log/utility/setup/from_stream.hpp>
+#include <boost/log/utility/setup/from_settings.hpp>
+#include <boost/log/utility/setup/settings_parser.hpp>
 #include <boost/log/utility/setup/settings.hpp>
 #include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
@@ -25,8 +26,10 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 
+#include <atomic>
 #include <fstream>
 #include <string>
+#include <thread>
 
 BOOST_LOG_GLOBAL_LOGGER_CTOR_ARGS(sysLogger,
                                   boost::log::sources::severity_channel_logger_mt<boost::log::trivial::severity_level>,
@@ -76,13 +79,44 @@ public:
     }
 };
 
+namespace {
+    /// States of the initialization deferred by Logger::initLazily()
+    enum LazyState {NOT_DEFERRED, DEFERRED, INITIALIZING, INITIALIZED};
+
+    std::atomic<int> lazyState{NOT_DEFERRED};
+    std::string lazyConfigFileName;
+    bool lazySynchronous = false;
+
+    /// initFromConfig() logs itself, its records must not wait for it
+    thread_local bool initializingHere = false;
+
+    void initDeferred() {
+        int state = lazyState.load(std::memory_order_acquire);
+        if (state == NOT_DEFERRED || state == INITIALIZED || initializingHere) {
+            return;
+        }
+        int expected = DEFERRED;
+        if (lazyState.compare_exchange_strong(expected, INITIALIZING)) {
+            initializingHere = true;
+            Logger::initFromConfig(lazyConfigFileName, lazySynchronous);
+            initializingHere = false;
+            lazyState.store(INITIALIZED, std::memory_order_release);
+            return;
+        }
+        // Another thread logged first, its sinks are about to be set up
+        while (lazyState.load(std::memory_order_acquire) == INITIALIZING) {
+            std::this_thread::yield();
+        }
+    }
+}
+
 void
 Logger::init() {
     initFromConfig("");
 }
 
 void
-Logger::initFromConfig(const std::string& configFileName) {
+Logger::initFromConfig(const std::string& configFileName, bool synchronous) {
     // Disable all exceptions
     boost::log::core::get()->set_exception_handler(boost::log::make_exception_suppressor());
 
@@ -110,7 +144,14 @@ Logger::initFromConfig(const std::string& configFileName) {
         } else {
             try {
                 // Still can throw even with the exception suppressor above.
-                boost::log::init_from_stream(ifs);
+                boost::log::settings settings = boost::log::parse_settings(ifs);
+                if (synchronous && settings.has_section("Sinks")) {
+                    boost::log::settings::section sinks = settings["Sinks"];
+                    for (auto sink = sinks.begin(); sink != sinks.end(); ++sink) {
+                        (*sink)["Asynchronous"] = "false";
+                    }
+                }
+                boost::log::init_from_settings(settings);
             } catch (std::exception &e) {
                 std::string err = "Caught exception initializing boost logging: ";
                 err += e.what();
@@ -126,6 +167,34 @@ Logger::initFromConfig(const std::string& configFileName) {
     LOG_INFO("Log Start");
 }
 
+void
+Logger::initLazily(const std::string& configFileName, bool synchronous) {
+    lazyConfigFileName = configFileName;
+    lazySynchronous = synchronous;
+    lazyState.store(DEFERRED, std::memory_order_release);
+}
+
+sysLogger::logger_type&
+Logger::getSysLogger() {
+    initDeferred();
+    return sysLogger::get();
+}
+
+dataLogger::logger_type&
+Logger::getDataLogger() {
+    initDeferred();
+    return dataLogger::get();
+}
+
+void
+Logger::quiet() {
+    // Nothing has been logged yet, the console sink of the default initialization is enough
+    if (lazyState.load(std::memory_order_acquire) == DEFERRED) {
+        lazyConfigFileName.clear();
+    }
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+}
+
 void
 Logger::disable() {
     boost::log::core::get()->set_logging_enabled(false);
@@ -0,0 +1,64 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "MemoryStream.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <cstdlib>
+
+MemoryStream::~MemoryStream() {
+    clear();
+}
+
+FILE *MemoryStream::getFile() {
+    if (file == nullptr) {
+        file = open_memstream(&buffer, &bufferSize);
+        if (file == nullptr) {
+            LOG_ERROR("Could not open memory stream");
+            throw GeneratorException("Could not open memory stream");
+        }
+    }
+    return file;
+}
+
+void MemoryStream::writeTo(FILE *out) {
+    if (file == nullptr) {
+        return;
+    }
+    // Flushing updates buffer and bufferSize
+    fflush(file);
+    fwrite(buffer, 1, bufferSize, out);
+}
+
+void MemoryStream::writeTo(FILE *out, std::size_t begin, std::size_t end) {
+    if (file == nullptr || begin >= end) {
+        return;
+    }
+    fflush(file);
+    fwrite(buffer + begin, 1, end - begin, out);
+}
+
+const char *MemoryStream::getData() {
+    if (file != nullptr) {
+        fflush(file);
+    }
+    return buffer != nullptr ? buffer : "";
+}
+
+std::size_t MemoryStream::getSize() {
+    if (file != nullptr) {
+        fflush(file);
+    }
+    return bufferSize;
+}
+
+void MemoryStream::clear() {
+    if (file != nullptr) {
+        fclose(file);
+        file = nullptr;
+    }
+    free(buffer);
+    buffer = nullptr;
+    bufferSize = 0;
+}
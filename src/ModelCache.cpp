@@ -0,0 +1,109 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "ModelCache.h"
+#include "ContentHash.h"
+#include "Logger.h"
+#include "Version.h"
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+namespace {
+    const char magic[4] = {'G', 'O', 'S', 'C'};
+}
+
+ModelCache::ModelCache(const std::string &directory) : directory(directory) {
+}
+
+std::string ModelCache::pathOf(uint64_t specHash) const {
+    return (boost::filesystem::path(directory) / (ContentHash::toHex(specHash) + ".model")).string();
+}
+
+bool ModelCache::load(uint64_t specHash, GetOptSetup &getOptSetup) const {
+    std::string path = pathOf(specHash);
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        LOG_DEBUG("Model cache miss for " + path);
+        return false;
+    }
+
+    // Read the whole entry with a single read
+    std::string data;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data.resize((std::size_t) size);
+            data.resize(fread(&data[0], 1, data.size(), file));
+        }
+    }
+    fclose(file);
+
+    try {
+        BinaryReader reader(data.data(), data.size());
+        for (char c: magic) {
+            if (reader.readU8() != (uint8_t) c) {
+                LOG_WARN("Ignoring model cache entry with unknown format: " + path);
+                return false;
+            }
+        }
+        if (reader.readU32() != layoutVersion) {
+            LOG_DEBUG("Ignoring model cache entry with another layout " + path);
+            return false;
+        }
+        // Another version of the generator may parse the same spec into another model
+        if (reader.readString() != CODEGENERATOR_VERSION || reader.readU64() != specHash) {
+            LOG_DEBUG("Ignoring outdated model cache entry " + path);
+            return false;
+        }
+        GetOptSetup cached;
+        cached.deserialize(reader);
+        if (!reader.atEnd()) {
+            LOG_WARN("Ignoring corrupt model cache entry " + path);
+            return false;
+        }
+        getOptSetup = cached;
+    } catch (const std::exception &e) {
+        LOG_WARN("Ignoring corrupt model cache entry " + path + ": " + e.what());
+        return false;
+    }
+    LOG_DEBUG("Model cache hit for " + path);
+    return true;
+}
+
+void ModelCache::store(uint64_t specHash, const GetOptSetup &getOptSetup) const {
+    BinaryWriter writer;
+    for (char c: magic) {
+        writer.writeU8((uint8_t) c);
+    }
+    writer.writeU32(layoutVersion);
+    writer.writeString(CODEGENERATOR_VERSION);
+    writer.writeU64(specHash);
+    getOptSetup.serialize(writer);
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories(directory, error);
+
+    // Concurrent runs may store the same entry, every writer uses its own temporary file
+    std::string path = pathOf(specHash);
+    std::ostringstream tempPath;
+    tempPath << path << ".tmp." << getpid() << "." << std::this_thread::get_id();
+
+    FILE *file = fopen(tempPath.str().c_str(), "wb");
+    if (file == nullptr) {
+        LOG_WARN("Unable to write model cache entry " + tempPath.str());
+        return;
+    }
+    const std::string &data = writer.getBuffer();
+    size_t written = fwrite(data.data(), 1, data.size(), file);
+    if (fclose(file) != 0 || written != data.size() || rename(tempPath.str().c_str(), path.c_str()) != 0) {
+        LOG_WARN("Unable to write model cache entry " + path);
+        remove(tempPath.str().c_str());
+        return;
+    }
+    LOG_DEBUG("Stored model cache entry " + path);
+}
@@ -0,0 +1,382 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "NativeXMLParser.h"
+#include "GeneratorException.h"
+#include "SpecVocabulary.h"
+#include "Logger.h"
+#include <cstring>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace {
+    /**
+     * @brief Appends a code point as UTF-8
+     * @return false if the code point is not a valid XML character
+     */
+    bool appendUtf8(std::string &buffer, unsigned long codePoint) {
+        if (codePoint == 0 || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return false;
+        }
+        if (codePoint < 0x80) {
+            buffer.push_back((char) codePoint);
+        } else if (codePoint < 0x800) {
+            buffer.push_back((char) (0xC0 | (codePoint >> 6)));
+            buffer.push_back((char) (0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            buffer.push_back((char) (0xE0 | (codePoint >> 12)));
+            buffer.push_back((char) (0x80 | ((codePoint >> 6) & 0x3F)));
+            buffer.push_back((char) (0x80 | (codePoint & 0x3F)));
+        } else {
+            buffer.push_back((char) (0xF0 | (codePoint >> 18)));
+            buffer.push_back((char) (0x80 | ((codePoint >> 12) & 0x3F)));
+            buffer.push_back((char) (0x80 | ((codePoint >> 6) & 0x3F)));
+            buffer.push_back((char) (0x80 | (codePoint & 0x3F)));
+        }
+        return true;
+    }
+
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    /**
+     * @brief Characters that end a name
+     */
+    const char *const nameDelimiters = " \t\r\n/>=<\"'";
+}
+
+NativeXMLParser::NativeXMLParser(const std::string &filename) : SpecParser(filename) {
+}
+
+void NativeXMLParser::parse() {
+    LOG_INFO("Starting native parsing of file " + filename);
+
+    boost::iostreams::mapped_file_source file;
+    if (buffer != nullptr) {
+        begin = buffer;
+        end = begin + bufferSize;
+    } else {
+        boost::system::error_code error;
+        if (boost::filesystem::file_size(filename, error) == 0 || error) {
+            LOG_ERROR("Could not read file " + filename);
+            throw GeneratorException("Could not read " + filename);
+        }
+        try {
+            file.open(filename);
+        } catch (const std::exception &e) {
+            LOG_ERROR("Could not map file " + filename + ": " + e.what());
+            throw GeneratorException("Could not read " + filename);
+        }
+        begin = file.data();
+        end = begin + file.size();
+    }
+    position = begin;
+    // UTF-8 byte order mark
+    if (end - position >= 3 && memcmp(position, "\xEF\xBB\xBF", 3) == 0) {
+        position += 3;
+    }
+
+    parseDocument();
+    LOG_INFO("Finished native parsing of file " + filename);
+}
+
+void NativeXMLParser::parseDocument() {
+    bool seenRoot = false;
+    openElements.clear();
+
+    while (position < end) {
+        if (*position != '<') {
+            parseText();
+            continue;
+        }
+        boost::string_view rest(position, (std::size_t) (end - position));
+        if (rest.starts_with("<!--")) {
+            position += 4;
+            skipPast("-->", "comment");
+        } else if (rest.starts_with("<![CDATA[")) {
+            position += 9;
+            boost::string_view text = skipPast("]]>", "CDATA section");
+            if (openElements.empty()) {
+                fail("CDATA section outside of the root element");
+            }
+            if (isTextState()) {
+                memoryBudget.charge(text.size());
+            }
+            handleCharacters(text);
+        } else if (rest.starts_with("<?")) {
+            position += 2;
+            skipPast("?>", "processing instruction");
+        } else if (rest.starts_with("<!DOCTYPE")) {
+            position += 9;
+            skipPast(">", "DOCTYPE");
+        } else if (rest.starts_with("</")) {
+            position += 2;
+            parseEndTag();
+        } else {
+            position += 1;
+            if (openElements.empty() && seenRoot) {
+                fail("Only one root element is allowed");
+            }
+            seenRoot = true;
+            parseStartTag();
+        }
+    }
+
+    if (!openElements.empty()) {
+        fail("Unexpected end of document, <" + openElements.back().to_string() + "> is not closed");
+    }
+    if (!seenRoot) {
+        fail("No root element");
+    }
+}
+
+void NativeXMLParser::parseStartTag() {
+    boost::string_view name = parseName();
+    bool emptyElement = false;
+
+    attributes.clear();
+    while (true) {
+        const char *beforeWhitespace = position;
+        skipWhitespace();
+        if (position >= end) {
+            fail("Unexpected end of document in <" + name.to_string() + ">");
+        }
+        if (*position == '>') {
+            position++;
+            break;
+        }
+        if (*position == '/') {
+            if (position + 1 < end && position[1] == '>') {
+                position += 2;
+                emptyElement = true;
+                break;
+            }
+            fail("Expected '>' after '/' in <" + name.to_string() + ">");
+        }
+        if (position == beforeWhitespace) {
+            fail("Expected whitespace before attribute in <" + name.to_string() + ">");
+        }
+
+        Attribute attribute;
+        attribute.name = parseName();
+        skipWhitespace();
+        if (position >= end || *position != '=') {
+            fail("Expected '=' after attribute " + attribute.name.to_string());
+        }
+        position++;
+        skipWhitespace();
+        if (position >= end || (*position != '"' && *position != '\'')) {
+            fail("Expected quoted value for attribute " + attribute.name.to_string());
+        }
+        char quote = *position++;
+        auto valueEnd = (const char *) memchr(position, quote, (std::size_t) (end - position));
+        if (valueEnd == nullptr) {
+            fail("Unterminated value of attribute " + attribute.name.to_string());
+        }
+        attribute.value = boost::string_view(position, (std::size_t) (valueEnd - position));
+        if (attribute.value.find('<') != boost::string_view::npos) {
+            fail("'<' is not allowed in the value of attribute " + attribute.name.to_string());
+        }
+        position = valueEnd + 1;
+        memoryBudget.charge(attribute.value.size());
+        attributes.push_back(attribute);
+    }
+
+    // Only values with references or whitespace to normalize are copied, every attribute has its own buffer
+    if (attributeBuffers.size() < attributes.size()) {
+        attributeBuffers.resize(attributes.size());
+    }
+    for (std::size_t i = 0; i < attributes.size(); i++) {
+        attributes[i].value = decode(attributes[i].value, attributeBuffers[i], true);
+    }
+
+    openElements.push_back(name);
+    startElement(name, attributes);
+    if (emptyElement) {
+        endElement(name);
+        openElements.pop_back();
+    }
+}
+
+void NativeXMLParser::parseEndTag() {
+    boost::string_view name = parseName();
+    skipWhitespace();
+    if (position >= end || *position != '>') {
+        fail("Expected '>' in </" + name.to_string() + ">");
+    }
+    position++;
+    if (openElements.empty()) {
+        fail("Unexpected </" + name.to_string() + ">");
+    }
+    if (openElements.back() != name) {
+        fail("Unexpected </" + name.to_string() + ">, expected </" + openElements.back().to_string() + ">");
+    }
+    endElement(name);
+    openElements.pop_back();
+}
+
+void NativeXMLParser::parseText() {
+    const char *start = position;
+    auto next = (const char *) memchr(position, '<', (std::size_t) (end - position));
+    position = next != nullptr ? next : end;
+
+    boost::string_view raw(start, (std::size_t) (position - start));
+    if (openElements.empty()) {
+        for (char c: raw) {
+            if (!isWhitespace(c)) {
+                fail("Text outside of the root element");
+            }
+        }
+        return;
+    }
+    if (isTextState()) {
+        memoryBudget.charge(raw.size());
+    }
+    handleCharacters(decode(raw, textBuffer));
+}
+
+boost::string_view NativeXMLParser::skipPast(boost::string_view terminator, const char *what) {
+    boost::string_view rest(position, (std::size_t) (end - position));
+    std::size_t found = rest.find(terminator);
+    if (found == boost::string_view::npos) {
+        fail(std::string("Unterminated ") + what);
+    }
+    position += found + terminator.size();
+    return rest.substr(0, found);
+}
+
+boost::string_view NativeXMLParser::parseName() {
+    const char *start = position;
+    while (position < end && strchr(nameDelimiters, *position) == nullptr) {
+        position++;
+    }
+    if (position == start) {
+        fail("Expected a name");
+    }
+    return {start, (std::size_t) (position - start)};
+}
+
+void NativeXMLParser::skipWhitespace() {
+    while (position < end && isWhitespace(*position)) {
+        position++;
+    }
+}
+
+boost::string_view NativeXMLParser::decode(boost::string_view raw, std::string &buffer, bool attributeValue) const {
+    if (raw.find_first_of(attributeValue ? "&\t\r\n" : "&\r") == boost::string_view::npos) {
+        return raw;
+    }
+    // Attribute value normalization replaces literal whitespace with a space, characters
+    // from references like &#10; are kept
+    char lineBreak = attributeValue ? ' ' : '\n';
+    buffer.clear();
+    buffer.reserve(raw.size());
+    for (std::size_t i = 0; i < raw.size(); i++) {
+        char c = raw[i];
+        if (c == '\r') {
+            // Line breaks are normalized to a single '\n'
+            if (i + 1 < raw.size() && raw[i + 1] == '\n') {
+                continue;
+            }
+            buffer.push_back(lineBreak);
+        } else if (attributeValue && (c == '\t' || c == '\n')) {
+            buffer.push_back(' ');
+        } else if (c != '&') {
+            buffer.push_back(c);
+        } else {
+            std::size_t semicolon = raw.find(';', i);
+            if (semicolon == boost::string_view::npos) {
+                fail("Unterminated entity reference");
+            }
+            boost::string_view reference = raw.substr(i + 1, semicolon - i - 1);
+            if (reference == "lt") {
+                buffer.push_back('<');
+            } else if (reference == "gt") {
+                buffer.push_back('>');
+            } else if (reference == "amp") {
+                buffer.push_back('&');
+            } else if (reference == "quot") {
+                buffer.push_back('"');
+            } else if (reference == "apos") {
+                buffer.push_back('\'');
+            } else if (reference.size() > 1 && reference[0] == '#') {
+                bool hex = reference[1] == 'x';
+                std::string digits = reference.substr(hex ? 2 : 1).to_string();
+                char *digitsEnd = nullptr;
+                unsigned long codePoint = strtoul(digits.c_str(), &digitsEnd, hex ? 16 : 10);
+                if (digits.empty() || *digitsEnd != '\0' || !appendUtf8(buffer, codePoint)) {
+                    fail("Invalid character reference &" + reference.to_string() + ";");
+                }
+            } else {
+                fail("Unknown entity &" + reference.to_string() + ";");
+            }
+            i = semicolon;
+        }
+    }
+    return buffer;
+}
+
+void NativeXMLParser::startElement(boost::string_view name, const std::vector<Attribute> &elementAttributes) {
+    LOG_TRACE("Start Element: " << name);
+    SpecElement element = SpecVocabulary::element(name);
+    if (element == SpecElement::UNKNOWN) {
+        return;
+    }
+    handleEvent(SpecVocabulary::startEvent(element));
+    switch (element) {
+        case SpecElement::GETOPTSETUP:
+            for (auto &attribute: elementAttributes) {
+                getOptSetup->setAttribute(SpecVocabulary::attribute(attribute.name), attribute.value);
+            }
+            break;
+        case SpecElement::AUTHOR: {
+            Author author;
+            for (auto &attribute: elementAttributes) {
+                author.setAttribute(SpecVocabulary::attribute(attribute.name), attribute.value);
+            }
+            getOptSetup->setAuthor(author);
+            break;
+        }
+        case SpecElement::OPTION: {
+            memoryBudget.charge(sizeof(Option));
+            Option option;
+            for (auto &attribute: elementAttributes) {
+                option.setAttribute(SpecVocabulary::attribute(attribute.name), attribute.value);
+            }
+            addOption(option);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void NativeXMLParser::endElement(boost::string_view name) {
+    LOG_TRACE("End Element: " << name);
+    SpecElement element = SpecVocabulary::element(name);
+    if (element != SpecElement::UNKNOWN) {
+        handleEvent(SpecVocabulary::endEvent(element));
+    }
+}
+
+std::string NativeXMLParser::getLocation() const {
+    // Line and column are only computed for messages
+    std::size_t line = 1;
+    std::size_t column = 1;
+    for (const char *p = begin; p < position && p < end; p++) {
+        if (*p == '\n') {
+            line++;
+            column = 1;
+        } else {
+            column++;
+        }
+    }
+    return filename + ":" + std::to_string(line) + ":" + std::to_string(column);
+}
+
+void NativeXMLParser::fail(const std::string &message) const {
+    LOG_ERROR(getLocation() << ": " << message);
+    throw GeneratorException(getLocation() + ": " + message);
+}
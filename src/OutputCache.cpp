@@ -0,0 +1,296 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "OutputCache.h"
+#include "ContentHash.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+namespace {
+    /**
+     * @brief Name of the file in an entry that lists the generated files in order
+     */
+    const char indexName[] = "outputs";
+
+    /**
+     * @brief Path for a temporary file or directory next to a path, unique per process and thread
+     * @param path the final path
+     * @return the temporary path
+     */
+    std::string temporaryPathOf(const std::string &path) {
+        std::ostringstream tempPath;
+        tempPath << path << ".tmp." << getpid() << "." << std::this_thread::get_id();
+        return tempPath.str();
+    }
+
+    /**
+     * @brief Reads a whole file
+     * @param path the file
+     * @param content receives the content
+     * @return false if the file can not be read
+     */
+    bool readFile(const std::string &path, std::string &content) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        std::ostringstream stream;
+        stream << in.rdbuf();
+        content = stream.str();
+        return true;
+    }
+
+    /**
+     * @brief Puts a cached file into place
+     * A new output is hard linked to the cached file, or copied if the cache is on another file
+     * system. An output with other content is replaced by a copy, a link would give it the time
+     * of the cache entry, which may be older than the files built from the output it replaces.
+     * @param cached the file in the cache
+     * @param path the output file, replaced atomically unless it already has the same content
+     * @param bytes receives the size of the file
+     * @return false if the file could not be put into place
+     */
+    bool placeFile(const std::string &cached, const std::string &path, std::size_t &bytes) {
+        struct stat cachedStat = {};
+        struct stat outputStat = {};
+        if (stat(cached.c_str(), &cachedStat) != 0) {
+            return false;
+        }
+        bytes = (std::size_t) cachedStat.st_size;
+        bool exists = stat(path.c_str(), &outputStat) == 0;
+        if (exists) {
+            if (outputStat.st_dev == cachedStat.st_dev && outputStat.st_ino == cachedStat.st_ino) {
+                return true;
+            }
+            // Unchanged outputs keep their time, so build systems do not compile them again
+            std::string cachedContent;
+            std::string outputContent;
+            if (outputStat.st_size == cachedStat.st_size && readFile(cached, cachedContent)
+                && readFile(path, outputContent) && cachedContent == outputContent) {
+                return true;
+            }
+        }
+
+        std::string tempPath = temporaryPathOf(path);
+        boost::system::error_code error;
+        if (exists || link(cached.c_str(), tempPath.c_str()) != 0) {
+            // A copy gets the current time
+            boost::filesystem::copy_file(cached, tempPath, boost::filesystem::copy_option::overwrite_if_exists, error);
+        }
+        if (error || rename(tempPath.c_str(), path.c_str()) != 0) {
+            remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the path of an output relative to its output directory
+     * @param output path of the output, the output directory followed by the name from the spec
+     * @param outputDir the output directory, empty or ending with a separator
+     * @param name receives the relative path
+     * @return false if the output is not inside the output directory
+     */
+    bool relativeNameOf(const std::string &output, const std::string &outputDir, std::string &name) {
+        if (output.compare(0, outputDir.size(), outputDir) != 0) {
+            return false;
+        }
+        boost::filesystem::path relative = boost::filesystem::path(output.substr(outputDir.size())).lexically_normal();
+        // The name is a path inside the entry as well
+        if (relative.empty() || relative.is_absolute() || *relative.begin() == "..") {
+            return false;
+        }
+        name = relative.generic_string();
+        return true;
+    }
+
+    /**
+     * @brief Sums up the size of the files of a cache entry
+     * @param path the entry directory
+     * @return bytes
+     */
+    std::size_t entrySizeOf(const boost::filesystem::path &path) {
+        std::size_t bytes = 0;
+        boost::system::error_code error;
+        for (boost::filesystem::recursive_directory_iterator file(path, error), end;
+             !error && file != end; file.increment(error)) {
+            boost::system::error_code fileError;
+            if (boost::filesystem::is_regular_file(file->path(), fileError)) {
+                bytes += (std::size_t) boost::filesystem::file_size(file->path(), fileError);
+            }
+        }
+        return bytes;
+    }
+}
+
+OutputCache::OutputCache(const std::string &directory, std::size_t maxBytes)
+        : directory(directory), maxBytes(maxBytes) {
+}
+
+const std::string &OutputCache::getDirectory() const {
+    return directory;
+}
+
+std::size_t OutputCache::getMaxBytes() const {
+    return maxBytes;
+}
+
+std::string OutputCache::pathOf(uint64_t key) const {
+    return (boost::filesystem::path(directory) / ContentHash::toHex(key)).string();
+}
+
+bool OutputCache::materialize(uint64_t key, const std::string &outputDir, std::vector<std::string> &outputs) {
+    std::string entry = pathOf(key);
+    std::ifstream index((boost::filesystem::path(entry) / indexName).string());
+    if (!index) {
+        LOG_DEBUG("Output cache miss for " + entry);
+        misses++;
+        return false;
+    }
+
+    std::vector<std::string> paths;
+    std::size_t bytes = 0;
+    std::string name;
+    while (std::getline(index, name)) {
+        std::size_t fileBytes = 0;
+        std::string path = outputDir + name;
+        boost::system::error_code error;
+        boost::filesystem::path parent = boost::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            boost::filesystem::create_directories(parent, error);
+        }
+        if (!placeFile((boost::filesystem::path(entry) / name).string(), path, fileBytes)) {
+            // Evicted by another run in the meantime, or the output directory is not writable
+            LOG_WARN("Unable to take " + path + " from the output cache");
+            misses++;
+            return false;
+        }
+        paths.push_back(path);
+        bytes += fileBytes;
+    }
+    // The time of the entry is the time of its last use
+    utimes(entry.c_str(), nullptr);
+
+    LOG_DEBUG("Output cache hit for " + entry);
+    hits++;
+    hitBytes += bytes;
+    outputs = paths;
+    return true;
+}
+
+void OutputCache::store(uint64_t key, const std::string &outputDir, const std::vector<std::string> &outputs) {
+    std::string entry = pathOf(key);
+    boost::system::error_code error;
+    if (boost::filesystem::exists(boost::filesystem::path(entry) / indexName, error)) {
+        return;
+    }
+
+    // The entry is filled in a temporary directory and renamed into place, so it is never
+    // seen incomplete. Output files are copied, a hard link would change with them.
+    std::string tempPath = temporaryPathOf(entry);
+    boost::filesystem::create_directories(tempPath, error);
+    std::string index;
+    std::size_t bytes = 0;
+    for (auto &output: outputs) {
+        // Names from the spec may have directories, they are kept below the entry
+        std::string name;
+        if (!relativeNameOf(output, outputDir, name)) {
+            error = boost::system::errc::make_error_code(boost::system::errc::invalid_argument);
+            break;
+        }
+        boost::filesystem::path cached = boost::filesystem::path(tempPath) / name;
+        boost::filesystem::create_directories(cached.parent_path(), error);
+        if (error) {
+            break;
+        }
+        boost::filesystem::copy_file(output, cached, boost::filesystem::copy_option::overwrite_if_exists, error);
+        if (error) {
+            break;
+        }
+        bytes += (std::size_t) boost::filesystem::file_size(output, error);
+        index.append(name).append("\n");
+    }
+    if (!error) {
+        std::ofstream indexFile((boost::filesystem::path(tempPath) / indexName).string(), std::ios::trunc);
+        indexFile << index;
+        indexFile.close();
+        if (!indexFile || rename(tempPath.c_str(), entry.c_str()) != 0) {
+            // Usually another run stored the same entry first
+            error = boost::system::error_code(errno, boost::system::generic_category());
+        }
+    }
+    if (error) {
+        LOG_DEBUG("Did not store output cache entry " + entry + ": " + error.message());
+        boost::filesystem::remove_all(tempPath, error);
+        return;
+    }
+    LOG_DEBUG("Stored output cache entry " + entry);
+    storedBytes += bytes;
+    storedEntries++;
+}
+
+void OutputCache::evict() {
+    // Only a store makes the cache grow, a run that stored nothing does not have to scan it
+    if (storedEntries == 0) {
+        return;
+    }
+    struct Entry {
+        boost::filesystem::path path;
+        std::time_t lastUse;
+        std::size_t bytes;
+    };
+    std::vector<Entry> entries;
+    std::size_t totalBytes = 0;
+    boost::system::error_code error;
+    for (boost::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        // Temporary directories belong to runs that are still storing
+        boost::system::error_code fileError;
+        if (!boost::filesystem::is_directory(it->path(), fileError)
+            || it->path().filename().string().find(".tmp.") != std::string::npos) {
+            continue;
+        }
+        Entry entry = {it->path(), boost::filesystem::last_write_time(it->path(), fileError), entrySizeOf(it->path())};
+        totalBytes += entry.bytes;
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.lastUse < b.lastUse;
+    });
+    std::size_t evicted = 0;
+    for (auto &entry: entries) {
+        if (totalBytes <= maxBytes) {
+            break;
+        }
+        // Another run may remove the same entry, or materialize it right now and miss
+        boost::filesystem::remove_all(entry.path, error);
+        totalBytes -= entry.bytes;
+        evicted++;
+    }
+    if (evicted > 0) {
+        LOG_INFO("Evicted " + std::to_string(evicted) + " entries from the output cache " + directory);
+    }
+    cacheBytes = totalBytes;
+    cacheEntries = entries.size() - evicted;
+    scanned = true;
+}
+
+std::string OutputCache::describe() const {
+    std::ostringstream text;
+    text << "Output cache: " << hits << " hits, " << misses << " misses, " << hitBytes << " bytes reused, "
+         << storedBytes << " bytes stored";
+    if (scanned) {
+        text << ", " << cacheBytes << " bytes in " << cacheEntries << " entries";
+    }
+    return text.str();
+}
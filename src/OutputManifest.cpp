@@ -0,0 +1,176 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "OutputManifest.h"
+#include "ContentHash.h"
+#include "Logger.h"
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace {
+    const char *const manifestHeader = "# CodeGenerator output manifest v1";
+}
+
+OutputManifest::OutputManifest(const std::string &path) : path(path) {
+}
+
+void OutputManifest::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    modified = false;
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_DEBUG("No output manifest at " + path);
+        return;
+    }
+    std::string line;
+    if (!std::getline(file, line) || line != manifestHeader) {
+        LOG_WARN("Ignoring output manifest with unknown format: " + path);
+        return;
+    }
+    // key \t size \t mtime \t hash \t generator \t output...
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        boost::split(fields, line, boost::is_any_of("\t"));
+        if (fields.size() < 5) {
+            continue;
+        }
+        Entry entry;
+        try {
+            entry.size = boost::lexical_cast<uint64_t>(fields[1]);
+            entry.mtime = boost::lexical_cast<int64_t>(fields[2]);
+        } catch (boost::bad_lexical_cast &) {
+            continue;
+        }
+        if (!ContentHash::fromHex(fields[3], entry.hash)) {
+            continue;
+        }
+        entry.generator = fields[4];
+        entry.outputs.assign(fields.begin() + 5, fields.end());
+        entries[fields[0]] = entry;
+    }
+    LOG_DEBUG("Loaded output manifest " + path + " with " + std::to_string(entries.size()) + " entries");
+}
+
+void OutputManifest::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!modified) {
+        return;
+    }
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARN("Unable to write output manifest " + tempPath);
+            return;
+        }
+        file << manifestHeader << "\n";
+        for (auto &item: entries) {
+            const Entry &entry = item.second;
+            file << item.first << "\t" << entry.size << "\t" << entry.mtime << "\t"
+                 << ContentHash::toHex(entry.hash) << "\t" << entry.generator;
+            for (auto &output: entry.outputs) {
+                file << "\t" << output;
+            }
+            file << "\n";
+        }
+    }
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_WARN("Unable to replace output manifest " + path);
+        remove(tempPath.c_str());
+        return;
+    }
+    modified = false;
+}
+
+bool OutputManifest::isUpToDate(const std::string &specPath, const std::string &generator) {
+    std::string key = keyOf(specPath);
+    Entry recorded;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return false;
+        }
+        recorded = it->second;
+    }
+    if (recorded.generator != generator) {
+        LOG_DEBUG("Generator changed for " + specPath);
+        return false;
+    }
+    Entry current;
+    if (!statFile(specPath, current)) {
+        return false;
+    }
+    for (auto &output: recorded.outputs) {
+        Entry outputStat;
+        if (!statFile(output, outputStat)) {
+            LOG_DEBUG("Output " + output + " of " + specPath + " is missing");
+            return false;
+        }
+    }
+    if (current.size == recorded.size && current.mtime == recorded.mtime) {
+        return true;
+    }
+    // Touched but maybe not changed, fall back to the content
+    if (current.size != recorded.size || !ContentHash::ofFile(specPath, current.hash)
+        || current.hash != recorded.hash) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry &entry = entries[key];
+    entry.mtime = current.mtime;
+    modified = true;
+    return true;
+}
+
+void OutputManifest::update(const std::string &specPath, const std::string &generator, const Entry &spec,
+                            const std::vector<std::string> &outputs) {
+    // A spec written after it was read has another mtime, the next run compares its hash
+    Entry entry = spec;
+    entry.generator = generator;
+    entry.outputs = outputs;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[keyOf(specPath)] = entry;
+    modified = true;
+}
+
+void OutputManifest::forget(const std::string &specPath) {
+    std::string key = keyOf(specPath);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.erase(key) > 0) {
+        modified = true;
+    }
+}
+
+std::vector<std::string> OutputManifest::getOutputs(const std::string &specPath) {
+    std::string key = keyOf(specPath);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return {};
+    }
+    return it->second.outputs;
+}
+
+bool OutputManifest::statFile(const std::string &filePath, Entry &entry) {
+    struct stat info{};
+    if (stat(filePath.c_str(), &info) != 0) {
+        return false;
+    }
+    entry.size = (uint64_t) info.st_size;
+    entry.mtime = (int64_t) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+}
+
+std::string OutputManifest::keyOf(const std::string &specPath) {
+    return boost::filesystem::absolute(specPath).lexically_normal().string();
+}
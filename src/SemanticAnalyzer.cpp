@@ -0,0 +1,120 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SemanticAnalyzer.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <unordered_map>
+
+namespace {
+    // Refs are between 1 and 63, 0 means the option has no Ref
+    const std::size_t refCount = 64;
+    const std::size_t none = static_cast<std::size_t>(-1);
+}
+
+SemanticAnalyzer::SemanticAnalyzer(const GetOptSetup &getOptSetup) : getOptSetup(getOptSetup) {
+}
+
+void SemanticAnalyzer::analyze() {
+    LOG_TRACE("Analyzing spec");
+    const std::vector<Option> &options = getOptSetup.getOptions();
+    errors.clear();
+    exclusionTargets.assign(options.size(), std::vector<std::size_t>());
+
+    std::vector<std::size_t> refs(refCount, none);
+    std::vector<std::size_t> shortOpts(256, none);
+    std::unordered_map<std::string, std::size_t> longOpts;
+    longOpts.reserve(options.size());
+
+    for (std::size_t i = 0; i < options.size(); i++) {
+        const Option &option = options[i];
+
+        if (option.getRef() != 0) {
+            std::size_t &first = refs[option.getRef() % refCount];
+            if (first != none) {
+                error("Ref " + std::to_string(option.getRef()) + " is used by " + describe(options[first])
+                      + " (option " + std::to_string(first + 1) + ") and " + describe(option)
+                      + " (option " + std::to_string(i + 1) + ")");
+            } else {
+                first = i;
+            }
+        }
+
+        if (option.getShortOpt() != '\0') {
+            std::size_t &first = shortOpts[(unsigned char) option.getShortOpt()];
+            if (first != none) {
+                error(std::string("ShortOpt ") + option.getShortOpt() + " is used by option "
+                      + std::to_string(first + 1) + " and option " + std::to_string(i + 1));
+            } else {
+                first = i;
+            }
+        }
+
+        if (!option.getLongOpt().empty()) {
+            auto inserted = longOpts.emplace(option.getLongOpt(), i);
+            if (!inserted.second) {
+                error("LongOpt " + option.getLongOpt() + " is used by option "
+                      + std::to_string(inserted.first->second + 1) + " and option " + std::to_string(i + 1));
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < options.size(); i++) {
+        const Option &option = options[i];
+        std::vector<std::size_t> &targets = exclusionTargets[i];
+        targets.reserve(option.getExclusions().size());
+
+        for (int exclusion: option.getExclusions()) {
+            std::size_t target = exclusion > 0 && exclusion < (int) refCount ? refs[exclusion] : none;
+            if (target == none) {
+                error(describe(option) + " excludes Ref " + std::to_string(exclusion) + ", which no option has");
+            } else if (target == i) {
+                error(describe(option) + " excludes itself");
+            } else {
+                targets.push_back(target);
+            }
+        }
+    }
+
+    // Logged by the SymbolTable already
+    symbols.resolveOptionValues(options);
+    errors.insert(errors.end(), symbols.getErrors().begin(), symbols.getErrors().end());
+
+    if (!errors.empty()) {
+        std::string message = "Spec has " + std::to_string(errors.size())
+                              + (errors.size() == 1 ? " error:" : " errors:");
+        for (auto &text: errors) {
+            message += "\n  " + text;
+        }
+        throw GeneratorException(message);
+    }
+    LOG_TRACE("Finished analyzing spec");
+}
+
+const std::vector<std::size_t> &SemanticAnalyzer::getExclusionTargets(std::size_t index) const {
+    return exclusionTargets[index];
+}
+
+const std::vector<std::string> &SemanticAnalyzer::getErrors() const {
+    return errors;
+}
+
+SymbolTable &SemanticAnalyzer::getSymbols() {
+    return symbols;
+}
+
+std::string SemanticAnalyzer::describe(const Option &option) {
+    if (!option.getLongOpt().empty()) {
+        return "--" + option.getLongOpt();
+    }
+    if (option.getShortOpt() != '\0') {
+        return std::string("-") + option.getShortOpt();
+    }
+    return option.getInterface();
+}
+
+void SemanticAnalyzer::error(const std::string &message) {
+    LOG_ERROR(message);
+    errors.push_back(message);
+}
@@ -0,0 +1,117 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "ServerProtocol.h"
+#include "BinaryStream.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Most file descriptors a request can carry
+ */
+static const std::size_t maxFds = 4;
+
+bool ServerProtocol::sendRequest(int socket, Kind kind, const std::string &payload, const std::vector<int> &fds) {
+    BinaryWriter header;
+    header.writeU32(kind);
+    header.writeU32((uint32_t) payload.size());
+
+    struct iovec part = {const_cast<char *>(header.getBuffer().data()), header.getBuffer().size()};
+    struct msghdr message = {};
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    char control[CMSG_SPACE(maxFds * sizeof(int))] = {};
+    if (!fds.empty() && fds.size() <= maxFds) {
+        message.msg_control = control;
+        message.msg_controllen = CMSG_SPACE(fds.size() * sizeof(int));
+        struct cmsghdr *rights = CMSG_FIRSTHDR(&message);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(fds.size() * sizeof(int));
+        memcpy(CMSG_DATA(rights), fds.data(), fds.size() * sizeof(int));
+    }
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        return false;
+    }
+    // The descriptors went with the first byte, the rest of the header is plain data
+    return writeFully(socket, header.getBuffer().data() + sent, header.getBuffer().size() - sent)
+           && writeFully(socket, payload.data(), payload.size());
+}
+
+bool ServerProtocol::receiveRequest(int socket, uint32_t &kind, std::string &payload, std::vector<int> &fds) {
+    char header[8];
+    struct iovec part = {header, sizeof(header)};
+    struct msghdr message = {};
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    char control[CMSG_SPACE(maxFds * sizeof(int))];
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t received;
+    do {
+        received = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) {
+        return false;
+    }
+    for (struct cmsghdr *rights = CMSG_FIRSTHDR(&message); rights != nullptr;
+         rights = CMSG_NXTHDR(&message, rights)) {
+        if (rights->cmsg_level == SOL_SOCKET && rights->cmsg_type == SCM_RIGHTS) {
+            std::size_t count = (rights->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            std::size_t offset = fds.size();
+            fds.resize(offset + count);
+            memcpy(fds.data() + offset, CMSG_DATA(rights), count * sizeof(int));
+        }
+    }
+    if (!readFully(socket, header + received, sizeof(header) - received)) {
+        return false;
+    }
+
+    BinaryReader reader(header, sizeof(header));
+    kind = reader.readU32();
+    uint32_t size = reader.readU32();
+    if (size > maxPayload) {
+        return false;
+    }
+    payload.resize(size);
+    return readFully(socket, &payload[0], size);
+}
+
+bool ServerProtocol::writeFully(int fd, const void *data, std::size_t size) {
+    auto bytes = (const char *) data;
+    while (size > 0) {
+        ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= (std::size_t) written;
+    }
+    return true;
+}
+
+bool ServerProtocol::readFully(int fd, void *data, std::size_t size) {
+    auto bytes = (char *) data;
+    while (size > 0) {
+        ssize_t read = ::read(fd, bytes, size);
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            return false;
+        }
+        bytes += read;
+        size -= (std::size_t) read;
+    }
+    return true;
+}
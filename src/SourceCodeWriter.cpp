@@ -3,24 +3,29 @@
  */
 
 #include "SourceCodeWriter.h"
+#include "CodeFormatter.h"
+#include "GeneratorException.h"
 #include "Logger.h"
 #include "HelpText.h"
+#include "TaskPool.h"
 #include <boost/algorithm/string.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Included by every generated header, listed once at the top of an amalgamated source
+static const char *const commonIncludes[] = {"getopt.h", "iostream", "boost/lexical_cast.hpp"};
 
 // Constructor
-SourceCodeWriter::SourceCodeWriter(GetOptSetup *getOptSetup) {
-    if (getOptSetup->getSourceFileName().empty() || getOptSetup->getHeaderFileName().empty()) {
-        LOG_ERROR("No source or header file name given.");
-        perror("Both the Header-Filename and the Sourcefilename must be set.");
-        exit(1);
-    }
-
-    if (getOptSetup->getClassName().empty()) {
-        LOG_ERROR("No class name given.");
-        perror("The Class-Name must be set. ");
-        exit(1);
-    }
-    this->getOptSetup = getOptSetup;
+SourceCodeWriter::SourceCodeWriter(const GetOptSetup *getOptSetup, SemanticAnalyzer &analyzer)
+        : getOptSetup(getOptSetup), symbols(analyzer.getSymbols()), analyzer(analyzer),
+          optionSource(&getOptSetup->getOptions()), templates(&TemplateSet::get("")) {
 }
 
 SourceCodeWriter::~SourceCodeWriter() {
@@ -30,24 +35,36 @@ SourceCodeWriter::~SourceCodeWriter() {
     if (this->sourceFile != nullptr) {
         fclose(this->sourceFile);
     }
+    free(headerBuffer);
+    free(sourceBuffer);
 }
 
 // Getter
 FILE *SourceCodeWriter::getHeaderFile() {
-    LOG_DEBUG("Getting Header-File: " + (getOutputDir() + getGetOptSetup()->getHeaderFileName()));
+    // Called for every fprintf, so the open stream is returned without any further work
+    if (headerFile != nullptr) {
+        return headerFile;
+    }
+    LOG_DEBUG("Opening Header-File buffer for " + getHeaderFilePath());
+    setHeaderFile(open_memstream(&headerBuffer, &headerBufferSize));
     if (headerFile == nullptr) {
-        setHeaderFile(fopen((getOutputDir() + getGetOptSetup()->getHeaderFileName()).c_str(), "w"));
+        LOG_ERROR("Could not open Header-File buffer for " + getHeaderFilePath());
+        throw GeneratorException("Could not open " + getHeaderFilePath());
     }
-    LOG_TRACE("Finished getting Header-File");
     return headerFile;
 }
 
 FILE *SourceCodeWriter::getSourceFile() {
-    LOG_DEBUG("Getting Source-File: " + (getOutputDir() + getGetOptSetup()->getSourceFileName()));
+    // Called for every fprintf, so the open stream is returned without any further work
+    if (sourceFile != nullptr) {
+        return sourceFile;
+    }
+    LOG_DEBUG("Opening Source-File buffer for " + getSourceFilePath());
+    setSourceFile(open_memstream(&sourceBuffer, &sourceBufferSize));
     if (sourceFile == nullptr) {
-        setSourceFile(fopen((getOutputDir() + getGetOptSetup()->getSourceFileName()).c_str(), "w"));
+        LOG_ERROR("Could not open Source-File buffer for " + getSourceFilePath());
+        throw GeneratorException("Could not open " + getSourceFilePath());
     }
-    LOG_TRACE("Finished getting Source-File");
     return sourceFile;
 }
 
@@ -55,534 +72,584 @@ std::string SourceCodeWriter::getOutputDir() {
     return outputDir;
 }
 
-GetOptSetup *SourceCodeWriter::getGetOptSetup() const {
-    return getOptSetup;
+std::string SourceCodeWriter::getHeaderFilePath() const {
+    return outputDir + getGetOptSetup()->getHeaderFileName();
 }
 
-// Setter
-void SourceCodeWriter::setHeaderFile(FILE *_headerFile) {
-    this->headerFile = _headerFile;
+std::string SourceCodeWriter::getSourceFilePath() const {
+    return outputDir + getGetOptSetup()->getSourceFileName();
 }
 
-void SourceCodeWriter::setSourceFile(FILE *_sourceFile) {
-    this->sourceFile = _sourceFile;
+std::string SourceCodeWriter::getShardFilePath(unsigned int shard) const {
+    const std::string &name = getGetOptSetup()->getSourceFileName();
+    std::size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+        return outputDir + name + "_" + std::to_string(shard);
+    }
+    return outputDir + name.substr(0, dot) + "_" + std::to_string(shard) + name.substr(dot);
 }
 
-void SourceCodeWriter::setOutputDir(const std::string &dir) {
-    outputDir = dir;
+std::string SourceCodeWriter::getHelpFilePath() const {
+    const std::string &name = getGetOptSetup()->getSourceFileName();
+    std::size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+        return outputDir + name + "_help";
+    }
+    return outputDir + name.substr(0, dot) + "_help" + name.substr(dot);
 }
 
-/*
- * ALL HELPER FUNCTIONS HERE!!!
- */
+std::string SourceCodeWriter::getShardListPath() const {
+    const std::string &name = getGetOptSetup()->getSourceFileName();
+    return outputDir + name.substr(0, name.rfind('.')) + ".sources";
+}
 
-/**
- * @brief get string of the type of the option
- * @param option a single option object
- * @return string with correct value type
- */
-string SourceCodeWriter::getValueTypeByOption(Option &option) {
-    switch (option.getConvertTo()) {
-        case ConvertToOptions::STRING:
-            return "std::string";
-        case ConvertToOptions::INTEGER:
-            return "int";
-        case ConvertToOptions::BOOLEAN:
-            return "bool";
-        default:
-            return "";
+std::vector<std::string> SourceCodeWriter::getOutputFilePaths() const {
+    std::vector<std::string> paths = {getHeaderFilePath(), getSourceFilePath()};
+    if (isSharded()) {
+        for (unsigned int shard = 0; shard < shards; shard++) {
+            paths.push_back(getShardFilePath(shard));
+        }
+        paths.push_back(getHelpFilePath());
+        paths.push_back(getShardListPath());
     }
+    return paths;
 }
 
-//from here on are all the headerFiles
-void SourceCodeWriter::headerFileIncludes() {
-    LOG_TRACE("Writing includes to Header-File");
-    // Define static and always used includes here
-    string includes[] = {"getopt.h", "iostream", "boost/lexical_cast.hpp"};
+unsigned int SourceCodeWriter::getShards() const {
+    return shards;
+}
 
-    string defineString = getGetOptSetup()->getHeaderFileName()
-            .substr(0, getGetOptSetup()->getHeaderFileName().find('.'));
-    boost::to_upper(defineString);
-    fprintf(getHeaderFile(), "#ifndef %s_H\n#define %s_H\n\n", defineString.c_str(), defineString.c_str());
-    for (auto &include: includes) {
-        fprintf(getHeaderFile(), "#include <%s>\n", include.c_str());
-    }
+bool SourceCodeWriter::isSharded() const {
+    return shards > 1;
+}
 
-    fprintf(getHeaderFile(), "\n");
+int SourceCodeWriter::getChangedFiles() const {
+    return changedFiles;
+}
 
-    //Here further generation-Methods
-    //struct method missing
-    headerFileNamespace();
+bool SourceCodeWriter::isInMemory() const {
+    return inMemory;
+}
 
-    // Close header file
-    fprintf(getHeaderFile(), "\n#endif //%s_H", defineString.c_str());
-    LOG_TRACE("Finished writing includes to Header-File");
+const std::vector<GeneratedFile> &SourceCodeWriter::getGeneratedFiles() const {
+    return generatedFiles;
 }
 
-void SourceCodeWriter::headerFileNamespace() {
-    LOG_TRACE("Writing namespace to Header-File");
-    //start of namespace
-    if (!getGetOptSetup()->getNamespaceName().empty()) {
-        fprintf(getHeaderFile(), "namespace %s {\n\n", getGetOptSetup()->getNamespaceName().c_str());
-    }
+const GetOptSetup *SourceCodeWriter::getGetOptSetup() const {
+    return getOptSetup;
+}
 
-    //put all elements inside namespace here
-    createHeaderStructArgs();
-    headerFileClass();
+// Setter
+void SourceCodeWriter::setHeaderFile(FILE *_headerFile) {
+    this->headerFile = _headerFile;
+}
 
-    //end of namespace
-    if (!getGetOptSetup()->getNamespaceName().empty()) {
-        fprintf(getHeaderFile(), "}\n");
-    }
-    LOG_TRACE("Finished writing namespace to Header-File");
+void SourceCodeWriter::setSourceFile(FILE *_sourceFile) {
+    this->sourceFile = _sourceFile;
 }
 
-void SourceCodeWriter::headerFileClass() {
-    LOG_TRACE("Writing class to Header-File");
-    //start of class
-    fprintf(getHeaderFile(), "class %s {\n", getGetOptSetup()->getClassName().c_str());
+void SourceCodeWriter::setOutputDir(const std::string &dir) {
+    outputDir = dir;
+}
 
-    fprintf(getHeaderFile(), "private:\n");
-    //put all elements inside class -> private here
-    fprintf(getHeaderFile(), "Args args;\n");
+void SourceCodeWriter::setShards(unsigned int _shards) {
+    shards = _shards;
+}
 
-    // Values for the options
-    for (Option option: getGetOptSetup()->getOptions()) {
-        if (option.isHasArguments() != HasArguments::NONE) {
-            fprintf(getHeaderFile(), "%s %sValue", getValueTypeByOption(option).c_str(),
-                    determineArgsName(option).c_str());
-            if (option.isHasArguments() == HasArguments::OPTIONAL && !option.getDefaultValue().empty()) {
-                switch (option.getConvertTo()) {
-                    case ConvertToOptions::STRING:
-                        fprintf(getHeaderFile(), " = \"%s\"", option.getDefaultValue().c_str());
-                        break;
-                    case ConvertToOptions::INTEGER:
-                    case ConvertToOptions::BOOLEAN:
-                        fprintf(getHeaderFile(), " = %s", option.getDefaultValue().c_str());
-                        break;
-                    default:
-                        break;
-                }
-            }
-            fprintf(getHeaderFile(), ";\n");
-        }
-    }
+void SourceCodeWriter::setEmitJobs(unsigned int jobs) {
+    emitJobs = jobs == 0 ? std::thread::hardware_concurrency() : jobs;
+}
 
-    createHeaderPrintVersion();
-    fprintf(getHeaderFile(), "\n");
-    fprintf(getHeaderFile(), "protected:\n");
-    //put all elements inside class -> protected here
-    createHeaderPrintHelp();
-
-    fprintf(getHeaderFile(), "\n");
-    fprintf(getHeaderFile(), "public:\n");
-    //put all elements inside class -> public here
-    fprintf(getHeaderFile(), "void parse();\n");
-    createHeaderGetter();
-    createExternalFunctions();
-    createHeaderParsingFunction();
-    createHeaderUnknownOption();
-
-    //end of class
-    fprintf(getHeaderFile(), "};\n");
-    LOG_TRACE("Finished writing class to Header-File");
-}
-
-void SourceCodeWriter::createHeaderStructArgs() {
-    LOG_TRACE("Writing struct Args to Header-File");
-    fprintf(getHeaderFile(), "struct Args {\n");
-    for (auto &option: getGetOptSetup()->getOptions()) {
-        fprintf(getHeaderFile(), "struct {\n");
-        fprintf(getHeaderFile(), "bool isSet = false;\n");
-        if (option.isHasArguments() != HasArguments::NONE) {
-            fprintf(getHeaderFile(), "std::string value;\n");
-        }
-        fprintf(getHeaderFile(), "} %s;\n", determineArgsName(option).c_str());
-    }
-    fprintf(getHeaderFile(), "};\n\n");
-    LOG_TRACE("Finished writing struct Args to Header-File");
+void SourceCodeWriter::setTemplates(const TemplateSet &_templates) {
+    templates = &_templates;
 }
 
-//from here on are all the sourceFiles
-void SourceCodeWriter::sourceFileIncludes() {
-    LOG_TRACE("Writing includes to Source-File");
-    fprintf(getSourceFile(), "#include \"%s\"\n\n", getGetOptSetup()->getHeaderFileName().c_str());
+void SourceCodeWriter::setInMemory(bool _inMemory) {
+    inMemory = _inMemory;
+}
 
-    //Here further generation-Methods
+/*
+ * ALL HELPER FUNCTIONS HERE!!!
+ */
 
-    // Close source file includes
-    fprintf(getSourceFile(), "\n");
-    LOG_TRACE("Finished writing includes to Source-File");
+bool SourceCodeWriter::commitFile(FILE *&file, char *&buffer, size_t &bufferSize, const std::string &path) {
+    if (file == nullptr) {
+        return false;
+    }
+    // Closing the memory stream finalizes buffer and bufferSize
+    fclose(file);
+    file = nullptr;
+    std::string formatted = CodeFormatter::format(buffer, bufferSize);
+    return storeFile(path, formatted.data(), formatted.size());
 }
 
-void SourceCodeWriter::sourceFileNamespace() {
-    LOG_TRACE("Writing namespace to Source-File");
-    //start of namespace
-    if (!getGetOptSetup()->getNamespaceName().empty()) {
-        fprintf(getSourceFile(), "namespace %s {\n\n", getGetOptSetup()->getNamespaceName().c_str());
+bool SourceCodeWriter::storeFile(const std::string &path, const char *buffer, size_t bufferSize) {
+    if (inMemory) {
+        generatedFiles.push_back({path, std::string(buffer, bufferSize)});
+        return true;
     }
-    createSourceGetter();
-    createSourcePrintVersion();
-    //put all elements inside namespace here
-    sourceFileParse();
-    createSourceParsingFunction();
-    createSourceUnknownOption();
+    return writeIfChanged(buffer, bufferSize, path);
+}
 
-    //Hier kommt der Help-Text dazu
-    createSourcePrintHelp();
+bool SourceCodeWriter::writeIfChanged(const char *buffer, size_t bufferSize, const std::string &path) {
+    // Compare with the existing file, an identical file is left untouched
+    FILE *existing = fopen(path.c_str(), "rb");
+    if (existing != nullptr) {
+        bool identical = true;
+        char chunk[65536];
+        size_t offset = 0;
+        size_t read;
+        while (identical && (read = fread(chunk, 1, sizeof(chunk), existing)) > 0) {
+            identical = offset + read <= bufferSize && memcmp(chunk, buffer + offset, read) == 0;
+            offset += read;
+        }
+        fclose(existing);
+        if (identical && offset == bufferSize) {
+            LOG_DEBUG("Unchanged, not writing " + path);
+            return false;
+        }
+    }
 
-    //end of namespace
-    if (!getGetOptSetup()->getNamespaceName().empty()) {
-        fprintf(getSourceFile(), "}\n");
+    // The content goes to a temporary file next to the output, which is then renamed over it.
+    // Readers see either the old or the new file, never a partially written one.
+    static std::atomic<unsigned int> tempCounter{0};
+    std::string tempPath = path + ".tmp" + std::to_string(getpid()) + "." + std::to_string(tempCounter++);
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        LOG_ERROR("Could not open " + tempPath + ": " + strerror(errno));
+        throw GeneratorException("Could not open " + path);
+    }
+    size_t offset = 0;
+    while (offset < bufferSize) {
+        ssize_t written = write(fd, buffer + offset, bufferSize - offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            break;
+        }
+        offset += (size_t) written;
+    }
+    if (close(fd) != 0 || offset != bufferSize || rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Could not write " + path + ": " + strerror(errno));
+        unlink(tempPath.c_str());
+        throw GeneratorException("Could not write " + path);
     }
-    LOG_TRACE("Finished writing namespace to Source-File");
+    LOG_DEBUG("Wrote " + path);
+    return true;
 }
 
-void SourceCodeWriter::createHeaderParsingFunction() {
-    LOG_TRACE("Writing parsing function to Header-File");
-    fprintf(getHeaderFile(), "void parseOptions(int argc, char **argv);\n");
-    LOG_TRACE("Finished writing parsing function to Header-File");
-}
+// Templates
+class SourceCodeWriter::RenderContext : public TemplateContext {
+public:
+    /**
+     * @brief Constructor
+     * @param writer the writer whose spec and fragments are rendered
+     * @param className ClassName of the spec
+     * @param shardFile true if the blocks only hold the options of a shard
+     * @param shard the shard
+     */
+    RenderContext(SourceCodeWriter &writer, const std::string &className, bool shardFile = false,
+                  unsigned int shard = 0)
+            : writer(writer), className(className), shardFile(shardFile), shard(shard) {
+    }
 
-void SourceCodeWriter::sourceFileParse() {
-    LOG_TRACE("Writing parsing function to Source-File");
-    fprintf(getSourceFile(), "void %s::parse() {\n", getGetOptSetup()->getClassName().c_str());
-    for (auto &option: getGetOptSetup()->getOptions()) {
-        std::string optionName = determineArgsName(option);
-        fprintf(getSourceFile(), "if (args.%s.isSet) {\n", optionName.c_str());
+    /**
+     * @brief Selects the option an option template is rendered for
+     * @param index index of the option
+     */
+    void setOption(std::size_t index) {
+        optionIndex = index;
+        option = &(*writer.optionSource)[index];
+        symbol = &writer.symbols.getSymbol(index);
+    }
 
-        // exclusions
-        if (!option.getExclusions().empty()) {
-            for (auto &exclusion: option.getExclusions()) {
-                // Iterate over options again and compare exclusion with ref
-                for (auto &option2: getGetOptSetup()->getOptions()) {
-                    std::string option2Name = determineArgsName(option2);
-                    if (option2.getRef() == exclusion) {
-                        fprintf(getSourceFile(), "if (args.%s.isSet) {\n", option2Name.c_str());
-                        fprintf(getSourceFile(), "perror(\"%s and %s cannot be used together.\");\n",
-                                optionName.c_str(), option2Name.c_str());
-                        fprintf(getSourceFile(), "exit(1);\n");
-                        fprintf(getSourceFile(), "}\n");
-                    }
+    void writeValue(FILE *out, int name) override {
+        std::string value = getValue(name);
+        fwrite(value.data(), 1, value.size(), out);
+    }
+
+    std::size_t getCount(int name) override {
+        switch (name) {
+            case TemplateSet::SHARDED:
+                return writer.isSharded();
+            case TemplateSet::SHARDS:
+                return writer.isSharded() ? writer.shards : 0;
+            case TemplateSet::FIRST:
+                return item == 0;
+            case TemplateSet::MESSAGES:
+                return writer.ir.getMessages().size();
+            case TemplateSet::CONVERSION_TYPES:
+                return writer.ir.getConversionTypes().size();
+            case TemplateSet::USES_MISSING_ARGUMENT:
+                return writer.ir.uses(ClassIR::MISSING_ARGUMENT);
+            case TemplateSet::USES_UNEXPECTED_ARGUMENT:
+                return writer.ir.uses(ClassIR::UNEXPECTED_ARGUMENT);
+            case TemplateSet::USES_CONFLICTING_OPTIONS:
+                return writer.ir.uses(ClassIR::CONFLICTING_OPTIONS);
+            case TemplateSet::USES_BOOLEAN_VALUE:
+                return writer.ir.uses(ClassIR::BOOLEAN_VALUE);
+            case TemplateSet::EXCLUDED:
+                return option->getExclusions().empty() ? 0 : writer.analyzer.getExclusionTargets(optionIndex).size();
+            case TemplateSet::HAS_ARGUMENT:
+                return option->isHasArguments() != HasArguments::NONE;
+            case TemplateSet::REQUIRED_ARGUMENT:
+                return option->isHasArguments() == HasArguments::REQUIRED;
+            case TemplateSet::OPTIONAL_ARGUMENT:
+                return option->isHasArguments() == HasArguments::OPTIONAL;
+            case TemplateSet::BOOLEAN:
+                return option->getConvertTo() == ConvertToOptions::BOOLEAN;
+            case TemplateSet::HAS_DEFAULT:
+                return option->isHasArguments() == HasArguments::OPTIONAL && !getValue(TemplateSet::DEFAULT_VALUE).empty();
+            case TemplateSet::HAS_GETTER:
+                return !option->getInterface().empty()
+                       || (option->getConnectToInternalMethod().empty() && option->getConnectToExternalMethod().empty());
+            case TemplateSet::HAS_VALUE_GETTER:
+                return !option->getInterface().empty() && option->isHasArguments() != HasArguments::NONE;
+            case TemplateSet::HAS_INTERNAL_METHOD:
+                return !option->getConnectToInternalMethod().empty();
+            case TemplateSet::HAS_EXTERNAL_METHOD:
+                return !option->getConnectToExternalMethod().empty();
+            case TemplateSet::HAS_LONG_OPT:
+                return !option->getLongOpt().empty();
+            case TemplateSet::REACHABLE:
+                // An option without ShortOpt and LongOpt can not be passed on the command line
+                return !symbol->optionValue.empty();
+            case TemplateSet::HANDLED:
+                return writer.ir.getOption(optionIndex).handled;
+            case TemplateSet::CHECKED:
+                return writer.ir.getOption(optionIndex).checked;
+            default:
+                if (name >= TemplateSet::STRUCT_ARGS_CODE && name <= TemplateSet::HELP_CODE) {
+                    return 1;
                 }
-            }
-        }
-        fprintf(getSourceFile(), "}\n");
-    }
-
-    for (Option option: getGetOptSetup()->getOptions()) {
-        std::string optionName = determineArgsName(option);
-        fprintf(getSourceFile(), "if (args.%s.isSet) {\n", optionName.c_str());
-
-        //Handle option
-        if (option.isHasArguments() != HasArguments::NONE) {
-            fprintf(getSourceFile(), "if (!args.%s.value.empty()) {\n", optionName.c_str());
-            //TODO This might not work this way, check back later
-            fprintf(getSourceFile(), "try {\n");
-            fprintf(getSourceFile(), "%sValue = boost::lexical_cast<typeof %sValue>(args.%s.value);\n",
-                    optionName.c_str(), optionName.c_str(), optionName.c_str());
-            fprintf(getSourceFile(), "} catch (boost::bad_lexical_cast &) {\n");
-            fprintf(getSourceFile(), "perror(\"%s is not convertible to %s.\");\n}\n", optionName.c_str(),
-                    getValueTypeByOption(option).c_str());
-            fprintf(getSourceFile(), "}\n");
+                return getValue(name).empty() ? 0 : 1;
         }
+    }
 
-        if (!option.getConnectToInternalMethod().empty()) {
-            fprintf(getSourceFile(), "%s(", option.getConnectToInternalMethod().c_str());
-            if (option.isHasArguments() != HasArguments::NONE) {
-                fprintf(getSourceFile(), "%sValue", optionName.c_str());
-            }
-            fprintf(getSourceFile(), ");\n");
+    void selectItem(int name, std::size_t _item) override {
+        if (name == TemplateSet::SHARDS) {
+            shard = (unsigned int) _item;
+            item = _item;
+        } else if (name == TemplateSet::EXCLUDED || name == TemplateSet::MESSAGES
+                   || name == TemplateSet::CONVERSION_TYPES) {
+            item = _item;
         }
+    }
 
-        if (!option.getConnectToExternalMethod().empty()) {
-            fprintf(getSourceFile(), "%s(", option.getConnectToExternalMethod().c_str());
-            if (option.isHasArguments() != HasArguments::NONE) {
-                fprintf(getSourceFile(), "%sValue", optionName.c_str());
-            }
-            fprintf(getSourceFile(), ");\n");
-        }
-        fprintf(getSourceFile(), "}\n");
-    }
-    fprintf(getSourceFile(), "}\n");
-    LOG_TRACE("Finished writing parsing function to Source-File");
-}
-
-void SourceCodeWriter::createSourceParsingFunction() {
-    LOG_TRACE("Writing parsing function to Source-File");
-    vector<Option> options = getGetOptSetup()->getOptions();
-    fprintf(getSourceFile(), "void %s::parseOptions(int argc, char **argv){\nargs = Args();\n"
-                             "opterr = 0;\nint opt;\nstatic struct option long_options[] = {\n",
-            getGetOptSetup()->getClassName().c_str());
-
-    int longOptsWithoutShortOpt = 0;
-
-    for (auto &option: options) {
-        if (!option.getLongOpt().empty()) {
-            fprintf(getSourceFile(), "{\"%s\", ", option.getLongOpt().c_str());
-            switch (option.isHasArguments()) {
-                case HasArguments::OPTIONAL:
-                    fprintf(getSourceFile(), "optional_argument, ");
-                    break;
-                case HasArguments::REQUIRED:
-                    fprintf(getSourceFile(), "required_argument, ");
-                    break;
-                default:
-                    fprintf(getSourceFile(), "no_argument, ");
-                    break;
-            }
-            if (option.getShortOpt() == '\0')
-                fprintf(getSourceFile(), "0, %i},\n", longOptsWithoutShortOpt++);
-            else
-                fprintf(getSourceFile(), "0, '%c'},\n", option.getShortOpt());
+    void writePartial(FILE *out, int name) override {
+        auto fragment = (Fragment) (name - TemplateSet::STRUCT_ARGS_CODE);
+        if (shardFile && fragment != HELP) {
+            std::size_t optionCount = writer.getGetOptSetup()->getOptions().size();
+            writer.writeFragmentRange(out, fragment, optionCount * shard / writer.shards,
+                                      optionCount * (shard + 1) / writer.shards);
+        } else {
+            writer.fragments[fragment].writeTo(out);
         }
     }
-    longOptsWithoutShortOpt = 0;
-
-    fprintf(getSourceFile(), "{0, 0, 0, 0}\n};\nint option_index = 0;\n\n");
-
-    string shortOpts;
-    for (auto &option: options) {
-        if (option.getShortOpt() != '\0') {
-            shortOpts.append(1, option.getShortOpt());
-            switch (option.isHasArguments()) {
-                case HasArguments::OPTIONAL:
-                    shortOpts.append("::");
-                    break;
-                case HasArguments::REQUIRED:
-                    shortOpts.append(":");
-                    break;
-                default:
-                    break;
+
+private:
+    SourceCodeWriter &writer;
+    const std::string &className;
+    bool shardFile;
+    unsigned int shard;
+    std::size_t item = 0;
+    std::size_t optionIndex = 0;
+    const Option *option = nullptr;
+    const OptionSymbol *symbol = nullptr;
+
+    /**
+     * @brief Get the value of a name
+     * @param name the name
+     * @return
+     */
+    std::string getValue(int name) const {
+        const GetOptSetup *getOptSetup = writer.getGetOptSetup();
+        switch (name) {
+            case TemplateSet::HEADER_GUARD: {
+                std::string guard = getOptSetup->getHeaderFileName().substr(
+                        0, getOptSetup->getHeaderFileName().find('.'));
+                boost::to_upper(guard);
+                return guard;
+            }
+            case TemplateSet::SHORT_OPTS: {
+                string shortOpts;
+                for (auto &each: getOptSetup->getOptions()) {
+                    if (each.getShortOpt() != '\0') {
+                        shortOpts.append(1, each.getShortOpt());
+                        if (each.isHasArguments() == HasArguments::OPTIONAL) {
+                            shortOpts.append("::");
+                        } else if (each.isHasArguments() == HasArguments::REQUIRED) {
+                            shortOpts.append(":");
+                        }
+                    }
+                }
+                return shortOpts;
             }
+            case TemplateSet::SHARD:
+                return std::to_string(shard);
+            case TemplateSet::CLASS_NAME:
+                return className;
+            case TemplateSet::NAMESPACE:
+                return getOptSetup->getNamespaceName();
+            case TemplateSet::HEADER_FILE_NAME:
+                return getOptSetup->getHeaderFileName();
+            case TemplateSet::ARGS_NAME:
+                return symbol->argsName;
+            case TemplateSet::CAPITALIZED_NAME:
+                return symbol->capitalizedName;
+            case TemplateSet::VALUE_TYPE:
+                return symbol->valueType;
+            case TemplateSet::OPTION_VALUE:
+                return symbol->optionValue;
+            case TemplateSet::LONG_OPT:
+                return option->getLongOpt();
+            case TemplateSet::ARGUMENT_KIND:
+                switch (option->isHasArguments()) {
+                    case HasArguments::OPTIONAL:
+                        return "optional_argument";
+                    case HasArguments::REQUIRED:
+                        return "required_argument";
+                    default:
+                        return "no_argument";
+                }
+            case TemplateSet::OPTION_FLAGS:
+                return ClassIR::describeFlags(*option);
+            case TemplateSet::DEFAULT_VALUE:
+                if (option->getDefaultValue().empty()) {
+                    return "";
+                }
+                switch (option->getConvertTo()) {
+                    case ConvertToOptions::STRING:
+                        return "\"" + option->getDefaultValue() + "\"";
+                    case ConvertToOptions::INTEGER:
+                    case ConvertToOptions::BOOLEAN:
+                        return option->getDefaultValue();
+                    default:
+                        return "";
+                }
+            case TemplateSet::INTERNAL_METHOD:
+                return option->getConnectToInternalMethod();
+            case TemplateSet::EXTERNAL_METHOD:
+                return option->getConnectToExternalMethod();
+            case TemplateSet::EXCLUDED_NAME:
+                return writer.symbols.getSymbol(writer.analyzer.getExclusionTargets(optionIndex)[item]).argsName;
+            case TemplateSet::MESSAGE:
+                return writer.ir.getMessages()[item];
+            case TemplateSet::CONVERSION_TYPE:
+                return writer.ir.getConversionTypes()[item];
+            case TemplateSet::FLAGS_MESSAGE:
+                return std::to_string(writer.ir.getOption(optionIndex).flagsMessage);
+            case TemplateSet::NAME_MESSAGE:
+                return std::to_string(writer.ir.getOption(optionIndex).nameMessage);
+            case TemplateSet::EXCLUDED_MESSAGE:
+                return std::to_string(
+                        writer.ir.getOption(writer.analyzer.getExclusionTargets(optionIndex)[item]).nameMessage);
+            default:
+                return "";
         }
     }
+};
 
-    fprintf(getSourceFile(), "while ((opt = getopt_long (argc, argv, \"%s\", long_options,"
-                             " &option_index)) != -1){\n", shortOpts.c_str());
-
-    //Hier switch case open
-    fprintf(getSourceFile(), "switch (opt) {\n");
-    for (auto &option: options) {
-        string bothOpts;
-        if (option.getShortOpt() != '\0') {
-            bothOpts.append(1, option.getShortOpt());
-            if (!option.getLongOpt().empty())
-                bothOpts.append("/");
-        }
-        if (!option.getLongOpt().empty())
-            bothOpts.append(option.getLongOpt());
-
-        if (option.getShortOpt() != '\0')
-            fprintf(getSourceFile(), "case '%c':\n", option.getShortOpt());
-        else
-            fprintf(getSourceFile(), "case %i:\n", longOptsWithoutShortOpt++);
-
-        switch (option.isHasArguments()) {
-            case HasArguments::REQUIRED:
-                fprintf(getSourceFile(), "if(optarg == nullptr){\n"
-                                         "perror(\"There was no argument passed for the option \\\"%s\\\" "
-                                         "which requires one.\");\n"
-                                         "exit(1);\n}\n",
-                        bothOpts.c_str(), determineArgsName(option).c_str());
-                if (option.getConvertTo() == ConvertToOptions::BOOLEAN) {
-                    fprintf(getSourceFile(), "args.%s.value = optarg;\nif(strcmp(optarg, \"true\")"
-                                             ")\nargs.%s.value = \"1\";\n"
-                                             "else if(strcmp(optarg, \"false\"))\nargs.%s.value = \"0\";\n",
-                            determineArgsName(option).c_str(), determineArgsName(option).c_str(),
-                            determineArgsName(option).c_str());
-                } else
-                    fprintf(getSourceFile(), "args.%s.value = optarg;\n",
-                            determineArgsName(option).c_str());
-                break;
-            case HasArguments::OPTIONAL:
-                fprintf(getSourceFile(), "if(optarg != nullptr){\n");
-                if (option.getConvertTo() == ConvertToOptions::BOOLEAN) {
-                    fprintf(getSourceFile(), "args.%s.value = optarg;\nif(strcmp(optarg, \"true\"))"
-                                             "\nargs.%s.value = \"1\";\n"
-                                             "else if(strcmp(optarg, \"false\"))\nargs.%s.value = \"0\";\n}\n",
-                            determineArgsName(option).c_str(), determineArgsName(option).c_str(),
-                            determineArgsName(option).c_str());
-                } else
-                    fprintf(getSourceFile(), "args.%s.value = optarg;\n}\n",
-                            determineArgsName(option).c_str());
-                break;
-            default:
-                fprintf(getSourceFile(), "if(optarg != nullptr){\n"
-                                         "perror(\"There was an argument passed for the option \\\"%s\\\" "
-                                         "which does not accept one.\");\nexit(1);}\n", bothOpts.c_str());
-                break;
+void SourceCodeWriter::emitFragment(Fragment fragment, std::size_t begin, std::size_t end) {
+    FILE *out = fragments[fragment].getFile();
+    if (fragment == HELP) {
+        fprintf(out, "%s", HelpText(getGetOptSetup()).parseHelpMessage().c_str());
+        return;
+    }
+    // The option templates are in the same order as the fragments
+    const Template &optionTemplate = templates->getTemplate(
+            (TemplateSet::Kind) (TemplateSet::STRUCT_ARGS_MEMBER + fragment));
+    RenderContext context(*this, fragmentClassName);
+    for (std::size_t i = begin; i < end; i++) {
+        context.setOption(i);
+        optionTemplate.render(out, context);
+        if (isSharded()) {
+            optionEnds[fragment].push_back((std::size_t) ftell(out));
         }
-
-        fprintf(getSourceFile(), "args.%s.isSet = true;", determineArgsName(option).c_str());
-
-        //Close case
-        fprintf(getSourceFile(), "break;\n");
     }
-
-    //Close switch-case
-    fprintf(getSourceFile(), "case '?':\ndefault:\nunknownOption(std::to_string(optopt));\nbreak;}\n");
-    //Close while loop
-    fprintf(getSourceFile(), "}\n");
-
-    //Print argv-Arguments that were too much
-    fprintf(getSourceFile(), "if (optind < argc){\nprintf(\"non-option ARGV-elements: \");\n"
-                             "while (optind < argc)\nprintf(\"%s \", argv[optind++]);\nprintf(\"\\n\");\n}\n", "%s");
-
-    //Call parse-function
-    fprintf(getSourceFile(), "parse();\n");
-
-    //Close function parseOptions
-    fprintf(getSourceFile(), "}\n");
-    LOG_TRACE("Finished generating parseOptions()");
 }
 
-void SourceCodeWriter::createHeaderUnknownOption() {
-    LOG_TRACE("Generating unknownOption() header");
-    fprintf(getHeaderFile(), "virtual void unknownOption(const std::string &unknownOption);\n\n");
-    LOG_TRACE("Finished generating unknownOption() header");
+void SourceCodeWriter::renderFile(FILE *out, TemplateSet::Kind kind, unsigned int shard) {
+    LOG_TRACE("Rendering " + templates->getTemplate(kind).getName());
+    RenderContext context(*this, getGetOptSetup()->getClassName(), kind == TemplateSet::SHARD_FILE, shard);
+    templates->getTemplate(kind).render(out, context);
 }
 
-void SourceCodeWriter::createSourceUnknownOption() {
-    LOG_TRACE("Generating unknownOption() source");
-    fprintf(getSourceFile(), "void %s::unknownOption(const std::string &unknownOption){\n"
-                             "perror(\"GetOpt encountered an unknown option.\");\n"
-                             "exit(1);\n}\n", getGetOptSetup()->getClassName().c_str());
-    LOG_TRACE("Finished generating unknownOption() source");
+void SourceCodeWriter::emitOptions(const std::string &className, const std::vector<Option> &options) {
+    if (emittedOptions == 0) {
+        fragmentClassName = className;
+    }
+    optionSource = &options;
+    symbols.resolveNames(options);
+    ir.addOptions(options, symbols);
+    for (int fragment = 0; fragment < OPTION_FRAGMENT_COUNT; fragment++) {
+        emitFragment((Fragment) fragment, emittedOptions, options.size());
+    }
+    emittedOptions = options.size();
+    optionSource = &getGetOptSetup()->getOptions();
 }
 
-// Helper functions
-std::string SourceCodeWriter::determineArgsName(const Option &option) {
-    LOG_TRACE("Determining args name for " + option.getLongOpt() + " (" + option.getShortOpt() + ")");
-    std::string argsName;
-    if (!option.getInterface().empty()) {
-        argsName = option.getInterface();
-    } else if (!option.getLongOpt().empty()) {
-        argsName = option.getLongOpt();
-    } else if (!isblank(option.getShortOpt())) {
-        argsName = option.getShortOpt();
+// Shards
+void SourceCodeWriter::writeFragmentRange(FILE *out, Fragment fragment, std::size_t begin, std::size_t end) {
+    if (begin >= end) {
+        return;
     }
+    const std::vector<std::size_t> &ends = optionEnds[fragment];
+    fragments[fragment].writeTo(out, begin == 0 ? 0 : ends[begin - 1], ends[end - 1]);
+}
 
-    argsName[0] = tolower(argsName[0], locale());
+void SourceCodeWriter::writeShards() {
+    std::vector<std::string> sources = {getSourceFilePath()};
 
-    // Removing all invalid characters from the name
-    vector<char> invalidChars = {' ', '-', '.', ':'};
-    for (auto &invalidChar: invalidChars) {
-        while (argsName.find(invalidChar) != std::string::npos) {
-            argsName[argsName.find(invalidChar) + 1] = toupper(argsName[argsName.find(invalidChar) + 1], locale());
-            argsName.erase(argsName.find(invalidChar), 1);
+    for (unsigned int shard = 0; shard <= shards; shard++) {
+        MemoryStream stream;
+        FILE *out = stream.getFile();
+        // The help text is the last translation unit
+        renderFile(out, shard == shards ? TemplateSet::HELP_FILE : TemplateSet::SHARD_FILE, shard);
+
+        std::string path = shard == shards ? getHelpFilePath() : getShardFilePath(shard);
+        std::string formatted = CodeFormatter::format(stream.getData(), stream.getSize());
+        if (storeFile(path, formatted.data(), formatted.size())) {
+            changedFiles++;
         }
+        sources.push_back(path);
     }
 
-    if (argsName.empty()) {
-        LOG_ERROR("Could not determine args name for " + option.getLongOpt() + " (" + option.getShortOpt() + ")");
-        perror("Every option must at least have either an Interface, a LongOpt or a ShortOpt.");
-        exit(1);
+    // One source per line, for build systems that compile the shards in parallel
+    std::string list;
+    for (auto &source: sources) {
+        list.append(source).append("\n");
+    }
+    if (storeFile(getShardListPath(), list.data(), list.size())) {
+        changedFiles++;
     }
-
-    LOG_TRACE("Determined args name for " + option.getLongOpt() + " (" + option.getShortOpt() + ") as " + argsName);
-    return argsName;
 }
 
-void SourceCodeWriter::createHeaderGetter() {
-    LOG_TRACE("Generating getter() header");
-    for (Option option: getGetOptSetup()->getOptions()) {
-        string capitalizedArgsName = determineArgsName(option);
-        capitalizedArgsName[0] = toupper(capitalizedArgsName[0], locale());
-        if (!option.getInterface().empty()) {
-            fprintf(getHeaderFile(), "bool isSet%s() const;\n", capitalizedArgsName.c_str());
-            if (option.isHasArguments() != HasArguments::NONE) {
-                fprintf(getHeaderFile(), "%s getValueOf%s() const;\n",
-                        getValueTypeByOption(option).c_str(), capitalizedArgsName.c_str());
-            }
-        } else if (option.getInterface().empty() && option.getConnectToInternalMethod().empty()
-                   && option.getConnectToExternalMethod().empty()) {
-            fprintf(getHeaderFile(), "bool isSet%s() const;\n", capitalizedArgsName.c_str());
-        }
+void SourceCodeWriter::writeFile() {
+    LOG_INFO("Starting to write source code...");
+//    printf("Writing file...\n");
+    if (getGetOptSetup()->getSourceFileName().empty() || getGetOptSetup()->getHeaderFileName().empty()) {
+        LOG_ERROR("No source or header file name given.");
+        throw GeneratorException("Both the Header-Filename and the Sourcefilename must be set.");
     }
-    LOG_TRACE("Finished generating getter() header");
-}
-
-void SourceCodeWriter::createSourceGetter() {
-    LOG_TRACE("Generating getter() source");
-    for (Option option: getGetOptSetup()->getOptions()) {
-        string capitalizedArgsName = determineArgsName(option);
-        capitalizedArgsName[0] = toupper(capitalizedArgsName[0], locale());
-        if (!option.getInterface().empty()) {
-            fprintf(getSourceFile(), "bool %s::isSet%s() const {\nreturn args.%s.isSet;\n}\n",
-                    getGetOptSetup()->getClassName().c_str(), capitalizedArgsName.c_str(),
-                    determineArgsName(option).c_str());
-            if (option.isHasArguments() != HasArguments::NONE) {
-                fprintf(getSourceFile(), "%s %s::getValueOf%s() const{\nreturn %sValue;\n}\n",
-                        getValueTypeByOption(option).c_str(), getGetOptSetup()->getClassName().c_str(),
-                        capitalizedArgsName.c_str(),
-                        determineArgsName(option).c_str());
-            }
-        } else if (option.getInterface().empty() && option.getConnectToInternalMethod().empty()
-                   && option.getConnectToExternalMethod().empty()) {
-            fprintf(getSourceFile(), "bool %s::isSet%s() const {\nreturn args.%s.isSet;\n}\n",
-                    getGetOptSetup()->getClassName().c_str(), capitalizedArgsName.c_str(),
-                    determineArgsName(option).c_str());
-        }
+
+    if (getGetOptSetup()->getClassName().empty()) {
+        LOG_ERROR("No class name given.");
+        throw GeneratorException("The Class-Name must be set. ");
     }
-    LOG_TRACE("Finished generating getter() source");
-}
 
-void SourceCodeWriter::createExternalFunctions() {
-    LOG_TRACE("Generating external functions");
-    vector<Option> options = getGetOptSetup()->getOptions();
+    // The ClassName may follow the Options in the spec, then the streamed fragments are stale
+    const std::string &className = getGetOptSetup()->getClassName();
+    bool staleFragments = emittedOptions > 0 && fragmentClassName != className;
+    fragmentClassName = className;
+    if (staleFragments) {
+        for (int fragment = 0; fragment < OPTION_FRAGMENT_COUNT; fragment++) {
+            fragments[fragment].clear();
+            optionEnds[fragment].clear();
+            emitFragment((Fragment) fragment, 0, emittedOptions);
+        }
+    }
 
-    for (auto &option: options) {
-        if (!option.getConnectToExternalMethod().empty()) {
-            fprintf(getHeaderFile(), "virtual void %s(", option.getConnectToExternalMethod().c_str());
-            if (option.isHasArguments() == HasArguments::OPTIONAL ||
-                option.isHasArguments() == HasArguments::REQUIRED) {
-                std::string type = getValueTypeByOption(option);
-                fprintf(getHeaderFile(), "%s arg", type.c_str());
-            }
-            fprintf(getHeaderFile(), ") = 0;\n");
+    // The analyzer has resolved the getopt values
+    const vector<Option> &options = getGetOptSetup()->getOptions();
+    ir.addOptions(options, symbols);
+    ir.resolveExclusions(options, symbols, analyzer);
+
+    // Every fragment goes into its own buffer, so they can be generated in any order
+    std::vector<std::function<void()>> tasks;
+    std::size_t begin = emittedOptions;
+    if (begin < options.size()) {
+        for (int fragment = 0; fragment < OPTION_FRAGMENT_COUNT; fragment++) {
+            tasks.emplace_back([this, fragment, begin, &options]() {
+                emitFragment((Fragment) fragment, begin, options.size());
+            });
         }
     }
-    LOG_TRACE("Finished generating external functions");
-}
+    for (int fragment = OPTION_FRAGMENT_COUNT; fragment < FRAGMENT_COUNT; fragment++) {
+        tasks.emplace_back([this, fragment, &options]() {
+            emitFragment((Fragment) fragment, 0, options.size());
+        });
+    }
+    TaskPool::run(tasks, emitJobs);
+    emittedOptions = options.size();
 
-void SourceCodeWriter::createHeaderPrintVersion() {
-    LOG_TRACE("Generating printVersion() header");
-    fprintf(getHeaderFile(), "virtual void printVersion();\n");
-    LOG_TRACE("Finished generating printVersion() header");
+    renderFile(getHeaderFile(), TemplateSet::HEADER_FILE);
+    renderFile(getSourceFile(), TemplateSet::SOURCE_FILE);
 
+    changedFiles = 0;
+    generatedFiles.clear();
+    if (commitFile(headerFile, headerBuffer, headerBufferSize, getHeaderFilePath())) {
+        changedFiles++;
+    }
+    if (commitFile(sourceFile, sourceBuffer, sourceBufferSize, getSourceFilePath())) {
+        changedFiles++;
+    }
+    if (isSharded()) {
+        writeShards();
+    }
+    LOG_INFO("Finished writing source code.");
 }
 
-void SourceCodeWriter::createSourcePrintVersion() {
-    LOG_TRACE("Generating printVersion() source");
-    fprintf(getSourceFile(), "void %s::printVersion(){\nprintf(\"version: 1.0.0\\n\");\n}\n",
-            getGetOptSetup()->getClassName().c_str());
-    LOG_TRACE("Finished generating printVersion() source");
-
-}
 
-void SourceCodeWriter::createHeaderPrintHelp() {
-    LOG_TRACE("Generating printHelp() header");
-    fprintf(getHeaderFile(), "virtual void printHelp();\n");
-    LOG_TRACE("Finished generating printHelp() header");
+/**
+ * @brief Reads a generated file
+ * @param path path to the file
+ * @return the content
+ * @throws GeneratorException if the file can not be read
+ */
+static std::string readGeneratedFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream content;
+    if (!in || !(content << in.rdbuf())) {
+        LOG_ERROR("Could not read " + path);
+        throw GeneratorException("Could not read " + path);
+    }
+    return content.str();
 }
 
-void SourceCodeWriter::createSourcePrintHelp() {
-    LOG_TRACE("Generating printHelp() source");
-    fprintf(getSourceFile(), "%s", HelpText(getGetOptSetup()).parseHelpMessage().c_str());
-    LOG_TRACE("Finished generating printHelp() source");
+/**
+ * @brief Escapes a path for the string literal of a #line directive
+ * @param path the path
+ * @return the path with '"', '\\' and line breaks escaped
+ */
+static std::string escapeLineFileName(const std::string &path) {
+    std::string escaped;
+    for (char c: path) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        } else if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
 }
 
-void SourceCodeWriter::writeFile() {
-    LOG_INFO("Starting to write source code...");
-//    printf("Writing file...\n");
-
-    //Write header files --> put methods here
-    headerFileIncludes();
+bool SourceCodeWriter::writeAmalgamation(const std::string &path,
+                                         const std::vector<std::vector<std::string>> &outputs) {
+    LOG_INFO("Amalgamating " + std::to_string(outputs.size()) + " specs into " + path);
+    MemoryStream stream;
+    FILE *out = stream.getFile();
+    for (auto include: commonIncludes) {
+        fprintf(out, "#include <%s>\n", include);
+    }
 
-    //Write source files --> put methods here
-    sourceFileIncludes();
-    sourceFileNamespace();
-    LOG_INFO("Finished writing source code.");
+    // Every class declares its Args inside, so specs may share a namespace or have none
+    for (auto &files: outputs) {
+        for (std::size_t i = 1; i < files.size(); i++) {
+            // The list of shards is not a source
+            if (boost::ends_with(files[i], ".sources")) {
+                continue;
+            }
+            std::string content = readGeneratedFile(files[i]);
+            fprintf(out, "\n#line 1 \"%s\"\n", escapeLineFileName(files[i]).c_str());
+            fwrite(content.data(), 1, content.size(), out);
+            if (!content.empty() && content.back() != '\n') {
+                fputc('\n', out);
+            }
+        }
+    }
+    return writeIfChanged(stream.getData(), stream.getSize(), path);
 }
-
@@ -0,0 +1,247 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SpecGenerator.h"
+#include "ContentHash.h"
+#include "EmissionPipeline.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include "ModelCache.h"
+#include "NativeXMLParser.h"
+#include "SemanticAnalyzer.h"
+#include "TemplateSet.h"
+#include "Version.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+const std::string &SpecGenerator::getCacheDir() const {
+    return cacheDir;
+}
+
+Frontend SpecGenerator::getFrontend() const {
+    return frontend;
+}
+
+bool SpecGenerator::isStrict() const {
+    return strict;
+}
+
+std::size_t SpecGenerator::getMaxMemory() const {
+    return maxMemory;
+}
+
+bool SpecGenerator::isPipeline() const {
+    return pipeline;
+}
+
+unsigned int SpecGenerator::getEmitJobs() const {
+    return emitJobs;
+}
+
+unsigned int SpecGenerator::getShards() const {
+    return shards;
+}
+
+const std::string &SpecGenerator::getTemplateDir() const {
+    return templateDir;
+}
+
+OutputCache *SpecGenerator::getOutputCache() const {
+    return outputCache.get();
+}
+
+void SpecGenerator::setCacheDir(const std::string &dir) {
+    cacheDir = dir;
+}
+
+void SpecGenerator::setFrontend(Frontend _frontend) {
+    frontend = _frontend;
+}
+
+void SpecGenerator::setStrict(bool _strict) {
+    strict = _strict;
+}
+
+void SpecGenerator::setMaxMemory(std::size_t bytes) {
+    maxMemory = bytes;
+}
+
+void SpecGenerator::setPipeline(bool _pipeline) {
+    pipeline = _pipeline;
+}
+
+void SpecGenerator::setEmitJobs(unsigned int jobs) {
+    emitJobs = jobs;
+}
+
+void SpecGenerator::setShards(unsigned int _shards) {
+    shards = std::max(1u, _shards);
+}
+
+void SpecGenerator::setTemplateDir(const std::string &dir) {
+    templateDir = dir;
+}
+
+void SpecGenerator::setOutputCache(const std::string &dir, std::size_t maxBytes) {
+    if (dir.empty()) {
+        outputCache.reset();
+    } else {
+        outputCache = std::make_shared<OutputCache>(dir, maxBytes);
+    }
+}
+
+std::string SpecGenerator::getFingerprint() const {
+    // Specs generated without strict checks have to be checked again in strict mode
+    std::string fingerprint = std::string(CODEGENERATOR_VERSION) + (isStrict() ? "+strict" : "");
+    // The number of shards changes the generated files
+    if (getShards() > 1) {
+        fingerprint += "+shards" + std::to_string(getShards());
+    }
+    // Own templates are identified by their content
+    fingerprint += TemplateSet::get(getTemplateDir()).getFingerprint();
+    return fingerprint;
+}
+
+void SpecGenerator::generate(const std::string &name, const char *buffer, std::size_t bufferSize,
+                             const std::string &outputDir, const std::function<SAXParser &()> &acquireParser,
+                             SpecResult &result, std::vector<GeneratedFile> *files) const {
+    GetOptSetup cachedSetup;
+    GetOptSetup *getOptSetup;
+    std::unique_ptr<SpecParser> parser;
+    XMLParser *xmlParser = nullptr;
+
+    uint64_t specHash = 0;
+    bool hashed = false;
+    // Code generated into memory is not written anywhere the output cache could link it to
+    OutputCache *cache = files == nullptr ? getOutputCache() : nullptr;
+    if (!getCacheDir().empty() || cache != nullptr) {
+        if (buffer != nullptr) {
+            specHash = ContentHash::ofBytes(buffer, bufferSize);
+            hashed = true;
+        } else {
+            hashed = ContentHash::ofFile(name, specHash);
+        }
+    }
+
+    uint64_t outputKey = 0;
+    if (cache != nullptr && hashed) {
+        // The list of shard sources names the output directory
+        std::string generator = getFingerprint() + '\0' + (getShards() > 1 ? outputDir : "");
+        outputKey = ContentHash::ofString(generator, specHash);
+        if (cache->materialize(outputKey, outputDir, result.outputs)) {
+            LOG_INFO("Took the code of " + name + " from the output cache");
+            return;
+        }
+    }
+
+    bool cacheable = hashed && !getCacheDir().empty();
+    if (cacheable && ModelCache(getCacheDir()).load(specHash, cachedSetup)) {
+        LOG_INFO("Loaded model of " + name + " from the model cache");
+        getOptSetup = &cachedSetup;
+    } else {
+        if (getFrontend() == Frontend::NATIVE) {
+            parser.reset(new NativeXMLParser(name));
+        } else {
+            xmlParser = new XMLParser(name);
+            parser.reset(xmlParser);
+        }
+        if (buffer != nullptr) {
+            parser->setBuffer(buffer, bufferSize);
+        }
+        parser->setStrict(isStrict());
+        parser->setMemoryLimit(getMaxMemory());
+        getOptSetup = parser->getGetOptSetup();
+    }
+
+    SemanticAnalyzer analyzer(*getOptSetup);
+    SourceCodeWriter writer(getOptSetup, analyzer);
+    writer.setOutputDir(outputDir);
+    writer.setEmitJobs(getEmitJobs());
+    writer.setShards(getShards());
+    writer.setTemplates(TemplateSet::get(getTemplateDir()));
+    writer.setInMemory(files != nullptr);
+
+    if (parser) {
+        LOG_INFO("Starting parser for " + name);
+        std::unique_ptr<EmissionPipeline> emissionPipeline;
+        if (isPipeline()) {
+            emissionPipeline.reset(new EmissionPipeline(*getOptSetup, writer));
+            EmissionPipeline *sink = emissionPipeline.get();
+            parser->setOptionSink([sink](Option &&option) { sink->push(std::move(option)); });
+        }
+        // The allocations of a reused parser are not charged to the spec, so a spec with a budget gets its own
+        if (xmlParser != nullptr && acquireParser && getMaxMemory() == 0) {
+            xmlParser->parse(acquireParser());
+        } else {
+            parser->parse();
+        }
+        if (emissionPipeline) {
+            emissionPipeline->finish();
+        }
+        result.memoryBytes = parser->getMemoryBudget().getPeakBytes();
+        result.memoryAllocations = parser->getMemoryBudget().getAllocations();
+        LOG_INFO("Finished parser for " + name + ", at most " + to_string(result.memoryBytes) + " bytes in use, "
+                 + to_string(result.memoryAllocations) + " allocations");
+        // Only models of clean specs are cached, so a cache hit also passes the strict checks
+        if (cacheable && parser->getIllegalTransitions() == 0) {
+            ModelCache(getCacheDir()).store(specHash, *getOptSetup);
+        }
+    }
+
+    LOG_INFO("Analyzing " + name);
+    analyzer.analyze();
+
+    LOG_INFO("Starting SourceCodeWriter for " + name);
+    writer.writeFile();
+    LOG_INFO("Finished SourceCodeWriter for " + name + ", " + to_string(writer.getChangedFiles())
+             + " files changed");
+
+    result.outputs = writer.getOutputFilePaths();
+    // Like the model cache, only the code of clean specs is shared
+    if (cache != nullptr && hashed && (!parser || parser->getIllegalTransitions() == 0)) {
+        cache->store(outputKey, outputDir, result.outputs);
+    }
+    if (files != nullptr) {
+        *files = writer.getGeneratedFiles();
+    }
+}
+
+void SpecGenerator::generateFile(const std::string &filePath, const std::string &outputDir,
+                                 const std::function<SAXParser &()> &acquireParser, SpecResult &result) const {
+    generate(filePath, nullptr, 0, outputDir, acquireParser, result, nullptr);
+}
+
+void SpecGenerator::generateFile(const std::string &filePath, const char *spec, std::size_t size,
+                                 const std::string &outputDir, const std::function<SAXParser &()> &acquireParser,
+                                 SpecResult &result) const {
+    generate(filePath, spec != nullptr ? spec : "", size, outputDir, acquireParser, result, nullptr);
+}
+
+std::vector<GeneratedFile> SpecGenerator::generate(const char *spec, std::size_t size,
+                                                   const std::string &name) const {
+    SpecResult result;
+    std::vector<GeneratedFile> files;
+    // A null spec is an empty one, not a request to read the file
+    generate(name, spec != nullptr ? spec : "", size, "", std::function<SAXParser &()>(), result, &files);
+    return files;
+}
+
+bool SpecGenerator::generate(const char *spec, std::size_t size, char *header, std::size_t &headerSize,
+                             char *source, std::size_t &sourceSize) const {
+    if (getShards() > 1) {
+        LOG_ERROR("A sharded spec does not fit into a header and a source buffer");
+        throw GeneratorException("Generating into buffers needs a single shard");
+    }
+    std::vector<GeneratedFile> files = generate(spec, size);
+    bool fits = files[0].content.size() <= headerSize && files[1].content.size() <= sourceSize;
+    headerSize = files[0].content.size();
+    sourceSize = files[1].content.size();
+    if (!fits) {
+        return false;
+    }
+    memcpy(header, files[0].content.data(), headerSize);
+    memcpy(source, files[1].content.data(), sourceSize);
+    return true;
+}
@@ -0,0 +1,46 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SpecMemoryBudget.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <algorithm>
+
+SpecMemoryBudget::SpecMemoryBudget(std::size_t limit) : limit(limit) {
+}
+
+void SpecMemoryBudget::charge(std::size_t size) {
+    if (limit != 0 && size > limit - std::min(bytes, limit)) {
+        LOG_ERROR("Memory budget of " + std::to_string(limit) + " bytes exceeded after "
+                  + std::to_string(bytes) + " bytes");
+        throw GeneratorException("Spec exceeds the memory budget of " + std::to_string(limit) + " bytes");
+    }
+    bytes += size;
+    peakBytes = std::max(peakBytes, bytes);
+    allocations++;
+}
+
+void SpecMemoryBudget::release(std::size_t size) {
+    bytes -= std::min(size, bytes);
+}
+
+std::size_t SpecMemoryBudget::getBytes() const {
+    return bytes;
+}
+
+std::size_t SpecMemoryBudget::getPeakBytes() const {
+    return peakBytes;
+}
+
+std::size_t SpecMemoryBudget::getAllocations() const {
+    return allocations;
+}
+
+std::size_t SpecMemoryBudget::getLimit() const {
+    return limit;
+}
+
+void SpecMemoryBudget::setLimit(std::size_t _limit) {
+    limit = _limit;
+}
@@ -0,0 +1,134 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SpecParser.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <boost/algorithm/string/predicate.hpp>
+
+SpecParser::SpecParser(const std::string &filename) : filename(filename) {
+}
+
+GetOptSetup *SpecParser::getGetOptSetup() const {
+    return getOptSetup.get();
+}
+
+bool SpecParser::isStrict() const {
+    return strict;
+}
+
+void SpecParser::setStrict(bool _strict) {
+    strict = _strict;
+}
+
+std::size_t SpecParser::getIllegalTransitions() const {
+    return illegalTransitions;
+}
+
+const SpecMemoryBudget &SpecParser::getMemoryBudget() const {
+    return memoryBudget;
+}
+
+void SpecParser::setMemoryLimit(std::size_t limit) {
+    memoryBudget.setLimit(limit);
+}
+
+void SpecParser::setOptionSink(std::function<void(Option &&)> sink) {
+    optionSink = std::move(sink);
+}
+
+void SpecParser::setBuffer(const char *data, std::size_t size) {
+    buffer = data;
+    bufferSize = size;
+}
+
+void SpecParser::addOption(Option &option) {
+    if (optionSink) {
+        optionSink(std::move(option));
+    } else {
+        getOptSetup->addOption(std::move(option));
+    }
+}
+
+bool SpecParser::frontendFromString(const std::string &name, Frontend &frontend) {
+    if (boost::iequals(name, "xerces")) {
+        frontend = Frontend::XERCES;
+    } else if (boost::iequals(name, "native")) {
+        frontend = Frontend::NATIVE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void SpecParser::handleEvent(Event event) {
+    State before = sm->getState();
+    if (sm->handleEvent(event)) {
+        if (sm->getState() != before) {
+            commitText(before);
+        }
+        return;
+    }
+    illegalTransitions++;
+    std::string message = getLocation() + ": " + StateMachine::eventName(event) + " is not allowed in state "
+                          + StateMachine::stateName(sm->getState());
+    if (strict) {
+        LOG_ERROR(message);
+        throw GeneratorException(message);
+    }
+    LOG_WARN("Ignoring " + message);
+}
+
+std::string SpecParser::getLocation() const {
+    return filename;
+}
+
+void SpecParser::handleCharacters(boost::string_view chars) {
+    if (isTextState()) {
+        text.append(chars.data(), chars.size());
+    }
+}
+
+bool SpecParser::isTextState() const {
+    switch (sm->getState()) {
+        case State::HEADERFILENAME:
+        case State::SOURCEFILENAME:
+        case State::NAMESPACE:
+        case State::CLASSNAME:
+        case State::BLOCK:
+        case State::SAMPLE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void SpecParser::commitText(State state) {
+    if (text.empty()) {
+        return;
+    }
+    switch (state) {
+        case State::HEADERFILENAME:
+            getOptSetup->setHeaderFileName(text);
+            break;
+        case State::SOURCEFILENAME:
+            getOptSetup->setSourceFileName(text);
+            break;
+        case State::NAMESPACE:
+            getOptSetup->setNamespaceName(text);
+            break;
+        case State::CLASSNAME:
+            getOptSetup->setClassName(text);
+            break;
+        case State::BLOCK:
+            getOptSetup->addOverAllDescription(text);
+            break;
+        case State::SAMPLE:
+            getOptSetup->addSampleUsage(text);
+            break;
+        default:
+            break;
+    }
+    text.clear();
+}
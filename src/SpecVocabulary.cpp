@@ -0,0 +1,235 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SpecVocabulary.h"
+
+namespace {
+    /**
+     * @brief Names of the elements, indexed by SpecElement
+     */
+    const char *const elementNames[] = {
+            "GetOptSetup",
+            "Author",
+            "HeaderFileName",
+            "SourceFileName",
+            "NameSpace",
+            "ClassName",
+            "OverAllDescription",
+            "Block",
+            "SampleUsage",
+            "Sample",
+            "Options",
+            "Option"
+    };
+
+    /**
+     * @brief Names of the attributes, indexed by SpecAttribute
+     */
+    const char *const attributeNames[] = {
+            "SignPerLine",
+            "Name",
+            "Phone",
+            "Mail",
+            "Ref",
+            "ShortOpt",
+            "LongOpt",
+            "Description",
+            "Exclusion",
+            "ConnectToInternalMethod",
+            "ConnectToExternalMethod",
+            "HasArguments",
+            "ConvertTo",
+            "DefaultValue",
+            "Interface"
+    };
+
+    /**
+     * @brief Start and end events, indexed by SpecElement
+     */
+    const Event elementEvents[][2] = {
+            {Event::GETOPTSETUPSTART,        Event::GETOPTSETUPEND},
+            {Event::AUTHORSTART,             Event::AUTHOREND},
+            {Event::HEADERFILENAMESTART,     Event::HEADERFILENAMEEND},
+            {Event::SOURCEFILENAMESTART,     Event::SOURCEFILENAMEEND},
+            {Event::NAMESPACESTART,          Event::NAMESPACEEND},
+            {Event::CLASSNAMESTART,          Event::CLASSNAMEEND},
+            {Event::OVERALLDESCRIPTIONSTART, Event::OVERALLDESCRIPTIONEND},
+            {Event::BLOCKSTART,              Event::BLOCKEND},
+            {Event::SAMPLEUSAGESTART,        Event::SAMPLEUSAGEEND},
+            {Event::SAMPLESTART,             Event::SAMPLEEND},
+            {Event::OPTIONSSTART,            Event::OPTIONSEND},
+            {Event::OPTIONSTART,             Event::OPTIONEND}
+    };
+
+    static_assert(sizeof(elementNames) / sizeof(elementNames[0]) == (std::size_t) SpecElement::UNKNOWN,
+                  "elementNames must cover every SpecElement");
+    static_assert(sizeof(attributeNames) / sizeof(attributeNames[0]) == (std::size_t) SpecAttribute::UNKNOWN,
+                  "attributeNames must cover every SpecAttribute");
+    static_assert(sizeof(elementEvents) / sizeof(elementEvents[0]) == (std::size_t) SpecElement::UNKNOWN,
+                  "elementEvents must cover every SpecElement");
+
+    template<typename CharT>
+    bool equals(const CharT *name, std::size_t length, const char *literal) {
+        for (std::size_t i = 0; i < length; i++) {
+            if (literal[i] == '\0' || name[i] != (CharT) (unsigned char) literal[i]) {
+                return false;
+            }
+        }
+        return literal[length] == '\0';
+    }
+
+    template<typename CharT>
+    std::size_t lengthOf(const CharT *name) {
+        std::size_t length = 0;
+        while (name[length] != 0) {
+            length++;
+        }
+        return length;
+    }
+
+    template<typename CharT>
+    SpecElement lookupElement(const CharT *name, std::size_t length) {
+        SpecElement candidate = SpecElement::UNKNOWN;
+        switch (length) {
+            case 5:
+                candidate = SpecElement::BLOCK;
+                break;
+            case 6:
+                switch (name[0]) {
+                    case 'A': candidate = SpecElement::AUTHOR; break;
+                    case 'S': candidate = SpecElement::SAMPLE; break;
+                    case 'O': candidate = SpecElement::OPTION; break;
+                    default: break;
+                }
+                break;
+            case 7:
+                candidate = SpecElement::OPTIONS;
+                break;
+            case 9:
+                switch (name[0]) {
+                    case 'N': candidate = SpecElement::NAMESPACE; break;
+                    case 'C': candidate = SpecElement::CLASSNAME; break;
+                    default: break;
+                }
+                break;
+            case 11:
+                switch (name[0]) {
+                    case 'G': candidate = SpecElement::GETOPTSETUP; break;
+                    case 'S': candidate = SpecElement::SAMPLEUSAGE; break;
+                    default: break;
+                }
+                break;
+            case 14:
+                switch (name[0]) {
+                    case 'H': candidate = SpecElement::HEADERFILENAME; break;
+                    case 'S': candidate = SpecElement::SOURCEFILENAME; break;
+                    default: break;
+                }
+                break;
+            case 18:
+                candidate = SpecElement::OVERALLDESCRIPTION;
+                break;
+            default:
+                break;
+        }
+        if (candidate == SpecElement::UNKNOWN || !equals(name, length, elementNames[(int) candidate])) {
+            return SpecElement::UNKNOWN;
+        }
+        return candidate;
+    }
+
+    template<typename CharT>
+    SpecAttribute lookupAttribute(const CharT *name, std::size_t length) {
+        SpecAttribute candidate = SpecAttribute::UNKNOWN;
+        switch (length) {
+            case 3:
+                candidate = SpecAttribute::REF;
+                break;
+            case 4:
+                switch (name[0]) {
+                    case 'N': candidate = SpecAttribute::NAME; break;
+                    case 'M': candidate = SpecAttribute::MAIL; break;
+                    default: break;
+                }
+                break;
+            case 5:
+                candidate = SpecAttribute::PHONE;
+                break;
+            case 7:
+                candidate = SpecAttribute::LONGOPT;
+                break;
+            case 8:
+                candidate = SpecAttribute::SHORTOPT;
+                break;
+            case 9:
+                switch (name[0]) {
+                    case 'E': candidate = SpecAttribute::EXCLUSION; break;
+                    case 'C': candidate = SpecAttribute::CONVERTTO; break;
+                    case 'I': candidate = SpecAttribute::INTERFACE; break;
+                    default: break;
+                }
+                break;
+            case 11:
+                switch (name[0]) {
+                    case 'S': candidate = SpecAttribute::SIGNPERLINE; break;
+                    case 'D': candidate = SpecAttribute::DESCRIPTION; break;
+                    default: break;
+                }
+                break;
+            case 12:
+                switch (name[0]) {
+                    case 'H': candidate = SpecAttribute::HASARGUMENTS; break;
+                    case 'D': candidate = SpecAttribute::DEFAULTVALUE; break;
+                    default: break;
+                }
+                break;
+            case 23:
+                // ConnectTo[I]nternalMethod and ConnectTo[E]xternalMethod
+                switch (name[9]) {
+                    case 'I': candidate = SpecAttribute::CONNECTTOINTERNALMETHOD; break;
+                    case 'E': candidate = SpecAttribute::CONNECTTOEXTERNALMETHOD; break;
+                    default: break;
+                }
+                break;
+            default:
+                break;
+        }
+        if (candidate == SpecAttribute::UNKNOWN || !equals(name, length, attributeNames[(int) candidate])) {
+            return SpecAttribute::UNKNOWN;
+        }
+        return candidate;
+    }
+}
+
+SpecElement SpecVocabulary::element(boost::string_view name) {
+    return lookupElement(name.data(), name.size());
+}
+
+SpecElement SpecVocabulary::element(const XMLCh *name) {
+    return lookupElement(name, lengthOf(name));
+}
+
+SpecAttribute SpecVocabulary::attribute(boost::string_view name) {
+    return lookupAttribute(name.data(), name.size());
+}
+
+SpecAttribute SpecVocabulary::attribute(const XMLCh *name) {
+    return lookupAttribute(name, lengthOf(name));
+}
+
+const char *SpecVocabulary::nameOf(SpecElement element) {
+    return element == SpecElement::UNKNOWN ? "" : elementNames[(int) element];
+}
+
+const char *SpecVocabulary::nameOf(SpecAttribute attribute) {
+    return attribute == SpecAttribute::UNKNOWN ? "" : attributeNames[(int) attribute];
+}
+
+Event SpecVocabulary::startEvent(SpecElement element) {
+    return elementEvents[(int) element][0];
+}
+
+Event SpecVocabulary::endEvent(SpecElement element) {
+    return elementEvents[(int) element][1];
+}
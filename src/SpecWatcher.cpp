@@ -0,0 +1,86 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SpecWatcher.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+const int SpecWatcher::maxBurstMs;
+
+SpecWatcher::SpecWatcher() {
+    inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify < 0) {
+        std::string message = std::string("Could not watch the specs: ") + strerror(errno);
+        LOG_ERROR(message);
+        throw GeneratorException(message);
+    }
+}
+
+SpecWatcher::~SpecWatcher() {
+    close(inotify);
+}
+
+bool SpecWatcher::watchDirectory(const std::string &dir) {
+    std::string path = boost::filesystem::absolute(dir).lexically_normal().string();
+    // Saving writes and closes the file, or renames a new file over it
+    int watch = inotify_add_watch(inotify, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR);
+    if (watch < 0) {
+        LOG_WARN("Could not watch " + path + ": " + strerror(errno));
+        return false;
+    }
+    if (directories.emplace(watch, path).second) {
+        LOG_DEBUG("Watching " + path);
+    }
+    return true;
+}
+
+std::set<std::string> SpecWatcher::waitForChanges(std::chrono::milliseconds debounce) {
+    std::set<std::string> changed;
+    struct pollfd events = {inotify, POLLIN, 0};
+    while (!readEvents(changed)) {
+        poll(&events, 1, -1);
+    }
+    // Editors save in several steps, the burst is over once it stays quiet for the debounce time
+    auto burstEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxBurstMs);
+    while (std::chrono::steady_clock::now() < burstEnd && poll(&events, 1, (int) debounce.count()) > 0) {
+        readEvents(changed);
+    }
+    return changed;
+}
+
+bool SpecWatcher::readEvents(std::set<std::string> &changed) {
+    alignas(struct inotify_event) char buffer[4096];
+    bool any = false;
+    ssize_t length;
+    while ((length = read(inotify, buffer, sizeof(buffer))) > 0) {
+        any = true;
+        for (char *position = buffer; position < buffer + length;) {
+            auto event = (const struct inotify_event *) position;
+            position += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost, the caller has to assume that every file changed
+                LOG_WARN("Too many changes at once, checking all specs");
+                changed.insert("");
+                continue;
+            }
+            auto directory = directories.find(event->wd);
+            if (directory == directories.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                LOG_WARN("Stopped watching " + directory->second + ", it was removed");
+                directories.erase(directory);
+            } else if (event->len > 0) {
+                changed.insert((boost::filesystem::path(directory->second) / event->name).string());
+            }
+        }
+    }
+    return any;
+}
@@ -5,90 +5,125 @@
 #include "StateMachine.h"
 #include "Logger.h"
 
-inline std::string eventToString(Event event) {
-    switch (event) {
-        case Event::GETOPTSETUPSTART:
-            return "GETOPTSETUPSTART";
-        case Event::GETOPTSETUPEND:
-            return "GETOPTSETUPEND";
-        case Event::AUTHORSTART:
-            return "AUTHORSTART";
-        case Event::AUTHOREND:
-            return "AUTHOREND";
-        case Event::HEADERFILENAMESTART:
-            return "HEADERFILENAMESTART";
-        case Event::HEADERFILENAMEEND:
-            return "HEADERFILENAMEEND";
-        case Event::SOURCEFILENAMESTART:
-            return "SOURCEFILENAMESTART";
-        case Event::SOURCEFILENAMEEND:
-            return "SOURCEFILENAMEEND";
-        case Event::NAMESPACESTART:
-            return "NAMESPACESTART";
-        case Event::NAMESPACEEND:
-            return "NAMESPACEEND";
-        case Event::CLASSNAMESTART:
-            return "CLASSNAMESTART";
-        case Event::CLASSNAMEEND:
-            return "CLASSNAMEEND";
-        case Event::OVERALLDESCRIPTIONSTART:
-            return "OVERALLDESCRIPTIONSTART";
-        case Event::OVERALLDESCRIPTIONEND:
-            return "OVERALLDESCRIPTIONEND";
-        case Event::BLOCKSTART:
-            return "BLOCKSTART";
-        case Event::BLOCKEND:
-            return "BLOCKEND";
-        case Event::SAMPLEUSAGESTART:
-            return "SAMPLEUSAGESTART";
-        case Event::SAMPLEUSAGEEND:
-            return "SAMPLEUSAGEEND";
-        case Event::SAMPLESTART:
-            return "SAMPLESTART";
-        case Event::SAMPLEEND:
-            return "SAMPLEEND";
-        case Event::OPTIONSSTART:
-            return "OPTIONSSTART";
-        case Event::OPTIONSEND:
-            return "OPTIONSEND";
-        case Event::OPTIONSTART:
-            return "OPTIONSTART";
-        case Event::OPTIONEND:
-            return "OPTIONEND";
-        default:
-            return "UNKNOWN";
-    }
-}
+namespace {
+    /**
+     * @brief Names of the states, indexed by State
+     */
+    constexpr const char *stateNames[stateCount] = {
+            "START",
+            "GETOPTSETUP",
+            "AUTHOR",
+            "HEADERFILENAME",
+            "SOURCEFILENAME",
+            "NAMESPACE",
+            "CLASSNAME",
+            "OVERALLDESCRIPTION",
+            "BLOCK",
+            "SAMPLEUSAGE",
+            "SAMPLE",
+            "OPTIONS",
+            "OPTION",
+            "END"
+    };
+
+    /**
+     * @brief Names of the events, indexed by Event
+     */
+    constexpr const char *eventNames[eventCount] = {
+            "GETOPTSETUPSTART",
+            "GETOPTSETUPEND",
+            "AUTHORSTART",
+            "AUTHOREND",
+            "HEADERFILENAMESTART",
+            "HEADERFILENAMEEND",
+            "SOURCEFILENAMESTART",
+            "SOURCEFILENAMEEND",
+            "NAMESPACESTART",
+            "NAMESPACEEND",
+            "CLASSNAMESTART",
+            "CLASSNAMEEND",
+            "OVERALLDESCRIPTIONSTART",
+            "OVERALLDESCRIPTIONEND",
+            "BLOCKSTART",
+            "BLOCKEND",
+            "SAMPLEUSAGESTART",
+            "SAMPLEUSAGEEND",
+            "SAMPLESTART",
+            "SAMPLEEND",
+            "OPTIONSSTART",
+            "OPTIONSEND",
+            "OPTIONSTART",
+            "OPTIONEND"
+    };
+
+    /**
+     * @brief A legal transition
+     */
+    struct Transition {
+        State from;
+        Event event;
+        State to;
+    };
+
+    /**
+     * @brief All legal transitions, every other combination of state and event is illegal
+     */
+    constexpr Transition transitions[] = {
+            {State::START,              Event::GETOPTSETUPSTART,        State::GETOPTSETUP},
+            {State::GETOPTSETUP,        Event::GETOPTSETUPEND,          State::END},
+            {State::GETOPTSETUP,        Event::AUTHORSTART,             State::AUTHOR},
+            {State::GETOPTSETUP,        Event::HEADERFILENAMESTART,     State::HEADERFILENAME},
+            {State::GETOPTSETUP,        Event::SOURCEFILENAMESTART,     State::SOURCEFILENAME},
+            {State::GETOPTSETUP,        Event::NAMESPACESTART,          State::NAMESPACE},
+            {State::GETOPTSETUP,        Event::CLASSNAMESTART,          State::CLASSNAME},
+            {State::GETOPTSETUP,        Event::OVERALLDESCRIPTIONSTART, State::OVERALLDESCRIPTION},
+            {State::GETOPTSETUP,        Event::SAMPLEUSAGESTART,        State::SAMPLEUSAGE},
+            {State::GETOPTSETUP,        Event::OPTIONSSTART,            State::OPTIONS},
+            {State::AUTHOR,             Event::AUTHOREND,               State::GETOPTSETUP},
+            {State::HEADERFILENAME,     Event::HEADERFILENAMEEND,       State::GETOPTSETUP},
+            {State::SOURCEFILENAME,     Event::SOURCEFILENAMEEND,       State::GETOPTSETUP},
+            {State::NAMESPACE,          Event::NAMESPACEEND,            State::GETOPTSETUP},
+            {State::CLASSNAME,          Event::CLASSNAMEEND,            State::GETOPTSETUP},
+            {State::OVERALLDESCRIPTION, Event::OVERALLDESCRIPTIONEND,   State::GETOPTSETUP},
+            {State::OVERALLDESCRIPTION, Event::BLOCKSTART,              State::BLOCK},
+            {State::BLOCK,              Event::BLOCKEND,                State::OVERALLDESCRIPTION},
+            {State::SAMPLEUSAGE,        Event::SAMPLEUSAGEEND,          State::GETOPTSETUP},
+            {State::SAMPLEUSAGE,        Event::SAMPLESTART,             State::SAMPLE},
+            {State::SAMPLE,             Event::SAMPLEEND,               State::SAMPLEUSAGE},
+            {State::OPTIONS,            Event::OPTIONSEND,              State::GETOPTSETUP},
+            {State::OPTIONS,            Event::OPTIONSTART,             State::OPTION},
+            {State::OPTION,             Event::OPTIONEND,               State::OPTIONS}
+    };
+
+    /**
+     * @brief Marks an illegal transition in the table
+     */
+    constexpr signed char illegal = -1;
+
+    /**
+     * @brief Dense State x Event table, holds the next state or illegal
+     */
+    struct TransitionTable {
+        signed char next[stateCount][eventCount];
+    };
 
-inline std::string stateToString(State state) {
-    switch (state) {
-        case State::GETOPTSETUP:
-            return "GETOPTSETUP";
-        case State::AUTHOR:
-            return "AUTHOR";
-        case State::HEADERFILENAME:
-            return "HEADERFILENAME";
-        case State::SOURCEFILENAME:
-            return "SOURCEFILENAME";
-        case State::NAMESPACE:
-            return "NAMESPACE";
-        case State::CLASSNAME:
-            return "CLASSNAME";
-        case State::OVERALLDESCRIPTION:
-            return "OVERALLDESCRIPTION";
-        case State::BLOCK:
-            return "BLOCK";
-        case State::SAMPLEUSAGE:
-            return "SAMPLEUSAGE";
-        case State::SAMPLE:
-            return "SAMPLE";
-        case State::OPTIONS:
-            return "OPTIONS";
-        case State::OPTION:
-            return "OPTION";
-        default:
-            return "UNKNOWN";
+    constexpr TransitionTable buildTransitionTable() {
+        TransitionTable table{};
+        for (std::size_t state = 0; state < stateCount; state++) {
+            for (std::size_t event = 0; event < eventCount; event++) {
+                table.next[state][event] = illegal;
+            }
+        }
+        for (const Transition &transition: transitions) {
+            table.next[(std::size_t) transition.from][(std::size_t) transition.event] = (signed char) transition.to;
+        }
+        return table;
     }
+
+    constexpr TransitionTable transitionTable = buildTransitionTable();
+
+    static_assert(transitionTable.next[(std::size_t) State::START][(std::size_t) Event::GETOPTSETUPSTART]
+                  == (signed char) State::GETOPTSETUP, "transition table is built at compile time");
 }
 
 // Constructor
@@ -110,160 +145,22 @@ void StateMachine::setState(State state) {
 
 
 // Methods
-void StateMachine::handleEvent(Event event) {
-    LOG_TRACE("State: " + stateToString(currentState) + " Event: " + eventToString(event));
-    switch (currentState) {
-        case State::START:
-            switch (event) {
-                case Event::GETOPTSETUPSTART:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::GETOPTSETUP:
-            switch (event) {
-                case Event::GETOPTSETUPEND:
-                    currentState = State::END;
-                    break;
-                case Event::AUTHORSTART:
-                    currentState = State::AUTHOR;
-                    break;
-                case Event::HEADERFILENAMESTART:
-                    currentState = State::HEADERFILENAME;
-                    break;
-                case Event::SOURCEFILENAMESTART:
-                    currentState = State::SOURCEFILENAME;
-                    break;
-                case Event::NAMESPACESTART:
-                    currentState = State::NAMESPACE;
-                    break;
-                case Event::CLASSNAMESTART:
-                    currentState = State::CLASSNAME;
-                    break;
-                case Event::OVERALLDESCRIPTIONSTART:
-                    currentState = State::OVERALLDESCRIPTION;
-                    break;
-                case Event::SAMPLEUSAGESTART:
-                    currentState = State::SAMPLEUSAGE;
-                    break;
-                case Event::OPTIONSSTART:
-                    currentState = State::OPTIONS;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::AUTHOR:
-            switch (event) {
-                case Event::AUTHOREND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::HEADERFILENAME:
-            switch (event) {
-                case Event::HEADERFILENAMEEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::SOURCEFILENAME:
-            switch (event) {
-                case Event::SOURCEFILENAMEEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::NAMESPACE:
-            switch (event) {
-                case Event::NAMESPACEEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::CLASSNAME:
-            switch (event) {
-                case Event::CLASSNAMEEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::OVERALLDESCRIPTION:
-            switch (event) {
-                case Event::OVERALLDESCRIPTIONEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                case Event::BLOCKSTART:
-                    currentState = State::BLOCK;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::BLOCK:
-            switch (event) {
-                case Event::BLOCKEND:
-                    currentState = State::OVERALLDESCRIPTION;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::SAMPLEUSAGE:
-            switch (event) {
-                case Event::SAMPLEUSAGEEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                case Event::SAMPLESTART:
-                    currentState = State::SAMPLE;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::SAMPLE:
-            switch (event) {
-                case Event::SAMPLEEND:
-                    currentState = State::SAMPLEUSAGE;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::OPTIONS:
-            switch (event) {
-                case Event::OPTIONSEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                case Event::OPTIONSTART:
-                    currentState = State::OPTION;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case State::OPTION:
-            switch (event) {
-                case Event::OPTIONEND:
-                    currentState = State::GETOPTSETUP;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        default:
-            break;
+bool StateMachine::handleEvent(Event event) {
+    LOG_TRACE("State: " << stateNames[(std::size_t) currentState] << " Event: " << eventNames[(std::size_t) event]);
+    signed char next = transitionTable.next[(std::size_t) currentState][(std::size_t) event];
+    if (next == illegal) {
+        return false;
     }
+    currentState = (State) next;
+    return true;
+}
+
+
+// Names
+const char *StateMachine::stateName(State state) {
+    return stateNames[(std::size_t) state];
+}
+
+const char *StateMachine::eventName(Event event) {
+    return eventNames[(std::size_t) event];
 }
@@ -0,0 +1,164 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "SymbolTable.h"
+#include "SemanticAnalyzer.h"
+#include "Logger.h"
+#include <cctype>
+
+namespace {
+    bool isSeparator(char c) {
+        return c == ' ' || c == '-' || c == '.' || c == ':';
+    }
+
+    /**
+     * @brief Message for two options with the same identifier
+     */
+    std::string collision(const std::vector<Option> &options, std::size_t first, std::size_t second,
+                          const char *what, const std::string &identifier) {
+        return "The options " + SemanticAnalyzer::describe(options[first]) + " and "
+               + SemanticAnalyzer::describe(options[second]) + " both map to the " + what + " " + identifier;
+    }
+
+    /**
+     * @brief Checks whether two options collide only because of a duplicate LongOpt or ShortOpt
+     * The SemanticAnalyzer reports these duplicates already.
+     */
+    bool isDuplicate(const Option &first, const Option &second) {
+        if (!first.getInterface().empty() || !second.getInterface().empty()) {
+            return false;
+        }
+        if (!first.getLongOpt().empty() || !second.getLongOpt().empty()) {
+            return first.getLongOpt() == second.getLongOpt();
+        }
+        return first.getShortOpt() == second.getShortOpt();
+    }
+}
+
+void SymbolTable::resolveNames(const std::vector<Option> &options) {
+    for (std::size_t i = symbols.size(); i < options.size(); i++) {
+        const Option &option = options[i];
+        symbols.emplace_back();
+        OptionSymbol &symbol = symbols.back();
+
+        if (!option.getInterface().empty()) {
+            symbol.argsName = toIdentifier(option.getInterface());
+        } else if (!option.getLongOpt().empty()) {
+            symbol.argsName = toIdentifier(option.getLongOpt());
+        } else if (option.getShortOpt() != '\0' && !isblank(option.getShortOpt())) {
+            symbol.argsName = toIdentifier(std::string(1, option.getShortOpt()));
+        }
+        symbol.valueType = valueTypeOf(option);
+        if (symbol.argsName.empty()) {
+            addError("Option " + std::to_string(i + 1)
+                     + " must at least have either an Interface, a LongOpt or a ShortOpt");
+            continue;
+        }
+        symbol.capitalizedName = symbol.argsName;
+        symbol.capitalizedName[0] = (char) toupper((unsigned char) symbol.capitalizedName[0]);
+
+        auto argsName = argsNames.emplace(symbol.argsName, i);
+        auto capitalizedName = capitalizedNames.emplace(symbol.capitalizedName, i);
+        if (!argsName.second) {
+            if (!isDuplicate(options[argsName.first->second], option)) {
+                addError(collision(options, argsName.first->second, i, "identifier", symbol.argsName));
+            }
+        } else if (!capitalizedName.second) {
+            addError(collision(options, capitalizedName.first->second, i, "getter suffix", symbol.capitalizedName));
+        }
+        LOG_TRACE("Option " << SemanticAnalyzer::describe(option) << " resolved to " << symbol.argsName);
+    }
+}
+
+void SymbolTable::resolveOptionValues(const std::vector<Option> &options) {
+    resolveNames(options);
+
+    // getopt_long returns the ShortOpt character, options with only a LongOpt get a number
+    // that is neither a ShortOpt nor '?', which is returned for unknown options
+    bool usedValues[256] = {};
+    usedValues[(unsigned char) '?'] = true;
+    for (const Option &option: options) {
+        if (option.getShortOpt() != '\0') {
+            usedValues[(unsigned char) option.getShortOpt()] = true;
+        }
+    }
+    int nextLongOptValue = 0;
+
+    std::unordered_map<std::string, std::size_t> optionValues;
+    optionValues.reserve(options.size());
+    for (std::size_t i = 0; i < options.size(); i++) {
+        const Option &option = options[i];
+        OptionSymbol &symbol = symbols[i];
+
+        if (option.getShortOpt() != '\0') {
+            symbol.optionValue = std::string("'") + option.getShortOpt() + "'";
+        } else if (!option.getLongOpt().empty()) {
+            while (nextLongOptValue < 256 && usedValues[nextLongOptValue]) {
+                nextLongOptValue++;
+            }
+            symbol.optionValue = std::to_string(nextLongOptValue++);
+        } else {
+            continue;
+        }
+
+        // Only a duplicate ShortOpt gives the same value, which the SemanticAnalyzer reports
+        auto inserted = optionValues.emplace(symbol.optionValue, i);
+        if (!inserted.second && options[inserted.first->second].getShortOpt() != option.getShortOpt()) {
+            addError(collision(options, inserted.first->second, i, "case label", symbol.optionValue));
+        }
+    }
+}
+
+const std::vector<std::string> &SymbolTable::getErrors() const {
+    return errors;
+}
+
+std::size_t SymbolTable::size() const {
+    return symbols.size();
+}
+
+const OptionSymbol &SymbolTable::getSymbol(std::size_t index) const {
+    return symbols[index];
+}
+
+const std::vector<OptionSymbol> &SymbolTable::getSymbols() const {
+    return symbols;
+}
+
+std::string SymbolTable::toIdentifier(const std::string &name) {
+    std::string identifier;
+    identifier.reserve(name.size());
+    bool capitalizeNext = false;
+    for (std::size_t i = 0; i < name.size(); i++) {
+        char c = name[i];
+        if (i == 0) {
+            c = (char) tolower((unsigned char) c);
+        }
+        if (isSeparator(c)) {
+            capitalizeNext = true;
+            continue;
+        }
+        identifier.push_back(capitalizeNext ? (char) toupper((unsigned char) c) : c);
+        capitalizeNext = false;
+    }
+    return identifier;
+}
+
+const char *SymbolTable::valueTypeOf(const Option &option) {
+    switch (option.getConvertTo()) {
+        case ConvertToOptions::STRING:
+            return "std::string";
+        case ConvertToOptions::INTEGER:
+            return "int";
+        case ConvertToOptions::BOOLEAN:
+            return "bool";
+        default:
+            return "";
+    }
+}
+
+void SymbolTable::addError(const std::string &message) {
+    LOG_ERROR(message);
+    errors.push_back(message);
+}
@@ -0,0 +1,46 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "TaskPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+void TaskPool::run(const std::vector<std::function<void()>> &tasks, unsigned int threads) {
+    if (threads <= 1 || tasks.size() <= 1) {
+        for (auto &task: tasks) {
+            task();
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::vector<std::exception_ptr> errors(tasks.size());
+    auto work = [&tasks, &next, &errors]() {
+        for (std::size_t i = next++; i < tasks.size(); i = next++) {
+            try {
+                tasks[i]();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    unsigned int helpers = std::min<unsigned int>(threads, (unsigned int) tasks.size()) - 1;
+    for (unsigned int i = 0; i < helpers; i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    for (auto &error: errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
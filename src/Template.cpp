@@ -0,0 +1,178 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "Template.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <algorithm>
+
+/**
+ * @brief Checks whether a part of a text is blank
+ * @param begin first character
+ * @param end character after the last one
+ * @return true if it only contains spaces and tabs
+ */
+static bool isBlank(const char *begin, const char *end) {
+    return std::all_of(begin, end, [](char c) { return c == ' ' || c == '\t'; });
+}
+
+Template::Template(const std::string &_name, const std::string &text, const std::vector<std::string> &names)
+        : name(_name) {
+    auto fail = [this, &text](std::size_t position, const std::string &message) {
+        std::string error = "Template " + name + " line "
+                            + std::to_string(std::count(text.begin(), text.begin() + position, '\n') + 1)
+                            + ": " + message;
+        LOG_ERROR(error);
+        throw GeneratorException(error);
+    };
+
+    // Open sections, innermost last
+    std::vector<std::size_t> sections;
+    std::size_t position = 0;
+    while (true) {
+        std::size_t open = text.find("{{", position);
+        if (open == std::string::npos) {
+            appendText(text.data() + position, text.size() - position);
+            break;
+        }
+        std::size_t close = text.find("}}", open + 2);
+        if (close == std::string::npos) {
+            fail(open, "unterminated tag");
+        }
+        std::string tag = text.substr(open + 2, close - open - 2);
+        char kind = tag.empty() ? '\0' : tag[0];
+        if (kind == '#' || kind == '^' || kind == '/' || kind == '>' || kind == '!') {
+            tag.erase(0, 1);
+        } else {
+            kind = '\0';
+        }
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+
+        // A tag alone on its line takes the whole line with it
+        std::size_t textEnd = open;
+        std::size_t next = close + 2;
+        if (kind != '\0') {
+            std::size_t lineStart = text.rfind('\n', open);
+            lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+            std::size_t lineEnd = text.find('\n', next);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+            if (lineStart >= position && isBlank(text.data() + lineStart, text.data() + open)
+                && isBlank(text.data() + next, text.data() + lineEnd)) {
+                textEnd = lineStart;
+                next = lineEnd == text.size() ? lineEnd : lineEnd + 1;
+            }
+        }
+        appendText(text.data() + position, textEnd - position);
+        position = next;
+        if (kind == '!') {
+            continue;
+        }
+
+        auto found = std::find(names.begin(), names.end(), tag);
+        if (tag.empty() || found == names.end()) {
+            fail(open, "unknown name \"" + tag + "\"");
+        }
+        int index = (int) (found - names.begin());
+        switch (kind) {
+            case '#':
+            case '^':
+                sections.push_back(instructions.size());
+                instructions.push_back({kind == '#' ? Operation::SECTION : Operation::INVERTED, index, 0, 0});
+                break;
+            case '/': {
+                if (sections.empty() || instructions[sections.back()].name != index) {
+                    fail(open, "{{/" + tag + "}} does not close the innermost section");
+                }
+                Instruction &section = instructions[sections.back()];
+                section.target = instructions.size();
+                instructions.push_back({section.operation == Operation::SECTION ? Operation::END
+                                                                                : Operation::INVERTED_END,
+                                        index, sections.back(), 0});
+                sections.pop_back();
+                break;
+            }
+            case '>':
+                instructions.push_back({Operation::PARTIAL, index, 0, 0});
+                break;
+            default:
+                instructions.push_back({Operation::VALUE, index, 0, 0});
+                break;
+        }
+    }
+    if (!sections.empty()) {
+        fail(text.size(), "section " + names[instructions[sections.back()].name] + " is not closed");
+    }
+}
+
+void Template::appendText(const char *text, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    if (!instructions.empty() && instructions.back().operation == Operation::TEXT) {
+        instructions.back().size += size;
+    } else {
+        instructions.push_back({Operation::TEXT, -1, literals.size(), size});
+    }
+    literals.append(text, size);
+}
+
+void Template::render(FILE *out, TemplateContext &context) const {
+    // Lists with more than one item, innermost last
+    struct Loop {
+        std::size_t section;
+        std::size_t item;
+        std::size_t count;
+    };
+    std::vector<Loop> loops;
+
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+        const Instruction &instruction = instructions[i];
+        switch (instruction.operation) {
+            case Operation::TEXT:
+                fwrite(literals.data() + instruction.target, 1, instruction.size, out);
+                break;
+            case Operation::VALUE:
+                context.writeValue(out, instruction.name);
+                break;
+            case Operation::PARTIAL:
+                context.writePartial(out, instruction.name);
+                break;
+            case Operation::SECTION: {
+                std::size_t count = context.getCount(instruction.name);
+                if (count == 0) {
+                    i = instruction.target;
+                    break;
+                }
+                context.selectItem(instruction.name, 0);
+                if (count > 1) {
+                    loops.push_back({i, 0, count});
+                }
+                break;
+            }
+            case Operation::INVERTED:
+                if (context.getCount(instruction.name) != 0) {
+                    i = instruction.target;
+                }
+                break;
+            case Operation::END:
+                if (!loops.empty() && loops.back().section == instruction.target) {
+                    Loop &loop = loops.back();
+                    if (++loop.item < loop.count) {
+                        context.selectItem(instruction.name, loop.item);
+                        i = loop.section;
+                    } else {
+                        loops.pop_back();
+                    }
+                }
+                break;
+            case Operation::INVERTED_END:
+                break;
+        }
+    }
+}
+
+const std::string &Template::getName() const {
+    return name;
+}
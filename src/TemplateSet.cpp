@@ -0,0 +1,464 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+#include "TemplateSet.h"
+#include "ContentHash.h"
+#include "GeneratorException.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <boost/filesystem.hpp>
+
+/**
+ * @brief Names as used in the templates, indexed by TemplateSet::Name
+ */
+static const char *const nameStrings[] = {
+        "headerGuard", "shortOpts", "sharded", "shards", "shard",
+        "structArgs", "values", "headerGetters", "externalFunctions", "sourceGetters",
+        "handling", "exclusions", "longOptions", "cases", "help",
+        "messages", "message", "conversionTypes", "conversionType", "usesMissingArgument",
+        "usesUnexpectedArgument", "usesConflictingOptions", "usesBooleanValue",
+        "className", "namespace", "headerFileName", "first",
+        "argsName", "capitalizedName", "valueType", "optionValue", "longOpt",
+        "argumentKind", "optionFlags", "defaultValue", "internalMethod", "externalMethod",
+        "excluded", "excludedName", "hasArgument", "requiredArgument", "optionalArgument",
+        "boolean", "hasDefault", "hasGetter", "hasValueGetter", "hasInternalMethod",
+        "hasExternalMethod", "hasLongOpt", "reachable", "flagsMessage", "nameMessage",
+        "excludedMessage", "handled", "checked"
+};
+static_assert(sizeof(nameStrings) / sizeof(nameStrings[0]) == TemplateSet::NAME_COUNT,
+              "Every name needs its string");
+
+/**
+ * @brief File names of the templates, indexed by TemplateSet::Kind
+ */
+static const char *const fileNames[] = {
+        "header.tpl", "source.tpl", "shard.tpl", "help.tpl",
+        "struct_args.tpl", "value.tpl", "header_getter.tpl", "external_function.tpl", "source_getter.tpl",
+        "handling.tpl", "exclusions.tpl", "long_option.tpl", "case.tpl"
+};
+static_assert(sizeof(fileNames) / sizeof(fileNames[0]) == TemplateSet::TEMPLATE_COUNT,
+              "Every template needs its file name");
+
+/**
+ * @brief The default set, indexed by TemplateSet::Kind
+ */
+static const char *const defaultTemplates[] = {
+// header.tpl
+R"tpl(#ifndef {{headerGuard}}_H
+#define {{headerGuard}}_H
+
+#include <getopt.h>
+#include <iostream>
+#include <boost/lexical_cast.hpp>
+
+{{#namespace}}
+namespace {{namespace}} {
+
+{{/namespace}}
+class {{className}} {
+private:
+struct Args {
+{{>structArgs}}
+};
+
+Args args;
+{{>values}}
+static const char *const messages[];
+{{#usesMissingArgument}}
+[[noreturn]] static void missingArgument(std::size_t flags);
+{{/usesMissingArgument}}
+{{#usesUnexpectedArgument}}
+[[noreturn]] static void unexpectedArgument(std::size_t flags);
+{{/usesUnexpectedArgument}}
+{{#usesConflictingOptions}}
+[[noreturn]] static void conflictingOptions(std::size_t name, std::size_t excludedName);
+{{/usesConflictingOptions}}
+{{#usesBooleanValue}}
+static const char *booleanValue(const char *arg);
+{{/usesBooleanValue}}
+{{#conversionTypes}}
+static void convertValue(const std::string &value, {{conversionType}} &target, std::size_t name);
+{{/conversionTypes}}
+{{#shards}}
+void checkExclusions{{shard}}();
+void handleOptions{{shard}}();
+bool dispatch{{shard}}(int opt);
+{{/shards}}
+virtual void printVersion();
+
+protected:
+virtual void printHelp();
+
+public:
+void parse();
+{{>headerGetters}}
+{{>externalFunctions}}
+void parseOptions(int argc, char **argv);
+virtual void unknownOption(const std::string &unknownOption);
+
+};
+{{#namespace}}
+}
+{{/namespace}}
+
+#endif //{{headerGuard}}_H)tpl",
+// source.tpl
+R"tpl(#include "{{headerFileName}}"
+
+
+{{#namespace}}
+namespace {{namespace}} {
+
+{{/namespace}}
+const char *const {{className}}::messages[] = {
+{{#messages}}
+"{{message}}",
+{{/messages}}
+nullptr
+};
+{{#usesMissingArgument}}
+void {{className}}::missingArgument(std::size_t flags) {
+perror(("There was no argument passed for the option \"" + std::string(messages[flags]) + "\" which requires one.").c_str());
+exit(1);
+}
+{{/usesMissingArgument}}
+{{#usesUnexpectedArgument}}
+void {{className}}::unexpectedArgument(std::size_t flags) {
+perror(("There was an argument passed for the option \"" + std::string(messages[flags]) + "\" which does not accept one.").c_str());
+exit(1);
+}
+{{/usesUnexpectedArgument}}
+{{#usesConflictingOptions}}
+void {{className}}::conflictingOptions(std::size_t name, std::size_t excludedName) {
+perror((std::string(messages[name]) + " and " + messages[excludedName] + " cannot be used together.").c_str());
+exit(1);
+}
+{{/usesConflictingOptions}}
+{{#usesBooleanValue}}
+const char *{{className}}::booleanValue(const char *arg) {
+if(strcmp(arg, "true"))
+return "1";
+else if(strcmp(arg, "false"))
+return "0";
+return arg;
+}
+{{/usesBooleanValue}}
+{{#conversionTypes}}
+void {{className}}::convertValue(const std::string &value, {{conversionType}} &target, std::size_t name) {
+if (!value.empty()) {
+try {
+target = boost::lexical_cast<{{conversionType}}>(value);
+} catch (boost::bad_lexical_cast &) {
+perror((std::string(messages[name]) + " is not convertible to {{conversionType}}.").c_str());
+}
+}
+}
+{{/conversionTypes}}
+{{^sharded}}
+{{>sourceGetters}}
+{{/sharded}}
+void {{className}}::printVersion(){
+printf("version: 1.0.0\n");
+}
+void {{className}}::parse() {
+{{#shards}}
+checkExclusions{{shard}}();
+{{/shards}}
+{{#shards}}
+handleOptions{{shard}}();
+{{/shards}}
+{{^sharded}}
+{{>exclusions}}
+{{>handling}}
+{{/sharded}}
+}
+void {{className}}::parseOptions(int argc, char **argv){
+args = Args();
+opterr = 0;
+int opt;
+static struct option long_options[] = {
+{{>longOptions}}
+{0, 0, 0, 0}
+};
+int option_index = 0;
+
+while ((opt = getopt_long (argc, argv, "{{shortOpts}}", long_options, &option_index)) != -1){
+{{#sharded}}
+if ({{#shards}}{{^first}} && {{/first}}!dispatch{{shard}}(opt){{/shards}}) {
+unknownOption(std::to_string(optopt));
+}
+{{/sharded}}
+{{^sharded}}
+switch (opt) {
+{{>cases}}
+case '?':
+default:
+unknownOption(std::to_string(optopt));
+break;}
+{{/sharded}}
+}
+if (optind < argc){
+printf("non-option ARGV-elements: ");
+while (optind < argc)
+printf("%s ", argv[optind++]);
+printf("\n");
+}
+parse();
+}
+void {{className}}::unknownOption(const std::string &unknownOption){
+perror("GetOpt encountered an unknown option.");
+exit(1);
+}
+{{^sharded}}
+{{>help}}{{/sharded}}{{#namespace}}}
+{{/namespace}}
+)tpl",
+// shard.tpl
+R"tpl(#include "{{headerFileName}}"
+
+{{#namespace}}
+namespace {{namespace}} {
+
+{{/namespace}}
+{{>sourceGetters}}
+void {{className}}::checkExclusions{{shard}}() {
+{{>exclusions}}
+}
+void {{className}}::handleOptions{{shard}}() {
+{{>handling}}
+}
+bool {{className}}::dispatch{{shard}}(int opt) {
+switch (opt) {
+{{>cases}}
+default:
+return false;
+}
+return true;
+}
+{{#namespace}}
+}
+{{/namespace}}
+)tpl",
+// help.tpl
+R"tpl(#include "{{headerFileName}}"
+
+{{#namespace}}
+namespace {{namespace}} {
+
+{{/namespace}}
+{{>help}}{{#namespace}}}
+{{/namespace}}
+)tpl",
+// struct_args.tpl
+R"tpl(struct {
+bool isSet = false;
+{{#hasArgument}}
+std::string value;
+{{/hasArgument}}
+} {{argsName}};
+)tpl",
+// value.tpl
+R"tpl({{#hasArgument}}
+{{valueType}} {{argsName}}Value{{#hasDefault}} = {{defaultValue}}{{/hasDefault}};
+{{/hasArgument}}
+)tpl",
+// header_getter.tpl
+R"tpl({{#hasGetter}}
+bool isSet{{capitalizedName}}() const;
+{{/hasGetter}}
+{{#hasValueGetter}}
+{{valueType}} getValueOf{{capitalizedName}}() const;
+{{/hasValueGetter}}
+)tpl",
+// external_function.tpl
+R"tpl({{#hasExternalMethod}}
+virtual void {{externalMethod}}({{#hasArgument}}{{valueType}} arg{{/hasArgument}}) = 0;
+{{/hasExternalMethod}}
+)tpl",
+// source_getter.tpl
+R"tpl({{#hasGetter}}
+bool {{className}}::isSet{{capitalizedName}}() const {
+return args.{{argsName}}.isSet;
+}
+{{/hasGetter}}
+{{#hasValueGetter}}
+{{valueType}} {{className}}::getValueOf{{capitalizedName}}() const{
+return {{argsName}}Value;
+}
+{{/hasValueGetter}}
+)tpl",
+// handling.tpl
+R"tpl({{#handled}}
+if (args.{{argsName}}.isSet) {
+{{#hasArgument}}
+convertValue(args.{{argsName}}.value, {{argsName}}Value, {{nameMessage}});
+{{/hasArgument}}
+{{#hasInternalMethod}}
+{{internalMethod}}({{#hasArgument}}{{argsName}}Value{{/hasArgument}});
+{{/hasInternalMethod}}
+{{#hasExternalMethod}}
+{{externalMethod}}({{#hasArgument}}{{argsName}}Value{{/hasArgument}});
+{{/hasExternalMethod}}
+}
+{{/handled}}
+)tpl",
+// exclusions.tpl
+R"tpl({{#checked}}
+if (args.{{argsName}}.isSet) {
+{{#excluded}}
+if (args.{{excludedName}}.isSet) {
+conflictingOptions({{nameMessage}}, {{excludedMessage}});
+}
+{{/excluded}}
+}
+{{/checked}}
+)tpl",
+// long_option.tpl
+R"tpl({{#hasLongOpt}}
+{"{{longOpt}}", {{argumentKind}}, 0, {{optionValue}}},
+{{/hasLongOpt}}
+)tpl",
+// case.tpl
+R"tpl({{#reachable}}
+case {{optionValue}}:
+{{#requiredArgument}}
+if(optarg == nullptr)
+missingArgument({{flagsMessage}});
+args.{{argsName}}.value = {{#boolean}}booleanValue(optarg){{/boolean}}{{^boolean}}optarg{{/boolean}};
+{{/requiredArgument}}
+{{#optionalArgument}}
+if(optarg != nullptr)
+args.{{argsName}}.value = {{#boolean}}booleanValue(optarg){{/boolean}}{{^boolean}}optarg{{/boolean}};
+{{/optionalArgument}}
+{{^hasArgument}}
+if(optarg != nullptr)
+unexpectedArgument({{flagsMessage}});
+{{/hasArgument}}
+args.{{argsName}}.isSet = true;break;
+{{/reachable}}
+)tpl"
+};
+static_assert(sizeof(defaultTemplates) / sizeof(defaultTemplates[0]) == TemplateSet::TEMPLATE_COUNT,
+              "Every template needs its default");
+
+namespace {
+    std::mutex setsMutex;
+    /**
+     * @brief Compiled sets by directory
+     */
+    std::map<std::string, std::unique_ptr<TemplateSet>> sets;
+    /**
+     * @brief Sets replaced by reload(), kept because callers may still hold them
+     */
+    std::vector<std::unique_ptr<TemplateSet>> reloadedSets;
+}
+
+const TemplateSet &TemplateSet::get(const std::string &dir) {
+    // Compiled sets are kept for the whole process, a failed set is compiled again on the next call
+    std::lock_guard<std::mutex> lock(setsMutex);
+    std::unique_ptr<TemplateSet> &set = sets[dir];
+    if (!set) {
+        set.reset(new TemplateSet(dir));
+    }
+    return *set;
+}
+
+void TemplateSet::reload(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(setsMutex);
+    auto set = sets.find(dir);
+    if (set != sets.end() && set->second) {
+        LOG_INFO("Reloading the templates of " + dir);
+        reloadedSets.push_back(std::move(set->second));
+        sets.erase(set);
+    }
+}
+
+TemplateSet::TemplateSet(const std::string &dir) {
+    if (!dir.empty() && !boost::filesystem::is_directory(dir)) {
+        LOG_ERROR("Template directory " + dir + " does not exist");
+        throw GeneratorException("Template directory " + dir + " does not exist");
+    }
+    std::vector<std::string> fileScope(nameStrings, nameStrings + OPTION_NAMES_BEGIN);
+    std::vector<std::string> optionScope(nameStrings, nameStrings + NAME_COUNT);
+    std::fill(optionScope.begin(), optionScope.begin() + SHARED_NAMES_BEGIN, "");
+    // The templates before EXCLUSIONS may be rendered while the spec is parsed, before the
+    // getopt values and exclusions are known
+    std::vector<std::string> streamedScope = optionScope;
+    for (Name name: {OPTION_VALUE, REACHABLE, EXCLUDED, EXCLUDED_NAME, EXCLUDED_MESSAGE, CHECKED}) {
+        streamedScope[name] = "";
+    }
+
+    // A misspelled template would otherwise be ignored and the default one used silently
+    if (!dir.empty()) {
+        for (auto &entry: boost::filesystem::directory_iterator(dir)) {
+            if (entry.path().extension() == ".tpl"
+                && std::find(fileNames, fileNames + TEMPLATE_COUNT, entry.path().filename().string())
+                   == fileNames + TEMPLATE_COUNT) {
+                LOG_ERROR("Unknown template " + entry.path().string());
+                throw GeneratorException("Unknown template " + entry.path().string());
+            }
+        }
+    }
+
+    uint64_t hash = ContentHash::offsetBasis;
+    bool custom = false;
+    for (int kind = 0; kind < TEMPLATE_COUNT; kind++) {
+        std::string text = defaultTemplates[kind];
+        if (!dir.empty()) {
+            std::string path = (boost::filesystem::path(dir) / fileNames[kind]).string();
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                LOG_ERROR("Template " + path + " is missing");
+                throw GeneratorException("Template " + path + " is missing, --dump-templates writes all of them");
+            }
+            std::ostringstream content;
+            content << in.rdbuf();
+            text = content.str();
+            hash = ContentHash::ofString(std::string(fileNames[kind]) + '\0' + text, hash);
+            custom = true;
+            files.push_back(path);
+            LOG_INFO("Using template " + path);
+        }
+        templates.emplace_back(fileNames[kind], text, kind < FILE_TEMPLATE_COUNT ? fileScope
+                                                      : kind < EXCLUSIONS ? streamedScope : optionScope);
+    }
+    if (custom) {
+        fingerprint = "+templates" + ContentHash::toHex(hash);
+    }
+}
+
+void TemplateSet::writeDefaults(const std::string &dir) {
+    boost::system::error_code error;
+    boost::filesystem::create_directories(dir, error);
+    for (int kind = 0; kind < TEMPLATE_COUNT; kind++) {
+        std::string path = (boost::filesystem::path(dir) / fileNames[kind]).string();
+        if (boost::filesystem::exists(path)) {
+            // Own templates are never overwritten
+            LOG_WARN("Not overwriting existing template " + path);
+            continue;
+        }
+        std::ofstream out(path, std::ios::binary);
+        if (!(out << defaultTemplates[kind]) || !out.flush()) {
+            LOG_ERROR("Could not write " + path);
+            throw GeneratorException("Could not write " + path);
+        }
+    }
+}
+
+const Template &TemplateSet::getTemplate(Kind kind) const {
+    return templates[kind];
+}
+
+const std::string &TemplateSet::getFingerprint() const {
+    return fingerprint;
+}
+
+const std::vector<std::string> &TemplateSet::getFiles() const {
+    return files;
+}
@@ -2,71 +2,154 @@
  * Editors: Tobias Goetz
  */
 
+#include <xercesc/framework/MemBufInputSource.hpp>
 #include <xercesc/parsers/SAXParser.hpp>
 #include <xercesc/util/OutOfMemoryException.hpp>
 
 #include "XMLParser.h"
+#include "GeneratorException.h"
+#include "SpecVocabulary.h"
 #include "Logger.h"
 
+#include <cstddef>
 #include <iostream>
+#include <mutex>
 
 XERCES_CPP_NAMESPACE_USE
 using namespace std;
 
-XMLParser::XMLParser(const std::string &filename) {
-    this->filename = filename;
+XMLParser::XMLParser(const std::string &filename) : SpecParser(filename) {
 }
 
-void XMLParser::parse() {
-    LOG_INFO("Starting parsing of file " + filename);
-    try {
-        XMLPlatformUtils::Initialize();
+XMLParser::BudgetMemoryManager::BudgetMemoryManager(SpecMemoryBudget &memoryBudget) : memoryBudget(memoryBudget) {
+}
+
+MemoryManager *XMLParser::BudgetMemoryManager::getExceptionMemoryManager() {
+    return XMLPlatformUtils::fgMemoryManager;
+}
+
+namespace {
+    /**
+     * @brief Header in front of every block of the BudgetMemoryManager, keeps the blocks aligned
+     */
+    union BlockHeader {
+        XMLSize_t size;
+        std::max_align_t alignment;
+    };
+
+    /**
+     * @brief Transcodes a name for the trace log, the memory is freed at once
+     */
+    std::string transcoded(const XMLCh *name) {
+        char *chars = XMLString::transcode(name);
+        std::string text(chars);
+        XMLString::release(&chars);
+        return text;
     }
-    catch (const XMLException& toCatch) {
-        char* message = XMLString::transcode(toCatch.getMessage());
-        cerr << "Error during initialization! :\n"
-             << message << "\n";
-        XMLString::release(&message);
+}
+
+void *XMLParser::BudgetMemoryManager::allocate(XMLSize_t size) {
+    // Charged first, a spec over its budget fails before the memory is taken
+    memoryBudget.charge(size);
+    auto *header = (BlockHeader *) XMLPlatformUtils::fgMemoryManager->allocate(sizeof(BlockHeader) + size);
+    header->size = size;
+    return header + 1;
+}
+
+void XMLParser::BudgetMemoryManager::deallocate(void *p) {
+    if (p == nullptr) {
+        return;
     }
+    BlockHeader *header = (BlockHeader *) p - 1;
+    memoryBudget.release(header->size);
+    XMLPlatformUtils::fgMemoryManager->deallocate(header);
+}
+
+namespace {
+    /**
+     * @brief Initializes Xerces once per process, XMLPlatformUtils::Initialize is not thread-safe
+     */
+    std::once_flag xercesInitialization;
+}
+
+void XMLParser::initialize() {
+    // A failed initialization leaves the flag unset, the next call tries again
+    std::call_once(xercesInitialization, []() {
+        try {
+            XMLPlatformUtils::Initialize();
+        }
+        catch (const XMLException& toCatch) {
+            char* message = XMLString::transcode(toCatch.getMessage());
+            std::string text(message);
+            XMLString::release(&message);
+            LOG_ERROR("Error during initialization of Xerces: " + text);
+            throw GeneratorException("Error during initialization! : " + text);
+        }
+    });
+}
+
+void XMLParser::terminate() {
+    //Terminate muss immer am Schluss stehen
+    XMLPlatformUtils::Terminate();
+}
 
-    auto* parser = new SAXParser;
+void XMLParser::parse() {
+    initialize();
+    // With a budget, the allocations of Xerces are charged to the spec as well
+    SAXParser parser(nullptr, memoryBudget.getLimit() != 0 ? &memoryManager : XMLPlatformUtils::fgMemoryManager);
+    parse(parser);
+}
+
+void XMLParser::parse(SAXParser &parser) {
+    LOG_INFO("Starting parsing of file " + filename);
 
-    int errorCount = {0};
+    XMLSize_t errorCount = {0};
 
     try
     {
         //Das eigentliche Parsen der Datei
-        parser->setDocumentHandler(this);
-        parser->parse(this->filename.c_str());
-        errorCount = parser->getErrorCount();
+        parser.setDocumentHandler(this);
+        if (buffer != nullptr) {
+            MemBufInputSource source((const XMLByte *) buffer, bufferSize, filename.c_str());
+            parser.parse(source);
+        } else {
+            parser.parse(this->filename.c_str());
+        }
+        errorCount = parser.getErrorCount();
     }
     catch (const OutOfMemoryException&)
     {
-        XERCES_STD_QUALIFIER cerr << "OutOfMemoryException" << XERCES_STD_QUALIFIER endl;
+        LOG_ERROR("OutOfMemoryException during parsing of file " + filename);
+        throw GeneratorException("OutOfMemoryException");
     }
     catch (const XMLException& toCatch)
     {
         char* message = XMLString::transcode(toCatch.getMessage());
-
-        cerr << "XMLException: " << message << endl;
-    }
-    catch(...) {
-        cerr << "Unbekannter Fehler" << endl;
+        std::string text(message);
+        XMLString::release(&message);
+        LOG_ERROR("XMLException during parsing of file " + filename + ": " + text);
+        throw GeneratorException("XMLException: " + text);
     }
 
     if (errorCount > 0) {
         LOG_ERROR("There were " + to_string(errorCount) + " errors during parsing of file " + filename);
-        perror("There were errors during parsing.");
-        exit(1);
+        throw GeneratorException("There were errors during parsing.");
     }
 
-    //Parser sauber beenden
-    delete parser;
-    //Terminate muss immer am Schluss stehen
-    XMLPlatformUtils::Terminate();
     LOG_INFO("Finished parsing of file " + filename);
 }
 
+void XMLParser::setDocumentLocator(const Locator *const _locator) {
+    locator = _locator;
+}
+
+string XMLParser::getLocation() const {
+    if (locator == nullptr) {
+        return filename;
+    }
+    return filename + ":" + to_string(locator->getLineNumber()) + ":" + to_string(locator->getColumnNumber());
+}
+
 void XMLParser::startDocument() {
 //    cout << "Start Document" << endl;
 }
@@ -76,111 +159,64 @@ void XMLParser::endDocument() {
 }
 
 void XMLParser::startElement(const XMLCh *const name, AttributeList &attributes) {
-    LOG_TRACE("Start Element: " + string(XMLString::transcode(name)));
-    if (!XMLString::compareString(name, u"GetOptSetup")) {
-        sm->handleEvent(Event::GETOPTSETUPSTART);
-        getOptSetup->parseAttributes(attributes);
-    } else if (!XMLString::compareString(name, u"Author")) {
-        sm->handleEvent(Event::AUTHORSTART);
-        auto author = new Author();
-        author->parseAttributes(attributes);
-        getOptSetup->setAuthor(*author);
-    } else if (!XMLString::compareString(name, u"HeaderFileName")) {
-        sm->handleEvent(Event::HEADERFILENAMESTART);
-    } else if (!XMLString::compareString(name, u"SourceFileName")) {
-        sm->handleEvent(Event::SOURCEFILENAMESTART);
-    } else if (!XMLString::compareString(name, u"NameSpace")) {
-        sm->handleEvent(Event::NAMESPACESTART);
-    } else if (!XMLString::compareString(name, u"ClassName")) {
-        sm->handleEvent(Event::CLASSNAMESTART);
-    } else if (!XMLString::compareString(name, u"OverAllDescription")) {
-        sm->handleEvent(Event::OVERALLDESCRIPTIONSTART);
-    } else if (!XMLString::compareString(name, u"Block")) {
-        sm->handleEvent(Event::BLOCKSTART);
-    } else if (!XMLString::compareString(name, u"SampleUsage")) {
-        sm->handleEvent(Event::SAMPLEUSAGESTART);
-    } else if (!XMLString::compareString(name, u"Sample")) {
-        sm->handleEvent(Event::SAMPLESTART);
-    } else if (!XMLString::compareString(name, u"Options")) {
-        sm->handleEvent(Event::OPTIONSSTART);
-    }  else if (!XMLString::compareString(name, u"Option")) {
-        sm->handleEvent(Event::OPTIONSTART);
-        auto option = new Option();
-        option->parseAttributes(attributes);
-        getOptSetup->addOption(*option);
+    LOG_TRACE("Start Element: " << transcoded(name));
+    SpecElement element = SpecVocabulary::element(name);
+    if (element == SpecElement::UNKNOWN) {
+        return;
+    }
+    flushCharacters();
+    handleEvent(SpecVocabulary::startEvent(element));
+    switch (element) {
+        case SpecElement::GETOPTSETUP:
+            getOptSetup->parseAttributes(attributes, &memoryManager);
+            break;
+        case SpecElement::AUTHOR: {
+            Author author;
+            author.parseAttributes(attributes, &memoryManager);
+            getOptSetup->setAuthor(author);
+            break;
+        }
+        case SpecElement::OPTION: {
+            memoryBudget.charge(sizeof(Option));
+            Option option;
+            option.parseAttributes(attributes, &memoryManager);
+            addOption(option);
+            break;
+        }
+        default:
+            break;
     }
 }
 
 void XMLParser::endElement(const XMLCh *const name) {
-    LOG_TRACE("End Element: " + string(XMLString::transcode(name)));
-    if (!XMLString::compareString(name, u"GetOptSetup")) {
-        sm->handleEvent(Event::GETOPTSETUPEND);
-    } else if (!XMLString::compareString(name, u"Author")) {
-        sm->handleEvent(Event::AUTHOREND);
-    } else if (!XMLString::compareString(name, u"HeaderFileName")) {
-        sm->handleEvent(Event::HEADERFILENAMEEND);
-    } else if (!XMLString::compareString(name, u"SourceFileName")) {
-        sm->handleEvent(Event::SOURCEFILENAMEEND);
-    } else if (!XMLString::compareString(name, u"NameSpace")) {
-        sm->handleEvent(Event::NAMESPACEEND);
-    } else if (!XMLString::compareString(name, u"ClassName")) {
-        sm->handleEvent(Event::CLASSNAMEEND);
-    } else if (!XMLString::compareString(name, u"OverAllDescription")) {
-        sm->handleEvent(Event::OVERALLDESCRIPTIONEND);
-    } else if (!XMLString::compareString(name, u"Block")) {
-        sm->handleEvent(Event::BLOCKEND);
-    } else if (!XMLString::compareString(name, u"SampleUsage")) {
-        sm->handleEvent(Event::SAMPLEUSAGEEND);
-    } else if (!XMLString::compareString(name, u"Sample")) {
-        sm->handleEvent(Event::SAMPLEEND);
-    } else if (!XMLString::compareString(name, u"Options")) {
-        sm->handleEvent(Event::OPTIONSEND);
-    }  else if (!XMLString::compareString(name, u"Option")) {
-        sm->handleEvent(Event::OPTIONEND);
+    LOG_TRACE("End Element: " << transcoded(name));
+    SpecElement element = SpecVocabulary::element(name);
+    if (element != SpecElement::UNKNOWN) {
+        flushCharacters();
+        handleEvent(SpecVocabulary::endEvent(element));
     }
 }
 
 void XMLParser::characters(const XMLCh *const chars, const XMLSize_t length) {
-    LOG_TRACE("Characters: " + string(XMLString::transcode(chars)));
-    switch (sm->getState()) {
-        case State::START:
-            break;
-        case State::GETOPTSETUP:
-            break;
-        case State::AUTHOR:
-            break;
-        case State::HEADERFILENAME:
-            getOptSetup->setHeaderFileName(std::string(XMLString::transcode(chars)));
-            break;
-        case State::SOURCEFILENAME:
-            getOptSetup->setSourceFileName(std::string(XMLString::transcode(chars)));
-            break;
-        case State::NAMESPACE:
-            getOptSetup->setNamespaceName(std::string(XMLString::transcode(chars)));
-            break;
-        case State::CLASSNAME:
-            getOptSetup->setClassName(std::string(XMLString::transcode(chars)));
-            break;
-        case State::OVERALLDESCRIPTION:
-            break;
-        case State::BLOCK:
-            getOptSetup->addOverAllDescription(std::string(XMLString::transcode(chars)));
-            break;
-        case State::SAMPLEUSAGE:
-            break;
-        case State::SAMPLE:
-            getOptSetup->addSampleUsage(std::string(XMLString::transcode(chars)));
-            break;
-        case State::OPTIONS:
-            break;
-        case State::OPTION:
-            break;
-        case State::END:
-            break;
+    // Chunks are only collected, flushCharacters() transcodes the whole text node at once
+    if (isTextState()) {
+        // The buffer is reused, only its growth beyond the largest text node so far is charged
+        std::size_t textBytes = (pendingText.size() + length) * sizeof(XMLCh);
+        if (textBytes > chargedTextBytes) {
+            memoryBudget.charge(textBytes - chargedTextBytes);
+            chargedTextBytes = textBytes;
+        }
+        pendingText.append(chars, length);
     }
 }
 
-GetOptSetup *XMLParser::getGetOptSetup() const {
-    return getOptSetup;
+void XMLParser::flushCharacters() {
+    if (pendingText.empty()) {
+        return;
+    }
+    char *text = XMLString::transcode(pendingText.c_str(), &memoryManager);
+    LOG_TRACE("Characters: " << text);
+    handleCharacters(text);
+    XMLString::release(&text, &memoryManager);
+    pendingText.clear();
 }
-
@@ -0,0 +1,373 @@
+/*
+ * Editors: Tobias Goetz, Noel Kempter
+ */
+#include "CodeGenerator.h"
+#include "GeneratorClient.h"
+#include "GeneratorServer.h"
+#include "TemplateSet.h"
+#include "Logger.h"
+#include "Version.h"
+#include <getopt.h>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+
+/**
+ * @brief Name of the environment variable with the socket of a running server
+ */
+static const char *const serverVariable = "CODEGENERATOR_SERVER";
+
+/**
+ * @brief Name of the environment variable with the directory of the output cache
+ */
+static const char *const outputCacheEnvironment = "CODEGENERATOR_OUTPUT_CACHE";
+
+/**
+ * @brief Size of the output cache unless --output-cache-size is given
+ */
+static const std::size_t defaultOutputCacheSize = 1024 * 1024 * 1024;
+
+/**
+ * @brief Parses a size in bytes, plain or with a K, M or G suffix
+ * @param text the size
+ * @param bytes receives the size
+ * @return false if the text is not a size or the size does not fit into size_t
+ */
+static bool parseBytes(const char *text, std::size_t &bytes) {
+    std::string value = text != nullptr ? text : "";
+    std::size_t factor = 1;
+    if (!value.empty() && strchr("kKmMgG", value.back()) != nullptr) {
+        char suffix = (char) tolower(value.back());
+        factor = suffix == 'k' ? 1024 : suffix == 'm' ? 1024 * 1024 : 1024 * 1024 * 1024;
+        value.pop_back();
+    }
+    // lexical_cast accepts a sign and wraps negative values around
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    std::size_t number;
+    try {
+        number = boost::lexical_cast<std::size_t>(value);
+    } catch (boost::bad_lexical_cast &) {
+        return false;
+    }
+    if (number > std::numeric_limits<std::size_t>::max() / factor) {
+        return false;
+    }
+    bytes = number * factor;
+    return true;
+}
+
+/**
+ * @brief Prints the options to stdout
+ */
+static void printUsage() {
+    printf("Usage: CodeGenerator -p <spec.xml|directory> [-p ...] [options]\n"
+           "  -p, --path <spec|dir>          spec to generate, or a directory of specs\n"
+           "  -o, --output <dir>             output directory, ending with a separator\n"
+           "  -m, --manifest <file>          file listing one spec per line\n"
+           "  -j, --jobs <n>                 worker threads, 0 for one per hardware thread\n"
+           "  -f, --force                    regenerate up-to-date specs\n"
+           "  -c, --cache-dir <dir>          cache of parsed models\n"
+           "      --frontend <xerces|native> XML parser\n"
+           "      --strict                   fail specs with elements in illegal places\n"
+           "      --max-memory <bytes>       memory budget per spec, e.g. 64M\n"
+           "      --pipeline                 emit options while the spec is parsed\n"
+           "      --emit-jobs <n>            threads generating the code of a spec\n"
+           "      --shards <n>               split the source of a spec into n files\n"
+           "      --amalgamate <file>        also write all sources into one file\n"
+           "      --templates <dir>          render with the templates in dir\n"
+           "      --dump-templates <dir>     write the built-in templates into dir\n"
+           "      --depfile <file>           write a Make/Ninja depfile\n"
+           "      --output-cache <dir>       shared cache of generated files\n"
+           "      --output-cache-size <bytes> size of the output cache, e.g. 512M\n"
+           "      --watch                    regenerate specs whenever they are written\n"
+           "      --serve <socket>           serve command lines on a Unix domain socket\n"
+           "      --server-stats <socket>    print the request latencies of a server\n"
+           "  -q, --quiet                    only log warnings and errors, without log files\n"
+           "  -h, --help                     print this help\n"
+           "  -v, --version                  print the version\n");
+}
+
+/**
+ * @brief Parses the command line and runs the CodeGenerator, or the server
+ * Runs in the main process and in the children of a server.
+ * @param argc number of arguments
+ * @param argv the arguments
+ * @return exit status
+ */
+static int runCommandLine(int argc, char **argv) {
+    CodeGenerator generator;
+    std::string serverSocket;
+    bool watch = false;
+    // The cache is shared between checkouts, so it is usually configured once in the environment
+    const char *outputCacheVariable = getenv(outputCacheEnvironment);
+    std::string outputCacheDir = outputCacheVariable != nullptr ? outputCacheVariable : "";
+    std::size_t outputCacheSize = defaultOutputCacheSize;
+    int c;
+    int option_index;
+    static struct option long_options[] = {
+            {"path", required_argument, 0, 'p'},
+            {"output", required_argument, 0, 'o'},
+            {"manifest", required_argument, 0, 'm'},
+            {"jobs", required_argument, 0, 'j'},
+            {"force", no_argument, 0, 'f'},
+            {"cache-dir", required_argument, 0, 'c'},
+            {"frontend", required_argument, 0, 'F'},
+            {"strict", no_argument, 0, 'S'},
+            {"max-memory", required_argument, 0, 'M'},
+            {"pipeline", no_argument, 0, 'P'},
+            {"emit-jobs", required_argument, 0, 'E'},
+            {"shards", required_argument, 0, 'N'},
+            {"amalgamate", required_argument, 0, 'A'},
+            {"templates", required_argument, 0, 'T'},
+            {"dump-templates", required_argument, 0, 'D'},
+            {"serve", required_argument, 0, 'R'},
+            {"server-stats", required_argument, 0, 'Q'},
+            {"watch", no_argument, 0, 'W'},
+            {"depfile", required_argument, 0, 'X'},
+            {"output-cache", required_argument, 0, 'O'},
+            {"output-cache-size", required_argument, 0, 'Z'},
+            {"quiet", no_argument, 0, 'q'},
+            {"help", no_argument, 0, 'h'},
+            {"version", no_argument, 0, 'v'},
+            {0, 0, 0, 0}
+    };
+
+    while((c = getopt_long(argc, argv, "p:o:m:j:fc:qhv", long_options, &option_index)) != -1 ){
+        switch(c){
+            case 'p':
+                if (optarg == nullptr){
+                    perror("The path to the XML-File to be parsed was not set.");
+                    LOG_ERROR("The path to the XML-File to be parsed was not set.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.addFilePath(optarg);
+                break;
+            case 'o':
+                if(optarg == nullptr){
+                    perror("When using \"-o/--output\" the path to the target directory must be set.");
+                    LOG_ERROR("When using \"-o/--output\" the path to the target directory must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                    generator.setOutputDir(optarg);
+                break;
+            case 'm':
+                if (optarg == nullptr){
+                    perror("When using \"-m/--manifest\" the path to the manifest file must be set.");
+                    LOG_ERROR("When using \"-m/--manifest\" the path to the manifest file must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setManifestPath(optarg);
+                break;
+            case 'j':
+                try {
+                    generator.setJobs(boost::lexical_cast<unsigned int>(optarg));
+                } catch (boost::bad_lexical_cast &) {
+                    perror("When using \"-j/--jobs\" the number of worker threads must be set.");
+                    LOG_ERROR("When using \"-j/--jobs\" the number of worker threads must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'f':
+                generator.setForce(true);
+                break;
+            case 'c':
+                if (optarg == nullptr){
+                    perror("When using \"-c/--cache-dir\" the path to the cache directory must be set.");
+                    LOG_ERROR("When using \"-c/--cache-dir\" the path to the cache directory must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setCacheDir(optarg);
+                break;
+            case 'F': {
+                Frontend frontend;
+                if (optarg == nullptr || !SpecParser::frontendFromString(optarg, frontend)) {
+                    perror("When using \"--frontend\" it must be set to \"xerces\" or \"native\".");
+                    LOG_ERROR("When using \"--frontend\" it must be set to \"xerces\" or \"native\".");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setFrontend(frontend);
+                break;
+            }
+            case 'S':
+                generator.setStrict(true);
+                break;
+            case 'M': {
+                std::size_t bytes;
+                if (!parseBytes(optarg, bytes)) {
+                    perror("When using \"--max-memory\" the budget in bytes must be set, e.g. 64M.");
+                    LOG_ERROR("When using \"--max-memory\" the budget in bytes must be set, e.g. 64M.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setMaxMemory(bytes);
+                break;
+            }
+            case 'O':
+                if (optarg == nullptr){
+                    perror("When using \"--output-cache\" the path to the cache directory must be set.");
+                    LOG_ERROR("When using \"--output-cache\" the path to the cache directory must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                outputCacheDir = optarg;
+                break;
+            case 'Z':
+                if (!parseBytes(optarg, outputCacheSize)) {
+                    perror("When using \"--output-cache-size\" the size in bytes must be set, e.g. 512M.");
+                    LOG_ERROR("When using \"--output-cache-size\" the size in bytes must be set, e.g. 512M.");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'P':
+                generator.setPipeline(true);
+                break;
+            case 'E':
+                try {
+                    generator.setEmitJobs(boost::lexical_cast<unsigned int>(optarg));
+                } catch (boost::bad_lexical_cast &) {
+                    perror("When using \"--emit-jobs\" the number of threads per spec must be set.");
+                    LOG_ERROR("When using \"--emit-jobs\" the number of threads per spec must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'N':
+                try {
+                    generator.setShards(boost::lexical_cast<unsigned int>(optarg));
+                } catch (boost::bad_lexical_cast &) {
+                    perror("When using \"--shards\" the number of sources per spec must be set.");
+                    LOG_ERROR("When using \"--shards\" the number of sources per spec must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'A':
+                if (optarg == nullptr){
+                    perror("When using \"--amalgamate\" the name of the amalgamated source must be set.");
+                    LOG_ERROR("When using \"--amalgamate\" the name of the amalgamated source must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setAmalgamation(optarg);
+                break;
+            case 'T':
+                if (optarg == nullptr){
+                    perror("When using \"--templates\" the path to the template directory must be set.");
+                    LOG_ERROR("When using \"--templates\" the path to the template directory must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setTemplateDir(optarg);
+                break;
+            case 'D':
+                if (optarg == nullptr){
+                    perror("When using \"--dump-templates\" the path to the target directory must be set.");
+                    LOG_ERROR("When using \"--dump-templates\" the path to the target directory must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                try {
+                    TemplateSet::writeDefaults(optarg);
+                } catch (const std::exception &e) {
+                    perror(e.what());
+                    exit(EXIT_FAILURE);
+                }
+                exit(EXIT_SUCCESS);
+            case 'R':
+                if (optarg == nullptr){
+                    perror("When using \"--serve\" the path to the socket must be set.");
+                    LOG_ERROR("When using \"--serve\" the path to the socket must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                serverSocket = optarg;
+                break;
+            case 'Q':
+                if (optarg == nullptr || !GeneratorClient(optarg).printStats()){
+                    perror("When using \"--server-stats\" a server must be listening on the given socket.");
+                    LOG_ERROR("When using \"--server-stats\" a server must be listening on the given socket.");
+                    exit(EXIT_FAILURE);
+                }
+                exit(EXIT_SUCCESS);
+            case 'X':
+                if (optarg == nullptr){
+                    perror("When using \"--depfile\" the path to the depfile must be set.");
+                    LOG_ERROR("When using \"--depfile\" the path to the depfile must be set.");
+                    exit(EXIT_FAILURE);
+                }
+                generator.setDepfile(optarg);
+                break;
+            case 'q':
+                Logger::quiet();
+                break;
+            case 'h':
+                printUsage();
+                exit(EXIT_SUCCESS);
+            case 'v':
+                printf("CodeGenerator %s\n", CODEGENERATOR_VERSION);
+                exit(EXIT_SUCCESS);
+            case 'W':
+                watch = true;
+                break;
+            case '?':
+            default:
+                perror("GetOpt encountered an unknown option.");
+                LOG_ERROR("GetOpt encountered an unknown option.");
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind < argc) {
+        printf("non-option ARGV-elements: ");
+        while (optind < argc)
+            printf("%s ", argv[optind++]);
+        printf("\n");
+    }
+
+    if (!serverSocket.empty()) {
+        try {
+            return GeneratorServer(serverSocket).serve(runCommandLine);
+        } catch (const std::exception &e) {
+            perror(e.what());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    generator.setOutputCache(outputCacheDir, outputCacheSize);
+
+    if (watch) {
+        try {
+            generator.watch();
+        } catch (const std::exception &e) {
+            perror(e.what());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return generator.run() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+    // With a server running, it runs the command line and this process only waits for it.
+    // Commands for the server itself are never forwarded, nor is printing the help or version.
+    const char *server = getenv(serverVariable);
+    bool serverCommand = false;
+    bool localCommand = false;
+    for (int i = 1; i < argc; i++) {
+        serverCommand = serverCommand || strncmp(argv[i], "--serve", strlen("--serve")) == 0;
+        localCommand = localCommand || strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0
+                       || strcmp(argv[i], "--version") == 0 || strcmp(argv[i], "-v") == 0;
+    }
+    int status;
+    if (server != nullptr && *server != '\0' && !serverCommand && !localCommand) {
+        // The server reads its own environment, so the output cache of this one goes on the command line,
+        // empty if it is not set. An --output-cache given by the caller follows it and still wins.
+        const char *outputCacheVariable = getenv(outputCacheEnvironment);
+        std::string outputCacheOption = std::string("--output-cache=")
+                                        + (outputCacheVariable != nullptr ? outputCacheVariable : "");
+        std::vector<char *> forwarded(argv, argv + argc);
+        forwarded.insert(forwarded.begin() + 1, &outputCacheOption[0]);
+        if (GeneratorClient(server).run((int) forwarded.size(), forwarded.data(), status)) {
+            return status;
+        }
+    }
+
+    // Set up on the first record, so --help and --version neither read the config nor create log files.
+    // The server forks its requests, which needs a process without logging threads.
+    Logger::initLazily("logconfig.ini", serverCommand);
+    return runCommandLine(argc, argv);
+}
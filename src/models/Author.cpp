@@ -24,29 +24,57 @@ const string &Author::getMail() const {
 
 
 //Setters
-void Author::setName(const string &_name) {
-    Author::name = _name;
+void Author::setName(boost::string_view _name) {
+    Author::name.assign(_name.data(), _name.size());
 }
 
-void Author::setPhone(const string &_phone) {
-    Author::phone = _phone;
+void Author::setPhone(boost::string_view _phone) {
+    Author::phone.assign(_phone.data(), _phone.size());
 }
 
-void Author::setMail(const string &_mail) {
-    Author::mail = _mail;
+void Author::setMail(boost::string_view _mail) {
+    Author::mail.assign(_mail.data(), _mail.size());
 }
 
 //helper function to parse the Author-Tag
-void Author::parseAttributes(AttributeList &attributes) {
+void Author::parseAttributes(AttributeList &attributes, MemoryManager *memoryManager) {
     LOG_TRACE("Starting Author-Attributes parse");
-    for (unsigned int i = 0; i < attributes.getLength(); i++) {
-        if (!XMLString::compareString(attributes.getName(i), u"Name")) {
-            setName(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"Phone")) {
-            setPhone(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"Mail")) {
-            setMail(std::string(XMLString::transcode(attributes.getValue(i))));
+    for (XMLSize_t i = 0; i < attributes.getLength(); i++) {
+        SpecAttribute attribute = SpecVocabulary::attribute(attributes.getName(i));
+        if (attribute == SpecAttribute::UNKNOWN) {
+            continue;
         }
+        char *value = XMLString::transcode(attributes.getValue(i), memoryManager);
+        setAttribute(attribute, value);
+        XMLString::release(&value, memoryManager);
     }
     LOG_TRACE("Finished Author-Attributes parse");
 }
+
+void Author::setAttribute(SpecAttribute attribute, boost::string_view value) {
+    switch (attribute) {
+        case SpecAttribute::NAME:
+            setName(value);
+            break;
+        case SpecAttribute::PHONE:
+            setPhone(value);
+            break;
+        case SpecAttribute::MAIL:
+            setMail(value);
+            break;
+        default:
+            break;
+    }
+}
+
+void Author::serialize(BinaryWriter &writer) const {
+    writer.writeString(name);
+    writer.writeString(phone);
+    writer.writeString(mail);
+}
+
+void Author::deserialize(BinaryReader &reader) {
+    name = reader.readString();
+    phone = reader.readString();
+    mail = reader.readString();
+}
@@ -50,28 +50,28 @@ const vector<Option> &GetOptSetup::getOptions() const {
 
 
 // Setters
-void GetOptSetup::setSignPerLine(const string &_signPerLine) {
-    GetOptSetup::signPerLine = boost::lexical_cast<int>(_signPerLine);
+void GetOptSetup::setSignPerLine(boost::string_view _signPerLine) {
+    GetOptSetup::signPerLine = boost::lexical_cast<int>(_signPerLine.data(), _signPerLine.size());
 }
 
 void GetOptSetup::setAuthor(const Author &_author) {
     GetOptSetup::author = _author;
 }
 
-void GetOptSetup::setHeaderFileName(const string &_headerFileName) {
-    GetOptSetup::headerFileName = _headerFileName;
+void GetOptSetup::setHeaderFileName(boost::string_view _headerFileName) {
+    GetOptSetup::headerFileName.assign(_headerFileName.data(), _headerFileName.size());
 }
 
-void GetOptSetup::setSourceFileName(const string &_sourceFileName) {
-    GetOptSetup::sourceFileName = _sourceFileName;
+void GetOptSetup::setSourceFileName(boost::string_view _sourceFileName) {
+    GetOptSetup::sourceFileName.assign(_sourceFileName.data(), _sourceFileName.size());
 }
 
-void GetOptSetup::setNamespaceName(const string &_namespaceName) {
-    GetOptSetup::namespaceName = _namespaceName;
+void GetOptSetup::setNamespaceName(boost::string_view _namespaceName) {
+    GetOptSetup::namespaceName.assign(_namespaceName.data(), _namespaceName.size());
 }
 
-void GetOptSetup::setClassName(const string &_className) {
-    GetOptSetup::className = _className;
+void GetOptSetup::setClassName(boost::string_view _className) {
+    GetOptSetup::className.assign(_className.data(), _className.size());
 }
 
 void GetOptSetup::setOverAllDescriptions(const vector<string> &_overAllDescriptions) {
@@ -87,25 +87,77 @@ void GetOptSetup::setOptions(const vector<Option> &_options) {
 }
 
 // Adders
-void GetOptSetup::addOverAllDescription(const string &overAllDescription) {
-    GetOptSetup::overAllDescriptions.push_back(overAllDescription);
+void GetOptSetup::addOverAllDescription(boost::string_view overAllDescription) {
+    GetOptSetup::overAllDescriptions.emplace_back(overAllDescription.data(), overAllDescription.size());
 }
 
-void GetOptSetup::addSampleUsage(const string &sampleUsage) {
-    GetOptSetup::sampleUsages.push_back(sampleUsage);
+void GetOptSetup::addSampleUsage(boost::string_view sampleUsage) {
+    GetOptSetup::sampleUsages.emplace_back(sampleUsage.data(), sampleUsage.size());
 }
 
 void GetOptSetup::addOption(const Option &option) {
     GetOptSetup::options.push_back(option);
 }
 
+void GetOptSetup::addOption(Option &&option) {
+    GetOptSetup::options.push_back(std::move(option));
+}
+
 // Helpers
-void GetOptSetup::parseAttributes(AttributeList &attributes) {
+void GetOptSetup::parseAttributes(AttributeList &attributes, MemoryManager *memoryManager) {
     LOG_TRACE("Starting GetOptSetup-Attributes parse");
-    for (unsigned int i = 0; i < attributes.getLength(); i++) {
-        if (!XMLString::compareString(attributes.getName(i), u"SignPerLine")) {
-            setSignPerLine(std::string(XMLString::transcode(attributes.getValue(i))));
+    for (XMLSize_t i = 0; i < attributes.getLength(); i++) {
+        SpecAttribute attribute = SpecVocabulary::attribute(attributes.getName(i));
+        if (attribute == SpecAttribute::UNKNOWN) {
+            continue;
         }
+        char *value = XMLString::transcode(attributes.getValue(i), memoryManager);
+        setAttribute(attribute, value);
+        XMLString::release(&value, memoryManager);
     }
     LOG_TRACE("Finished GetOptSetup-Attributes parse");
 }
+
+void GetOptSetup::setAttribute(SpecAttribute attribute, boost::string_view value) {
+    switch (attribute) {
+        case SpecAttribute::SIGNPERLINE:
+            setSignPerLine(value);
+            break;
+        default:
+            break;
+    }
+}
+
+void GetOptSetup::serialize(BinaryWriter &writer) const {
+    writer.writeI32(signPerLine);
+    author.serialize(writer);
+    writer.writeString(headerFileName);
+    writer.writeString(sourceFileName);
+    writer.writeString(namespaceName);
+    writer.writeString(className);
+    writer.writeStrings(overAllDescriptions);
+    writer.writeStrings(sampleUsages);
+    writer.writeU32((uint32_t) options.size());
+    for (auto &option: options) {
+        option.serialize(writer);
+    }
+}
+
+void GetOptSetup::deserialize(BinaryReader &reader) {
+    signPerLine = reader.readI32();
+    author.deserialize(reader);
+    headerFileName = reader.readString();
+    sourceFileName = reader.readString();
+    namespaceName = reader.readString();
+    className = reader.readString();
+    overAllDescriptions = reader.readStrings();
+    sampleUsages = reader.readStrings();
+    uint32_t optionCount = reader.readU32();
+    options.clear();
+    options.reserve(optionCount);
+    for (uint32_t i = 0; i < optionCount; i++) {
+        Option option;
+        option.deserialize(reader);
+        options.push_back(option);
+    }
+}
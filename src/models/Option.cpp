@@ -3,6 +3,7 @@
  */
 
 #include "models/Option.h"
+#include "GeneratorException.h"
 #include "Logger.h"
 #include <boost/lexical_cast.hpp>
 #include <vector>
@@ -30,7 +31,7 @@ const std::string &Option::getDescription() const {
     return description;
 }
 
-std::vector<int> Option::getExclusions() const {
+const std::vector<int> &Option::getExclusions() const {
     return exclusions;
 }
 
@@ -50,11 +51,11 @@ ConvertToOptions Option::getConvertTo() const {
     return convertTo;
 }
 
-std::string Option::getDefaultValue() const {
+const std::string &Option::getDefaultValue() const {
     return defaultValue;
 }
 
-std::string Option::getInterface() const {
+const std::string &Option::getInterface() const {
     return interface;
 }
 
@@ -62,29 +63,28 @@ std::string Option::getInterface() const {
 
 // Setters
 
-void Option::setRef(const std::string &ref) {
-    int _ref = boost::lexical_cast<int>(ref);
+void Option::setRef(boost::string_view ref) {
+    int _ref = boost::lexical_cast<int>(ref.data(), ref.size());
     if (_ref < 1 || _ref > 63) {
-        std::cerr << "Error: Invalid ref value: [" << _ref << "]. Must be between 1 and 63." << std::endl;
         LOG_ERROR("Error: Invalid ref value: [" << _ref << "]. Must be between 1 and 63.");
-        exit(EXIT_FAILURE);
+        throw GeneratorException("Invalid ref value: [" + std::to_string(_ref) + "]. Must be between 1 and 63.");
     }
     Option::ref = _ref;
 }
 
-void Option::setShortOpt(const std::string &_shortOpt) {
-    Option::shortOpt = boost::lexical_cast<char>(_shortOpt);
+void Option::setShortOpt(boost::string_view _shortOpt) {
+    Option::shortOpt = boost::lexical_cast<char>(_shortOpt.data(), _shortOpt.size());
 }
 
-void Option::setLongOpt(const std::string &_longOpt) {
-    Option::longOpt = _longOpt;
+void Option::setLongOpt(boost::string_view _longOpt) {
+    Option::longOpt.assign(_longOpt.data(), _longOpt.size());
 }
 
-void Option::setDescription(const std::string &_description) {
-    Option::description = _description;
+void Option::setDescription(boost::string_view _description) {
+    Option::description.assign(_description.data(), _description.size());
 }
 
-void Option::setExclusions(const std::string &_exclusions) {
+void Option::setExclusions(boost::string_view _exclusions) {
     std::vector<std::string> excls;
     boost::split(excls, _exclusions, boost::is_any_of(","));
     for (auto &excl : excls) {
@@ -92,15 +92,15 @@ void Option::setExclusions(const std::string &_exclusions) {
     }
 }
 
-void Option::setConnectToInternalMethod(const std::string &_connectToInternalMethod) {
-    Option::connectToInternalMethod = _connectToInternalMethod;
+void Option::setConnectToInternalMethod(boost::string_view _connectToInternalMethod) {
+    Option::connectToInternalMethod.assign(_connectToInternalMethod.data(), _connectToInternalMethod.size());
 }
 
-void Option::setConnectToExternalMethod(const std::string &_connectToExternalMethod) {
-    Option::connectToExternalMethod = _connectToExternalMethod;
+void Option::setConnectToExternalMethod(boost::string_view _connectToExternalMethod) {
+    Option::connectToExternalMethod.assign(_connectToExternalMethod.data(), _connectToExternalMethod.size());
 }
 
-void Option::setHasArguments(const std::string &_hasArguments) {
+void Option::setHasArguments(boost::string_view _hasArguments) {
     if (boost::iequals(_hasArguments, "optional")) {
         Option::hasArguments = HasArguments::OPTIONAL;
     } else if (boost::iequals(_hasArguments, "required")) {
@@ -111,7 +111,7 @@ void Option::setHasArguments(const std::string &_hasArguments) {
     }
 }
 
-void Option::setConvertTo(const std::string &_convertTo) {
+void Option::setConvertTo(boost::string_view _convertTo) {
     if (boost::iequals(_convertTo, "String")) {
         Option::convertTo = ConvertToOptions::STRING;
     } else if (boost::iequals(_convertTo, "Integer")) {
@@ -124,42 +124,106 @@ void Option::setConvertTo(const std::string &_convertTo) {
     }
 }
 
-void Option::setDefaultValue(const std::string &_defaultValue) {
-    Option::defaultValue = _defaultValue;
+void Option::setDefaultValue(boost::string_view _defaultValue) {
+    Option::defaultValue.assign(_defaultValue.data(), _defaultValue.size());
 }
 
-void Option::setInterface(const std::string &_interface) {
-    Option::interface = _interface;
+void Option::setInterface(boost::string_view _interface) {
+    Option::interface.assign(_interface.data(), _interface.size());
 }
 
 // Helpers
 
-void Option::parseAttributes(AttributeList &attributes) {
+void Option::parseAttributes(AttributeList &attributes, MemoryManager *memoryManager) {
     LOG_TRACE("Starting Option-Attributes parse");
-    for (unsigned int i = 0; i < attributes.getLength(); i++) {
-        if (!XMLString::compareString(attributes.getName(i), u"Ref")) {
-            setRef(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"ShortOpt")) {
-            setShortOpt(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"LongOpt")) {
-            setLongOpt(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"Description")) {
-            setDescription(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"Exclusion")) {
-            setExclusions(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"ConnectToInternalMethod")) {
-            setConnectToInternalMethod(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"ConnectToExternalMethod")) {
-            setConnectToExternalMethod(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"HasArguments")) {
-            setHasArguments(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"ConvertTo")) {
-            setConvertTo(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"DefaultValue")) {
-            setDefaultValue(std::string(XMLString::transcode(attributes.getValue(i))));
-        } else if (!XMLString::compareString(attributes.getName(i), u"Interface")) {
-            setInterface(std::string(XMLString::transcode(attributes.getValue(i))));
+    for (XMLSize_t i = 0; i < attributes.getLength(); i++) {
+        SpecAttribute attribute = SpecVocabulary::attribute(attributes.getName(i));
+        if (attribute == SpecAttribute::UNKNOWN) {
+            continue;
         }
+        char *value = XMLString::transcode(attributes.getValue(i), memoryManager);
+        setAttribute(attribute, value);
+        XMLString::release(&value, memoryManager);
     }
     LOG_TRACE("Finished Option-Attributes parse");
 }
+
+void Option::setAttribute(SpecAttribute attribute, boost::string_view value) {
+    switch (attribute) {
+        case SpecAttribute::REF:
+            setRef(value);
+            break;
+        case SpecAttribute::SHORTOPT:
+            setShortOpt(value);
+            break;
+        case SpecAttribute::LONGOPT:
+            setLongOpt(value);
+            break;
+        case SpecAttribute::DESCRIPTION:
+            setDescription(value);
+            break;
+        case SpecAttribute::EXCLUSION:
+            setExclusions(value);
+            break;
+        case SpecAttribute::CONNECTTOINTERNALMETHOD:
+            setConnectToInternalMethod(value);
+            break;
+        case SpecAttribute::CONNECTTOEXTERNALMETHOD:
+            setConnectToExternalMethod(value);
+            break;
+        case SpecAttribute::HASARGUMENTS:
+            setHasArguments(value);
+            break;
+        case SpecAttribute::CONVERTTO:
+            setConvertTo(value);
+            break;
+        case SpecAttribute::DEFAULTVALUE:
+            setDefaultValue(value);
+            break;
+        case SpecAttribute::INTERFACE:
+            setInterface(value);
+            break;
+        default:
+            break;
+    }
+}
+
+void Option::serialize(BinaryWriter &writer) const {
+    writer.writeI32(ref);
+    writer.writeU8((uint8_t) shortOpt);
+    writer.writeString(longOpt);
+    writer.writeString(description);
+    writer.writeU32((uint32_t) exclusions.size());
+    for (int exclusion: exclusions) {
+        writer.writeI32(exclusion);
+    }
+    writer.writeString(connectToInternalMethod);
+    writer.writeString(connectToExternalMethod);
+    writer.writeU8((uint8_t) hasArguments);
+    writer.writeU8((uint8_t) convertTo);
+    writer.writeString(defaultValue);
+    writer.writeString(interface);
+}
+
+void Option::deserialize(BinaryReader &reader) {
+    ref = reader.readI32();
+    shortOpt = (char) reader.readU8();
+    longOpt = reader.readString();
+    description = reader.readString();
+    uint32_t exclusionCount = reader.readU32();
+    exclusions.clear();
+    for (uint32_t i = 0; i < exclusionCount; i++) {
+        exclusions.push_back(reader.readI32());
+    }
+    connectToInternalMethod = reader.readString();
+    connectToExternalMethod = reader.readString();
+    uint8_t _hasArguments = reader.readU8();
+    uint8_t _convertTo = reader.readU8();
+    if (_hasArguments > (uint8_t) HasArguments::REQUIRED || _convertTo > (uint8_t) ConvertToOptions::BOOLEAN) {
+        throw GeneratorException("Invalid option in binary data");
+    }
+    hasArguments = (HasArguments) _hasArguments;
+    convertTo = (ConvertToOptions) _convertTo;
+    defaultValue = reader.readString();
+    interface = reader.readString();
+}
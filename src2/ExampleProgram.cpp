@@ -3,7 +3,7 @@
  */
 
 #include "../include2/ExampleProgram.h"
-#include "../include2/generatedCode.h"
+#include "generatedCode.h"
 
 ExampleProgram::ExampleProgram(GC::GeneratedClass *generatedClass) {
     this->generatedClass = generatedClass;
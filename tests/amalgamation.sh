@@ -0,0 +1,28 @@
+# Editors: Tobias Goetz
+#
+# Amalgamation: specs sharing a namespace or without one are written into one source that
+# compiles, a path that needs escaping gives a valid #line directive, and a failing spec
+# is reported instead of silently leaving the amalgamation out.
+
+. "$(dirname "$0")/common.sh"
+
+spec specs/a.xml a.h a.cpp Shared first
+spec specs/b.xml b.h b.cpp Shared second
+sed -i 's/GeneratedClass/Other/' specs/b.xml
+spec specs/c.xml c.h c.cpp "" third
+out='out "quoted" \dir'
+mkdir "$out"
+
+run -p specs -o "$out/" --amalgamate all.cpp || fail "specs sharing a namespace must be amalgamated"
+[ -f "$out/all.cpp" ] || fail "the amalgamated source must be written"
+[ "$(grep -c '^#line 1' "$out/all.cpp")" = 3 ] || fail "every source must follow a #line directive"
+grep -q '^#line 1 ".*out \\"quoted\\" \\\\dir/a.cpp"$' "$out/all.cpp" || fail "the #line path must be escaped"
+compile "$out/all.cpp" || fail "the amalgamated source must compile"
+
+echo "<GetOptSetup>" > specs/d.xml
+rm "$out/all.cpp"
+: > "$log"
+run -p specs -o "$out/" --amalgamate all.cpp && fail "a failing spec must fail the run"
+[ -f "$out/all.cpp" ] && fail "the amalgamated source must not be written if a spec failed"
+grep -q "all.cpp: not written" "$log" || fail "the missing amalgamation must be reported"
+exit 0
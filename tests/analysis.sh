@@ -0,0 +1,42 @@
+# Editors: Tobias Goetz
+#
+# Semantic analysis: every problem of a spec is reported in one run, in the message of
+# the failed spec, and the spec writes no files.
+
+. "$(dirname "$0")/common.sh"
+
+# options <path> <options>, writes a spec with the given Option elements
+options() {
+    cat > "$1" <<SPEC
+<?xml version="1.0" encoding="UTF-8" ?>
+<GetOptSetup SignPerLine="79">
+    <Author Name="Test" Mail="test@example.com" />
+    <HeaderFileName>bad.h</HeaderFileName>
+    <SourceFileName>bad.cpp</SourceFileName>
+    <ClassName>GeneratedClass</ClassName>
+    <Options>
+        $2
+    </Options>
+</GetOptSetup>
+SPEC
+}
+
+options bad.xml '
+        <Option Ref="1" ShortOpt="a" LongOpt="alpha" Description="A" />
+        <Option Ref="1" ShortOpt="a" LongOpt="alpha" Description="Duplicate" />
+        <Option Ref="2" LongOpt="beta" Exclusion="9" Description="Missing target" />
+        <Option Ref="3" LongOpt="gamma" Exclusion="3" Description="Self" />
+        <Option LongOpt="delta-value" Description="Delta" />
+        <Option Interface="deltaValue" LongOpt="other" Description="Same identifier" />'
+mkdir out
+# Without logconfig.ini and with --quiet the log shows nothing, the message has to
+run -p bad.xml -o out/ --quiet && fail "an invalid spec must fail"
+grep -q "Spec has 6 errors" "$log" || fail "all errors must be counted"
+grep -q "Ref 1 is used by" "$log" || fail "a duplicate Ref must be reported"
+grep -q "ShortOpt a is used by" "$log" || fail "a duplicate ShortOpt must be reported"
+grep -q "LongOpt alpha is used by" "$log" || fail "a duplicate LongOpt must be reported"
+grep -q "excludes Ref 9, which no option has" "$log" || fail "a missing exclusion target must be reported"
+grep -q -- "--gamma excludes itself" "$log" || fail "an option excluding itself must be reported"
+grep -q "both map to the identifier deltaValue" "$log" || fail "colliding identifiers must be reported"
+[ -f out/bad.h ] && fail "an invalid spec must not write any files"
+exit 0
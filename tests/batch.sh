@@ -0,0 +1,24 @@
+# Editors: Tobias Goetz
+#
+# Batch mode: several specs on a worker pool, a failing spec does not stop the others,
+# and specs writing the same file fail the run, again on the next run.
+
+. "$(dirname "$0")/common.sh"
+
+spec specs/a.xml a.h a.cpp A
+spec specs/b.xml b.h b.cpp B
+echo "<GetOptSetup>" > broken.xml
+mkdir out
+run -p specs -p broken.xml -o out/ -j 4 && fail "a broken spec must fail the run"
+[ -f out/a.cpp ] && [ -f out/b.cpp ] || fail "the other specs must be generated"
+
+spec same/c.xml c.h shared.cpp C
+spec same/d.xml d.h shared.cpp D
+run -p same -o out/ -j 2 && fail "two specs writing the same file must fail the run"
+grep -q "both write" "$log" || fail "the error must name the colliding file"
+: > "$log"
+run -p same -o out/ -j 2 && fail "colliding specs must not be skipped as up to date"
+grep -q "both write" "$log" || fail "the collision must be reported again"
+spec same/d.xml d.h d.cpp D
+run -p same -o out/ -j 2 || fail "specs writing different files must pass"
+exit 0
@@ -0,0 +1,78 @@
+# Editors: Tobias Goetz
+#
+# Helpers for the command line tests. Every test is a shell script run by ctest with the
+# path of the CodeGenerator, the C++ compiler and the include directories of Boost as its
+# arguments, and once for each front end named by CODEGENERATOR_TEST_FRONTEND. It works in a
+# fresh temporary directory and fails with a message on the first check that does not hold.
+
+set -u
+
+generator="$1"
+compiler="${2:-c++}"
+includes=""
+if [ $# -gt 2 ]; then
+    shift 2
+    for dir in "$@"; do
+        includes="$includes -I$dir"
+    done
+fi
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 1
+# Keeps the log records of the generator out of the test output
+unset CODEGENERATOR_SERVER CODEGENERATOR_OUTPUT_CACHE
+log="$work/generator.log"
+# The default front end is Xerces, the generator is only given --frontend for the native one
+frontend="${CODEGENERATOR_TEST_FRONTEND:-xerces}"
+frontendArgs=""
+if [ "$frontend" != xerces ]; then
+    frontendArgs="--frontend $frontend"
+fi
+
+# fail <message>
+fail() {
+    echo "FAIL: $1" >&2
+    if [ -s "$log" ]; then
+        echo "--- generator output" >&2
+        tail -n 40 "$log" >&2
+    fi
+    exit 1
+}
+
+# run <arguments>, runs the generator with its output going to the log
+run() {
+    "$generator" $frontendArgs "$@" >> "$log" 2>&1
+}
+
+# spec <path> <header> <source> [namespace] [option], writes a small spec
+spec() {
+    mkdir -p "$(dirname "$1")"
+    namespace=""
+    if [ -n "${4:-}" ]; then
+        namespace="<NameSpace>$4</NameSpace>"
+    fi
+    cat > "$1" <<SPEC
+<?xml version="1.0" encoding="UTF-8" ?>
+<GetOptSetup SignPerLine="79">
+    <Author Name="Test" Mail="test@example.com" />
+    <HeaderFileName>$2</HeaderFileName>
+    <SourceFileName>$3</SourceFileName>
+    $namespace
+    <ClassName>GeneratedClass</ClassName>
+    <Options>
+        <Option ShortOpt="h" LongOpt="help" ConnectToInternalMethod="printHelp" Description="Help" />
+        <Option LongOpt="${5:-value}" HasArguments="Required" ConvertTo="Integer" Description="A value" />
+    </Options>
+</GetOptSetup>
+SPEC
+}
+
+# mtime <file>, prints the modification time in nanoseconds
+mtime() {
+    stat -c %.9Y "$1" 2>/dev/null || stat -c %Y "$1"
+}
+
+# compile <source>, checks that a generated source compiles
+compile() {
+    "$compiler" -std=c++14 -fsyntax-only $includes "$1" >> "$log" 2>&1
+}
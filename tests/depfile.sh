@@ -0,0 +1,24 @@
+# Editors: Tobias Goetz
+#
+# Depfile: the rule names the generated files and the depfile as targets and every file
+# the run read as prerequisites. --quiet, as used by add_getopt_codegen, keeps info
+# records out of the build log and creates no log files.
+
+. "$(dirname "$0")/common.sh"
+
+spec specs/a.xml a.h a.cpp A
+mkdir out
+"$generator" $frontendArgs -p specs -o out/ --depfile out/a.d --quiet > quiet.log 2>&1 \
+    || fail "generating with a depfile must succeed"
+[ -f out/a.d ] || fail "the depfile must be written"
+head -n 1 out/a.d | grep -q "out/a.h .*out/a.cpp .*out/a.d:" || fail "the generated files and the depfile must be targets"
+grep -q "specs/a.xml" out/a.d || fail "the spec must be a prerequisite"
+grep -q "/specs$" out/a.d || fail "the spec directory must be a prerequisite"
+grep -q "info" quiet.log && fail "--quiet must not log info records"
+[ -d logs ] && fail "--quiet must not create log files"
+
+echo "<GetOptSetup>" > specs/b.xml
+rm out/a.d
+run -p specs -o out/ --depfile out/a.d && fail "a failing spec must fail the run"
+[ -f out/a.d ] && fail "no depfile must be written after a failed run"
+exit 0
@@ -0,0 +1,46 @@
+# Editors: Tobias Goetz
+#
+# Formatting: the generated code is indented like astyle's default style, namespaces
+# are not indented, access labels line up with their class and case labels with their
+# switch, and every closing brace lines up with the line that opened its block.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+mkdir out
+run -p a.xml -o out/ || fail "the spec must be generated"
+grep -q "^class GeneratedClass {" out/a.h || fail "a class in a namespace must not be indented"
+grep -q "^private:" out/a.h || fail "an access label must line up with its class"
+grep -q "^    struct Args {" out/a.h || fail "class members must be indented by four spaces"
+grep -q "^        struct {" out/a.h || fail "nested members must be indented by eight spaces"
+grep -q "	" out/a.h out/a.cpp && fail "the code must be indented with spaces"
+
+# Compares the indentation of every case label with its switch and of every line that
+# starts with a closing brace with the line that opened the block; the braces in string
+# literals of this spec are balanced
+for file in out/a.h out/a.cpp; do
+    awk '
+        function indent(line) { match(line, /^ */); return RLENGTH }
+        {
+            if ($0 ~ /^ *(case .*|default):/) {
+                inner = 0
+                for (i = n; i > 0; i--) if (kind[i] == "switch") { inner = i; break }
+                if (inner == 0 || indent($0) != opened[inner]) { print FILENAME ":" FNR; bad = 1 }
+            }
+            first = 1
+            for (i = 1; i <= length($0); i++) {
+                c = substr($0, i, 1)
+                if (c == "}") {
+                    if (first && indent($0) != opened[n]) { print FILENAME ":" FNR; bad = 1 }
+                    n--
+                } else if (c == "{") {
+                    opened[++n] = indent($0)
+                    kind[n] = $0 ~ /^ *switch / ? "switch" : ""
+                }
+                if (c != " ") first = 0
+            }
+        }
+        END { exit bad || n != 0 }
+    ' "$file" >> "$log" || fail "the blocks of $file must be indented consistently"
+done
+exit 0
@@ -0,0 +1,64 @@
+# Editors: Tobias Goetz
+#
+# Identical output: a spec with many options, exclusions, a boolean option, character
+# references and literal whitespace in attribute values and the ClassName after <Options>
+# generates the same bytes sequentially, with --emit-jobs 8, with --pipeline and with
+# either front end.
+
+. "$(dirname "$0")/common.sh"
+
+{
+    cat <<'SPEC'
+<?xml version="1.0" encoding="UTF-8" ?>
+<GetOptSetup SignPerLine="79">
+    <Author Name="Test" Mail="test@example.com" />
+    <HeaderFileName>large.h</HeaderFileName>
+    <SourceFileName>large.cpp</SourceFileName>
+    <NameSpace>Large</NameSpace>
+    <OverAllDescription><Block>Many options &amp; exclusions</Block></OverAllDescription>
+    <Options>
+        <Option Ref="1" Exclusion="2" ShortOpt="h" LongOpt="help" ConnectToInternalMethod="printHelp" Description="Help" />
+        <Option Ref="2" Exclusion="1" LongOpt="exclusion" Description="Excludes help" />
+        <Option Ref="3" LongOpt="flag" HasArguments="Required" ConvertTo="Boolean" Interface="Flag" Description="A boolean" />
+        <Option LongOpt="level" HasArguments="Optional" ConvertTo="Integer" DefaultValue="50" Description="A level" />
+        <Option LongOpt="separator" HasArguments="Optional" ConvertTo="String" DefaultValue="&#9;|&#9;"
+                Description="Tab&#9;references	and literal
+                whitespace" />
+SPEC
+    i=0
+    while [ $i -lt 200 ]; do
+        printf '        <Option LongOpt="option-%d" HasArguments="Required" Exclusion="3" Description="Option %d" />\n' $i $i
+        i=$((i + 1))
+    done
+    cat <<'SPEC'
+    </Options>
+    <ClassName>LateClass</ClassName>
+</GetOptSetup>
+SPEC
+} > large.xml
+
+# variant <name> <arguments>, generates the spec into the directory <name>
+variant() {
+    name="$1"
+    shift
+    mkdir "$name"
+    "$generator" $frontendArgs -p large.xml -o "$name/" "$@" >> "$log" 2>&1 || fail "the run $name must succeed"
+}
+
+variant sequential --emit-jobs 1
+grep -q "LateClass" sequential/large.h || fail "a ClassName after the options must be used"
+grep -q "$(printf '"\t|\t"')" sequential/large.h || fail "a tab from a character reference must be kept"
+grep -q "$(printf 'Tab\treferences and literal whitespace')" sequential/large.cpp \
+    || fail "literal whitespace in an attribute must become spaces, references must be kept"
+compile sequential/large.cpp || fail "the generated source must compile"
+variant parallel --emit-jobs 8
+variant pipeline --pipeline
+variant pipeline-parallel --pipeline --emit-jobs 8
+variant xerces --frontend xerces --emit-jobs 1
+variant native --frontend native --emit-jobs 1
+for name in parallel pipeline pipeline-parallel xerces native; do
+    for file in large.h large.cpp; do
+        cmp -s "sequential/$file" "$name/$file" || fail "$name must generate the same $file"
+    done
+done
+exit 0
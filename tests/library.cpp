@@ -0,0 +1,108 @@
+/*
+ * Editors: Tobias Goetz
+ */
+
+/**
+ * @brief Checks the in-memory API of the codegen library
+ * Generates a spec with both front ends into strings and into buffers of the caller and
+ * compares the results. Nothing may be written to the working directory.
+ *
+ * Usage: LibraryTest <spec.xml>
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "GeneratorException.h"
+#include "SpecGenerator.h"
+
+/**
+ * @brief Prints a failed check and ends the test
+ * @param message the check that does not hold
+ */
+static void fail(const std::string &message) {
+    fprintf(stderr, "FAIL: %s\n", message.c_str());
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Generates a spec into strings
+ * @param spec content of the spec
+ * @param frontend front end to parse it with
+ * @return the generated files
+ */
+static std::vector<GeneratedFile> generate(const std::string &spec, Frontend frontend) {
+    SpecGenerator generator;
+    generator.setFrontend(frontend);
+    try {
+        return generator.generate(spec.data(), spec.size());
+    } catch (const std::exception &e) {
+        fail(std::string("generating the spec failed: ") + e.what());
+    }
+    return {};
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <spec.xml>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        fail(std::string("unable to read ") + argv[1]);
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    std::string spec = content.str();
+
+    std::vector<GeneratedFile> files = generate(spec, Frontend::XERCES);
+    if (files.size() != 2 || files[0].path.substr(files[0].path.size() - 2) != ".h") {
+        fail("a spec without shards must give the header and then the source");
+    }
+    for (auto &file: files) {
+        if (file.content.empty()) {
+            fail(file.path + " must not be empty");
+        }
+        if (boost::filesystem::exists(file.path)) {
+            fail(file.path + " must not be written to disk");
+        }
+    }
+    std::vector<GeneratedFile> nativeFiles = generate(spec, Frontend::NATIVE);
+    for (std::size_t i = 0; i < files.size(); i++) {
+        if (nativeFiles.size() != files.size() || nativeFiles[i].path != files[i].path
+            || nativeFiles[i].content != files[i].content) {
+            fail("both front ends must generate the same " + files[i].path);
+        }
+    }
+
+    // Too small buffers only report the sizes
+    SpecGenerator generator;
+    std::size_t headerSize = 0;
+    std::size_t sourceSize = 0;
+    if (generator.generate(spec.data(), spec.size(), nullptr, headerSize, nullptr, sourceSize)) {
+        fail("empty buffers must be too small");
+    }
+    if (headerSize != files[0].content.size() || sourceSize != files[1].content.size()) {
+        fail("too small buffers must receive the required sizes");
+    }
+    std::vector<char> header(headerSize);
+    std::vector<char> source(sourceSize);
+    if (!generator.generate(spec.data(), spec.size(), header.data(), headerSize, source.data(), sourceSize)) {
+        fail("buffers of the required sizes must be large enough");
+    }
+    if (std::string(header.begin(), header.end()) != files[0].content
+        || std::string(source.begin(), source.end()) != files[1].content) {
+        fail("the buffers must receive the same code as the strings");
+    }
+
+    try {
+        generator.generate("<GetOptSetup>", 13);
+        fail("a malformed spec must throw");
+    } catch (const GeneratorException &) {
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,37 @@
+# Editors: Tobias Goetz
+#
+# Output manifest: unchanged specs are skipped, touched ones are recognized by their
+# content and changed ones are generated again, rewriting only outputs that changed.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+mkdir out
+run -p a.xml -o out/ || fail "the first run must succeed"
+grep -q "a.xml" out/codegen.manifest || fail "the manifest must list the spec"
+header=$(mtime out/a.h)
+
+: > "$log"
+run -p a.xml -o out/ || fail "the second run must succeed"
+grep -q "Skipping up-to-date spec a.xml" "$log" || fail "an unchanged spec must be skipped"
+
+: > "$log"
+sleep 0.01
+touch a.xml
+run -p a.xml -o out/ || fail "the run after touching the spec must succeed"
+grep -q "Skipping up-to-date spec a.xml" "$log" || fail "a touched spec with the same content must be skipped"
+
+: > "$log"
+echo "<!-- changed -->" >> a.xml
+run -p a.xml -o out/ || fail "the run after changing the spec must succeed"
+grep -q "Skipping up-to-date spec a.xml" "$log" && fail "a changed spec must be generated again"
+[ "$(mtime out/a.h)" = "$header" ] || fail "an output with the same content must keep its time"
+
+spec a.xml a.h a.cpp A other
+run -p a.xml -o out/ || fail "the run after adding an option must succeed"
+grep -q "other" out/a.cpp || fail "the source must have the new option"
+
+: > "$log"
+run -p a.xml -o out/ -f || fail "the forced run must succeed"
+grep -q "Skipping up-to-date spec a.xml" "$log" && fail "-f must generate up-to-date specs"
+exit 0
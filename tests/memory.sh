@@ -0,0 +1,27 @@
+# Editors: Tobias Goetz
+#
+# Memory budget: a spec with a text node larger than --max-memory fails, the same spec
+# passes without a budget, and budgets that do not fit into size_t are rejected.
+
+. "$(dirname "$0")/common.sh"
+
+spec small.xml small.h small.cpp Small
+{
+    sed '/<ClassName>/,$d' small.xml
+    printf '<OverAllDescription><Block>'
+    yes word | head -c 300000 | tr '\n' ' '
+    printf '</Block></OverAllDescription>\n'
+    sed -n '/<ClassName>/,$p' small.xml
+} | sed "s|small\.|large.|g; s|Small|Large|" > large.xml
+mkdir out
+
+run -p small.xml -o out/ --max-memory 64K || fail "a small spec must fit into 64K"
+run -p large.xml -o out/ --max-memory 64K && fail "a spec with a 300K text node must exceed 64K"
+grep -q "memory budget" "$log" || fail "the error must name the memory budget"
+[ -f out/large.h ] && fail "a spec exceeding its budget must not write any files"
+run -p large.xml -o out/ || fail "the large spec must pass without a budget"
+
+for budget in -1 -1K 1x 99999999999999999999 17179869184G ""; do
+    run -p small.xml -o out/ --max-memory "$budget" && fail "budget '$budget' must be rejected"
+done
+exit 0
@@ -0,0 +1,38 @@
+# Editors: Tobias Goetz
+#
+# Model cache: the first run stores the parsed model, the next one takes it from the
+# cache, and entries of another layout or another generator version are ignored and
+# replaced.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+mkdir out
+run -p a.xml -o out/ -c cache || fail "the first run must succeed"
+entry=$(ls cache/*.model 2>/dev/null)
+[ -n "$entry" ] || fail "the model must be stored"
+cp out/a.cpp parsed.cpp
+
+: > "$log"
+run -p a.xml -o out/ -c cache -f || fail "the run with a cached model must succeed"
+grep -q "from the model cache" "$log" || fail "the model must be loaded from the cache"
+cmp -s out/a.cpp parsed.cpp || fail "the code of a cached model must equal the parsed one"
+
+# The layout version follows the four bytes of the magic
+printf '\377' | dd of="$entry" bs=1 seek=4 conv=notrunc 2> /dev/null
+: > "$log"
+run -p a.xml -o out/ -c cache -f || fail "the run with an entry of another layout must succeed"
+grep -q "from the model cache" "$log" && fail "an entry of another layout must be ignored"
+: > "$log"
+run -p a.xml -o out/ -c cache -f || fail "the run after replacing the entry must succeed"
+grep -q "from the model cache" "$log" || fail "an entry of another layout must be replaced"
+
+version=$("$generator" --version | sed 's/^CodeGenerator //')
+LC_ALL=C sed -i "s/$version/0.0.0/" "$entry"
+: > "$log"
+run -p a.xml -o out/ -c cache -f || fail "the run with an entry of another version must succeed"
+grep -q "from the model cache" "$log" && fail "an entry of another generator version must be ignored"
+: > "$log"
+run -p a.xml -o out/ -c cache -f || fail "the run after replacing the entry must succeed"
+grep -q "from the model cache" "$log" || fail "an entry of another generator version must be replaced"
+exit 0
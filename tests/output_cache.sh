@@ -0,0 +1,50 @@
+# Editors: Tobias Goetz
+#
+# Output cache: a hit replacing an output with other content gives it a fresh time, names
+# with directories are put back into the same directories, and the cache is only scanned
+# for eviction after a run that stored an entry.
+
+. "$(dirname "$0")/common.sh"
+
+cache="$work/cache"
+mkdir out
+
+# Spec A, then B with the same file names, then A again from the cache
+spec a.xml gc.h gc.cpp A first
+cp a.xml first.xml
+spec a.xml gc.h gc.cpp A second
+cp a.xml second.xml
+cp first.xml a.xml
+run -p a.xml -o out/ --output-cache "$cache" || fail "generating A must succeed"
+cp second.xml a.xml
+run -p a.xml -o out/ --output-cache "$cache" || fail "generating B must succeed"
+sleep 0.01
+touch built.o
+sleep 0.01
+cp first.xml a.xml
+: > "$log"
+run -p a.xml -o out/ --output-cache "$cache" || fail "generating A again must succeed"
+grep -q "Output cache: 1 hits" "$log" || fail "A must be taken from the cache"
+grep -q "first" out/gc.cpp || fail "the source must be the one of A"
+[ out/gc.cpp -nt built.o ] || fail "a replaced output must be newer than the files built from the old one"
+
+# Names with directories
+spec sub.xml sub/gc.h sub/gc.cpp Sub
+mkdir -p first/sub second
+run -p sub.xml -o first/ --output-cache "$cache" || fail "generating into a subdirectory must succeed"
+: > "$log"
+run -p sub.xml -o second/ --output-cache "$cache" || fail "taking a subdirectory from the cache must succeed"
+grep -q "Output cache: 1 hits" "$log" || fail "the spec with a subdirectory must be taken from the cache"
+[ -f second/sub/gc.h ] && [ -f second/sub/gc.cpp ] || fail "the outputs must keep their directory"
+[ -f second/gc.h ] && fail "the outputs must not be flattened"
+
+# A run that only hits does not scan the cache, one that stores does
+mkdir third
+: > "$log"
+run -p sub.xml -o third/ --output-cache "$cache" || fail "a hit must succeed"
+grep "Output cache:" "$log" | grep -q "entries" && fail "a run without a store must not scan the cache"
+spec new.xml new.h new.cpp New
+: > "$log"
+run -p new.xml -o third/ --output-cache "$cache" --output-cache-size 1 || fail "a store must succeed"
+grep "Output cache:" "$log" | grep -q "bytes in 0 entries" || fail "a store must evict the cache down to its size"
+exit 0
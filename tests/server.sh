@@ -0,0 +1,53 @@
+# Editors: Tobias Goetz
+#
+# Generator server: it neither replaces a live socket nor another file, a forwarded command
+# line generates the same files as a local run, uses the output cache of the client instead
+# of the one of the server, and a request still running when the server gets SIGTERM is
+# answered before it stops.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+mkdir out local
+CODEGENERATOR_OUTPUT_CACHE="$work/server-cache" "$generator" --serve server.sock > server.out 2>&1 &
+server=$!
+trap 'kill -9 $server 2>/dev/null; rm -rf "$work"' EXIT
+for i in $(seq 100); do
+    [ -S server.sock ] && break
+    sleep 0.05
+done
+[ -S server.sock ] || fail "the server must listen on its socket"
+
+# Neither a live socket nor another file is taken over by a second server
+run --serve server.sock && fail "a second server on a live socket must fail"
+grep -q "a server is already listening" "$log" || fail "a second server must report the running one"
+echo notes > notes.txt
+run --serve notes.txt && fail "serving on a regular file must fail"
+grep -q "notes" notes.txt || fail "serving on a regular file must not remove it"
+
+CODEGENERATOR_SERVER="$work/server.sock" run -p a.xml -o out/ || fail "a forwarded run must succeed"
+run -p a.xml -o local/ || fail "a local run must succeed"
+cmp -s out/a.cpp local/a.cpp || fail "a forwarded run must generate the same source as a local one"
+[ -e server-cache ] && fail "a forwarded run without an output cache must not use the one of the server"
+CODEGENERATOR_SERVER="$work/server.sock" CODEGENERATOR_OUTPUT_CACHE=cache run -p a.xml -o out/ -f \
+    || fail "a forwarded run with an output cache must succeed"
+grep -q "Output cache: 0 hits, 1 misses" "$log" || fail "a forwarded run must use the output cache of the client"
+[ -d cache ] || fail "the output cache must be resolved in the directory of the client"
+[ -e server-cache ] && fail "a forwarded run must not use the output cache of the server"
+
+# The child of the request blocks reading the manifest until the server is stopped
+mkfifo list
+CODEGENERATOR_SERVER="$work/server.sock" run -m list -o out/ -f &
+client=$!
+for i in $(seq 100); do
+    pgrep -P $server > /dev/null && break
+    sleep 0.05
+done
+pgrep -P $server > /dev/null || fail "the request must be running"
+kill -TERM $server
+echo a.xml > list
+wait $client || fail "a request running at SIGTERM must be answered with its status"
+wait $server || fail "the server must stop cleanly"
+grep -q "Lost the connection" "$log" && fail "the client must not lose the connection"
+grep -q "^3 requests" server.out || fail "the server must count the request finished while stopping"
+exit 0
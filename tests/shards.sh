@@ -0,0 +1,42 @@
+# Editors: Tobias Goetz
+#
+# Shards: --shards lists every generated source in <Source>.sources, and a program built
+# from the shards behaves like one built from the single source.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+cat > main.cpp <<'MAIN'
+#include "a.h"
+int main(int argc, char **argv) {
+    A::GeneratedClass generated;
+    generated.parseOptions(argc, argv);
+    std::cout << "value " << generated.isSetValue() << std::endl;
+    return 0;
+}
+MAIN
+mkdir single sharded
+run -p a.xml -o single/ || fail "the single source must be generated"
+run -p a.xml -o sharded/ --shards 3 || fail "the shards must be generated"
+[ "$(wc -l < sharded/a.sources)" -eq 5 ] || fail "the list must name the source, three shards and the help"
+while read -r source; do
+    [ -f "$source" ] || fail "the listed source $source must exist"
+done < sharded/a.sources
+
+# build <directory> <sources>, links the program against the generated code
+build() {
+    dir="$1"
+    shift
+    "$compiler" -std=c++14 $includes -I"$dir" -o "$dir/program" main.cpp "$@" >> "$log" 2>&1
+}
+build single single/a.cpp || fail "the single source must build"
+build sharded $(cat sharded/a.sources) || fail "the shards must build"
+
+for arguments in "--value 42" "--value x" "--help" "--unknown" ""; do
+    ./single/program $arguments > single.out 2>&1
+    single=$?
+    ./sharded/program $arguments > sharded.out 2>&1
+    [ $? -eq $single ] || fail "the programs must exit alike for '$arguments'"
+    cmp -s single.out sharded.out || fail "the programs must print the same for '$arguments'"
+done
+exit 0
@@ -0,0 +1,20 @@
+# Editors: Tobias Goetz
+#
+# Strict mode: an element in a place the spec format does not allow is ignored with a
+# warning, with --strict the spec fails with the file and line of the element.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+sed 's|<ClassName>|<Block>stray</Block>\n    <ClassName>|' a.xml > stray.xml
+mkdir out strict
+run -p stray.xml -o out/ || fail "an element in an illegal place must be ignored"
+grep -q "Ignoring stray.xml:7:.*not allowed" "$log" || fail "the ignored element must be logged with its line"
+grep -q "stray" out/a.cpp && fail "the text of an ignored element must not be used"
+
+: > "$log"
+run -p stray.xml -o strict/ --strict && fail "--strict must fail a spec with an element in an illegal place"
+grep -q "FAILED stray.xml: stray.xml:7:.*not allowed" "$log" || fail "the error must name the line of the element"
+[ -f strict/a.h ] && fail "a spec failing --strict must not write any files"
+run -p a.xml -o strict/ --strict || fail "--strict must pass a valid spec"
+exit 0
@@ -0,0 +1,25 @@
+# Editors: Tobias Goetz
+#
+# Templates: a dumped and edited set is used, a missing or misspelled template fails the
+# run with an error naming the file instead of falling back to the built-in one.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+mkdir out
+"$generator" --dump-templates tpl >> "$log" 2>&1 || fail "dumping the templates must succeed"
+[ -f tpl/header.tpl ] && [ -f tpl/case.tpl ] || fail "all templates must be dumped"
+sed -i '1i // edited template' tpl/header.tpl
+run -p a.xml -o out/ --templates tpl || fail "a complete set of templates must be used"
+grep -q "edited template" out/a.h || fail "the edited template must be rendered"
+
+mv tpl/case.tpl tpl/cases.tpl
+: > "$log"
+run -p a.xml -o out/ --templates tpl -f && fail "a misspelled template must fail the run"
+grep -q "cases.tpl" "$log" || fail "the error must name the misspelled template"
+
+rm tpl/cases.tpl
+: > "$log"
+run -p a.xml -o out/ --templates tpl -f && fail "a missing template must fail the run"
+grep -q "case.tpl is missing" "$log" || fail "the error must name the missing template"
+exit 0
@@ -0,0 +1,17 @@
+# Editors: Tobias Goetz
+#
+# Text: Xerces passes the text of an element in several chunks, split at every entity,
+# the chunks of a Block end up in one paragraph of the generated help.
+
+. "$(dirname "$0")/common.sh"
+
+spec a.xml a.h a.cpp A
+{
+    sed '/<ClassName>/,$d' a.xml
+    printf '<OverAllDescription><Block>Salt &amp; pepper &lt;in&gt; one block</Block></OverAllDescription>\n'
+    sed -n '/<ClassName>/,$p' a.xml
+} > entities.xml
+mkdir out
+run -p entities.xml -o out/ || fail "a spec with entities must be generated"
+grep -q 'Salt & pepper <in> one block' out/a.cpp || fail "the text of a block must be merged around its entities"
+exit 0
@@ -0,0 +1,59 @@
+# Editors: Tobias Goetz
+#
+# Watch: a written spec is regenerated while the generator keeps running, a spec that
+# fails is reported without ending the watch, new specs in a watched directory are
+# picked up, edited templates are used and the depfile is written again.
+
+. "$(dirname "$0")/common.sh"
+
+# wait_for <command>, polls the command for up to ten seconds
+wait_for() {
+    tries=0
+    until eval "$1"; do
+        tries=$((tries + 1))
+        [ $tries -lt 100 ] || return 1
+        sleep 0.1
+    done
+}
+
+spec specs/a.xml a.h a.cpp A
+mkdir out
+"$generator" $frontendArgs -p specs -o out/ --watch >> "$log" 2>&1 &
+watcher=$!
+trap 'kill $watcher 2>/dev/null; rm -rf "$work"' EXIT
+
+wait_for 'grep -q "Watching" "$log"' || fail "the watch must start after generating the specs"
+[ -f out/a.h ] || fail "the specs must be generated before watching"
+
+spec specs/a.xml a.h a.cpp A changed
+wait_for 'grep -q "changed" out/a.h' || fail "a written spec must be regenerated"
+
+echo "<GetOptSetup>" > specs/a.xml
+wait_for 'grep -q "FAILED specs/a.xml" "$log"' || fail "a failing spec must be reported"
+kill -0 $watcher 2>/dev/null || fail "a failing spec must not end the watch"
+
+spec specs/a.xml a.h a.cpp A again
+wait_for 'grep -q "again" out/a.h' || fail "a fixed spec must be regenerated"
+
+spec specs/b.xml b.h b.cpp B
+wait_for '[ -f out/b.h ]' || fail "a new spec in a watched directory must be generated"
+compile out/b.cpp || fail "the generated source must compile"
+
+kill $watcher
+wait $watcher 2>/dev/null
+
+# Edited templates are compiled again and the depfile follows every regeneration
+"$generator" --dump-templates templates >> "$log" 2>&1 || fail "the templates must be written"
+spec own/c.xml c.h c.cpp C
+mkdir ownout
+"$generator" $frontendArgs -p own -o ownout/ --templates templates --depfile ownout/c.d --watch >> "$log" 2>&1 &
+watcher=$!
+wait_for '[ -f ownout/c.d ]' || fail "the depfile must be written before watching"
+echo "// edited template" >> templates/header.tpl
+wait_for 'grep -q "edited template" ownout/c.h' || fail "an edited template must be used"
+spec own/d.xml d.h d.cpp D
+wait_for 'grep -q "own/d.xml" ownout/c.d' || fail "the depfile must be written after a regeneration"
+grep -q "[0-9]\{6,\} regenerated" "$log" && fail "the regenerated specs must be counted from the results"
+kill $watcher
+wait $watcher 2>/dev/null
+exit 0